@@ -0,0 +1,83 @@
+#include "BenchSupport.h"
+#include "BinaryPayload.h"
+
+void report(const juce::String &name, double microseconds, size_t bytes)
+{
+    std::cout << name.paddedRight(' ', 40) << juce::String(microseconds, 1).paddedLeft(' ', 10) << " us"
+              << juce::String(static_cast<juce::int64>(bytes)).paddedLeft(' ', 12) << " bytes" << std::endl;
+}
+
+void reportLoad(const juce::String &name, double microseconds, int blockSize, double sampleRate)
+{
+    const double budget = blockSize / sampleRate * 1.0e6;
+    std::cout << name.paddedRight(' ', 40) << juce::String(microseconds, 1).paddedLeft(' ', 10) << " us"
+              << juce::String(microseconds / budget * 100.0, 2).paddedLeft(' ', 12) << " % of block" << std::endl;
+}
+
+//==============================================================================
+juce::String legacyWaveformScript(const juce::AudioBuffer<float> &buffer)
+{
+    const int channelsToUse = juce::jmin(buffer.getNumChannels(), 2);
+    const int numSamples = buffer.getNumSamples();
+    const int skipFactor = juce::jmax(1, numSamples / BinaryPayload::MAX_WAVEFORM_POINTS);
+
+    juce::String waveformData = "[";
+
+    for (int channel = 0; channel < channelsToUse; ++channel)
+    {
+        waveformData += "[";
+        const float *channelData = buffer.getReadPointer(channel);
+
+        for (int i = 0; i < numSamples; i += skipFactor)
+        {
+            waveformData += juce::String(channelData[i]);
+
+            if (i + skipFactor < numSamples)
+                waveformData += ",";
+        }
+
+        waveformData += "]";
+
+        if (channel < channelsToUse - 1)
+            waveformData += ",";
+    }
+
+    waveformData += "]";
+
+    return "if (window.setWaveformData) { window.setWaveformData(" + waveformData + ", " + juce::String(numSamples) + "); }";
+}
+
+juce::String legacySampleListScript(const SampleLibrary &library)
+{
+    juce::StringArray categories = library.getCategories();
+    juce::String categoryDataJson = "[";
+
+    for (int i = 0; i < categories.size(); ++i)
+    {
+        const juce::String &category = categories[i];
+        juce::StringArray samplesInCategory = library.getSamplesInCategory(category);
+
+        if (samplesInCategory.size() > 0)
+        {
+            juce::String categoryJson = "{\"name\":\"" + juce::String(category).replace("\\", "\\\\").replace("\"", "\\\"") + "\",\"samples\":[";
+
+            for (int j = 0; j < samplesInCategory.size(); ++j)
+            {
+                juce::String sampleName = samplesInCategory[j].replace("\\", "\\\\").replace("\"", "\\\"");
+                categoryJson += "\"" + sampleName + "\"";
+                if (j < samplesInCategory.size() - 1)
+                    categoryJson += ",";
+            }
+
+            categoryJson += "]}";
+
+            categoryDataJson += categoryJson;
+            if (i < categories.size() - 1)
+                categoryDataJson += ",";
+        }
+    }
+
+    categoryDataJson += "]";
+
+    return "if (window.updateCategorizedSamplesList) { window.updateCategorizedSamplesList(" + categoryDataJson + "); }";
+}
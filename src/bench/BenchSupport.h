@@ -0,0 +1,32 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleLibrary.h"
+
+// Run a benchmark a number of times and report the median time per run
+template <typename Function>
+double measureMicroseconds(int numRuns, Function &&function)
+{
+    std::vector<double> timings;
+    timings.reserve(static_cast<size_t>(numRuns));
+
+    for (int run = 0; run < numRuns; ++run)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        function();
+        const auto end = juce::Time::getHighResolutionTicks();
+        timings.push_back(juce::Time::highResolutionTicksToSeconds(end - start) * 1.0e6);
+    }
+
+    std::sort(timings.begin(), timings.end());
+    return timings[timings.size() / 2];
+}
+
+void report(const juce::String &name, double microseconds, size_t bytes);
+
+// Report a per-block time as a share of the real-time budget for that block
+void reportLoad(const juce::String &name, double microseconds, int blockSize, double sampleRate);
+
+// The string-building paths the LayoutView used before binary payloads
+juce::String legacyWaveformScript(const juce::AudioBuffer<float> &buffer);
+juce::String legacySampleListScript(const SampleLibrary &library);
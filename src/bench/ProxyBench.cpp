@@ -0,0 +1,546 @@
+#include <JuceHeader.h>
+#include "SampleLibrary.h"
+#include "BinaryPayload.h"
+#include "GrainPool.h"
+#include "VoiceFilterBank.h"
+#include "ModulationEngine.h"
+#include "ConvolutionReverb.h"
+#include "PitchedNoteCache.h"
+#include "SamplerVoice.h"
+#include "CommandChannel.h"
+#include "BenchSupport.h"
+
+//==============================================================================
+static void benchmarkTransport()
+{
+    std::cout << std::endl
+              << "UI transport" << std::endl;
+
+    // A stereo ten second sample reduced to 1000 waveform points
+    juce::AudioBuffer<float> waveform(2, 441000);
+    juce::Random random(1);
+
+    for (int channel = 0; channel < waveform.getNumChannels(); ++channel)
+        for (int i = 0; i < waveform.getNumSamples(); ++i)
+            waveform.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+    const auto pagedWaveform = PagedAudioBuffer::fromBuffer(waveform);
+
+    juce::String script;
+    double time = measureMicroseconds(50, [&]
+                                      { script = legacyWaveformScript(waveform); });
+    report("waveform 1000 pts: JSON string", time, script.getNumBytesAsUTF8());
+
+    time = measureMicroseconds(50, [&]
+                               {
+                                   int numPoints = 0;
+                                   auto payload = BinaryPayload::encodeWaveform(*pagedWaveform, 2, numPoints);
+                                   script = BinaryPayload::buildCall("setWaveformBinary", payload, "2, " + juce::String(numPoints));
+                               });
+    report("waveform 1000 pts: binary base64", time, script.getNumBytesAsUTF8());
+
+    // A library of 10k entries spread over 20 categories
+    SampleLibrary library;
+    juce::AudioBuffer<float> tiny(1, 1);
+    tiny.clear();
+
+    for (int i = 0; i < 10000; ++i)
+        library.loadFromBuffer("Sample \"" + juce::String(i) + "\" kick", tiny, 44100.0, "Category " + juce::String(i % 20));
+
+    time = measureMicroseconds(10, [&]
+                               { script = legacySampleListScript(library); });
+    report("library 10k entries: JSON string", time, script.getNumBytesAsUTF8());
+
+    time = measureMicroseconds(10, [&]
+                               {
+                                   auto payload = BinaryPayload::encodeSampleList(library);
+                                   script = BinaryPayload::buildCall("setSampleListData", payload);
+                               });
+    report("library 10k entries: binary base64", time, script.getNumBytesAsUTF8());
+}
+
+//==============================================================================
+static void benchmarkGrains()
+{
+    std::cout << std::endl
+              << "Granular" << std::endl;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    juce::AudioBuffer<float> source(2, 480000);
+    juce::Random random(2);
+
+    for (int channel = 0; channel < source.getNumChannels(); ++channel)
+        for (int i = 0; i < source.getNumSamples(); ++i)
+            source.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+    juce::AudioBuffer<float> output(2, blockSize);
+
+    // Keep a steady number of 20ms grains playing
+    for (int concurrent : {32, 128, GrainPool::CAPACITY})
+    {
+        GrainPool pool;
+        const int grainFrames = 960;
+        const double interval = grainFrames / static_cast<double>(concurrent);
+        double untilNext = 0.0;
+        float peak = 0.0f;
+
+        const double time = measureMicroseconds(200, [&]
+                                                {
+                                                    output.clear();
+                                                    int done = 0;
+
+                                                    while (done < blockSize)
+                                                    {
+                                                        for (; untilNext <= 0.0; untilNext += interval)
+                                                            pool.spawn(source.getReadPointer(0), source.getReadPointer(1), source.getNumSamples(),
+                                                                       random.nextDouble() * 400000.0, 1.25, grainFrames, 0.1f, 0.1f);
+
+                                                        const int count = juce::jmin(blockSize - done, static_cast<int>(std::ceil(untilNext)));
+                                                        pool.render(output.getWritePointer(0, done), output.getWritePointer(1, done), count, peak);
+                                                        untilNext -= count;
+                                                        done += count;
+                                                    }
+                                                });
+
+        const double grainsPerSecond = sampleRate / interval;
+        reportLoad(juce::String(concurrent) + " grains (" + juce::String(juce::roundToInt(grainsPerSecond)) + "/s), 512 block",
+                   time, blockSize, sampleRate);
+    }
+}
+
+//==============================================================================
+static void benchmarkVoiceFilters()
+{
+    std::cout << std::endl
+              << "Voice filters" << std::endl;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    VoiceFilterBank bank;
+    bank.prepare(sampleRate, blockSize);
+
+    FilterParameters parameters;
+    parameters.mode = FilterParameters::Mode::lowPass;
+    parameters.resonance = 4.0f;
+    parameters.envelopeAmount = 3.0f;
+    bank.setParameters(parameters);
+
+    juce::AudioBuffer<float> output(2, blockSize);
+    juce::Random random(3);
+
+    // Cost as polyphony grows; voices in the same SIMD register are filtered together
+    for (int numVoices : {1, 2, 4, 8})
+    {
+        std::array<VoiceFilterBank::VoiceState, VoiceFilterBank::MAX_VOICES> voices;
+
+        for (int v = 0; v < numVoices; ++v)
+            voices[static_cast<size_t>(v)] = {true, true, 0.8f, 1};
+
+        const double time = measureMicroseconds(500, [&]
+                                                {
+                                                    bank.beginBlock(blockSize);
+
+                                                    for (int v = 0; v < numVoices; ++v)
+                                                        for (int channel = 0; channel < 2; ++channel)
+                                                            bank.getVoiceBuffer(v).setSample(channel, 0, random.nextFloat());
+
+                                                    output.clear();
+                                                    bank.process(voices, output, 0, blockSize);
+                                                });
+
+        reportLoad(juce::String(numVoices) + " voices, 512 block", time, blockSize, sampleRate);
+    }
+}
+
+//==============================================================================
+static void benchmarkModulation()
+{
+    std::cout << std::endl
+              << "Modulation" << std::endl;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numVoices = 16;
+
+    ModulationEngine engine;
+    engine.prepare(sampleRate, blockSize);
+
+    ModulationParameters parameters;
+    parameters.pressureToVolume = 0.5f;
+    parameters.lfos[0] = {6.0f, 0.3f, ModulationParameters::LfoShape::sine, ModulationParameters::LfoTarget::pitch};
+    parameters.lfos[1] = {2.5f, 0.4f, ModulationParameters::LfoShape::triangle, ModulationParameters::LfoTarget::volume};
+    engine.setParameters(parameters);
+
+    std::array<NoteModulation, numVoices> notes;
+
+    for (int v = 0; v < numVoices; ++v)
+        engine.startNote(notes[static_cast<size_t>(v)], 48 + v, 2 + v % 15, 8192 + v * 200);
+
+    std::vector<float> ratios(blockSize);
+    double sink = 0.0;
+
+    // Targets at every control point, then ramped per sample as the voice kernel does
+    const double controlRate = measureMicroseconds(500, [&]
+                                                   {
+                                                       engine.beginBlock(blockSize);
+
+                                                       for (auto &note : notes)
+                                                       {
+                                                           auto current = engine.evaluate(note, 0);
+
+                                                           for (int start = 0; start < blockSize; start += ModulationEngine::CONTROL_INTERVAL)
+                                                           {
+                                                               const auto next = engine.evaluate(note, start / ModulationEngine::CONTROL_INTERVAL + 1);
+                                                               const double delta = (next.pitchRatio - current.pitchRatio) / ModulationEngine::CONTROL_INTERVAL;
+                                                               double ratio = current.pitchRatio;
+
+                                                               for (int i = 0; i < ModulationEngine::CONTROL_INTERVAL; ++i, ratio += delta)
+                                                                   ratios[static_cast<size_t>(start + i)] = static_cast<float>(ratio);
+
+                                                               current = next;
+                                                           }
+
+                                                           engine.advance(note, blockSize);
+                                                           sink += ratios.back();
+                                                       }
+                                                   });
+
+    // The same modulation evaluated in full at every sample, for comparison
+    const double audioRate = measureMicroseconds(500, [&]
+                                                 {
+                                                     for (auto &note : notes)
+                                                     {
+                                                         for (int i = 0; i < blockSize; ++i)
+                                                         {
+                                                             engine.beginBlock(1);
+                                                             ratios[static_cast<size_t>(i)] = static_cast<float>(engine.evaluate(note, 0).pitchRatio);
+                                                         }
+
+                                                         sink += ratios.back();
+                                                     }
+                                                 });
+
+    reportLoad("16 voices, control rate", controlRate, blockSize, sampleRate);
+    reportLoad("16 voices, every sample", audioRate, blockSize, sampleRate);
+
+    if (sink == 0.0)
+        std::cout << "  (no output)" << std::endl;
+}
+
+//==============================================================================
+static void benchmarkConvolution()
+{
+    std::cout << std::endl
+              << "Convolution reverb (stereo)" << std::endl;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    juce::Random random(4);
+    juce::AudioBuffer<float> input(2, blockSize);
+
+    for (double seconds : {0.25, 1.0, 3.0, 6.0})
+    {
+        // Exponentially decaying noise, like a real room
+        const int length = static_cast<int>(seconds * sampleRate);
+        juce::AudioBuffer<float> impulse(2, length);
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < length; ++i)
+                impulse.setSample(channel, i, (random.nextFloat() * 2.0f - 1.0f) * std::exp(-6.9f * i / length));
+
+        const juce::String label = juce::String(seconds, 2) + " s IR";
+
+        // Direct form: one vector pass per tap over the block and its history
+        juce::AudioBuffer<float> history(2, length + blockSize);
+        juce::AudioBuffer<float> output(2, blockSize);
+        history.clear();
+
+        const double directTime = measureMicroseconds(seconds > 1.0 ? 3 : 10, [&]
+                                                      {
+                                                          for (int channel = 0; channel < 2; ++channel)
+                                                          {
+                                                              float *x = history.getWritePointer(channel);
+                                                              std::copy(x + blockSize, x + length + blockSize, x);
+
+                                                              for (int i = 0; i < blockSize; ++i)
+                                                                  x[length + i] = random.nextFloat();
+
+                                                              float *out = output.getWritePointer(channel);
+                                                              const float *h = impulse.getReadPointer(channel);
+                                                              juce::FloatVectorOperations::clear(out, blockSize);
+
+                                                              for (int tap = 0; tap < length; ++tap)
+                                                                  juce::FloatVectorOperations::addWithMultiply(out, x + length - tap, h[tap], blockSize);
+                                                          }
+                                                      });
+
+        reportLoad(label + ", direct", directTime, blockSize, sampleRate);
+
+        // Partitioned: what the audio thread pays, with the tail running on its own thread
+        ConvolutionReverb reverb;
+        reverb.prepare(sampleRate, blockSize);
+        reverb.setImpulseResponse(impulse, sampleRate, "bench");
+        reverb.setMix(0.5f);
+
+        const double partitionedTime = measureMicroseconds(1000, [&]
+                                                           {
+                                                               for (int channel = 0; channel < 2; ++channel)
+                                                                   for (int i = 0; i < blockSize; ++i)
+                                                                       input.setSample(channel, i, random.nextFloat());
+
+                                                               reverb.process(input, blockSize);
+                                                           });
+
+        reportLoad(label + ", partitioned", partitionedTime, blockSize, sampleRate);
+
+        // The tail thread's share, per audio block
+        if (length > ConvolutionReverb::TAIL_OFFSET)
+        {
+            std::array<UniformConvolver, 2> tails;
+            std::vector<float> tailInput(ConvolutionReverb::TAIL_BLOCK), tailOutput(ConvolutionReverb::TAIL_BLOCK);
+
+            for (int channel = 0; channel < 2; ++channel)
+                tails[static_cast<size_t>(channel)].prepare(ConvolutionReverb::TAIL_BLOCK,
+                                                            impulse.getReadPointer(channel) + ConvolutionReverb::TAIL_OFFSET,
+                                                            length - ConvolutionReverb::TAIL_OFFSET);
+
+            const double tailTime = measureMicroseconds(50, [&]
+                                                        {
+                                                            for (auto &tail : tails)
+                                                            {
+                                                                for (auto &sample : tailInput)
+                                                                    sample = random.nextFloat();
+
+                                                                tail.process(tailInput.data(), tailOutput.data());
+                                                            }
+                                                        });
+
+            reportLoad(label + ", tail thread", tailTime * blockSize / ConvolutionReverb::TAIL_BLOCK, blockSize, sampleRate);
+        }
+
+        if (reverb.getNumTailMisses() > 0)
+            std::cout << "  " << reverb.getNumTailMisses() << " late tail blocks" << std::endl;
+    }
+}
+
+//==============================================================================
+static void benchmarkNoteCache()
+{
+    std::cout << std::endl
+              << "Pitched note cache" << std::endl;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    // A stereo ten second sample played as an eight note chord around the root
+    juce::AudioBuffer<float> source(2, 480000);
+    juce::Random random(6);
+
+    for (int channel = 0; channel < source.getNumChannels(); ++channel)
+        for (int i = 0; i < source.getNumSamples(); ++i)
+            source.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+    SampleData sample;
+    sample.buffer = PagedAudioBuffer::fromBuffer(source);
+    sample.sampleRate = sampleRate;
+    sample.maxLength = source.getNumSamples();
+
+    const std::array<int, 8> chord{48, 52, 55, 59, 62, 64, 67, 71};
+    juce::AudioBuffer<float> output(2, blockSize);
+    juce::MidiBuffer noMidi;
+
+    for (bool cached : {false, true})
+    {
+        juce::Synthesiser synth;
+        synth.setCurrentPlaybackSampleRate(sampleRate);
+
+        for (size_t v = 0; v < chord.size(); ++v)
+        {
+            auto *voice = new ProxySamplerVoice();
+            voice->setAttackRate(sampleRate, 5.0);
+            voice->setReleaseRate(sampleRate, 100.0);
+            synth.addVoice(voice);
+        }
+
+        auto *sound = new ProxySamplerSound("bench", sample, 10.0f, false, cached ? static_cast<size_t>(512) << 20 : 0);
+        synth.addSound(sound);
+
+        if (cached)
+        {
+            // Ask for the chord's notes and render them here instead of on a builder thread
+            for (int note : chord)
+                sound->findPitchedNote(note);
+
+            auto &cache = *sound->getNoteCache();
+            const double startMs = juce::Time::getMillisecondCounterHiRes();
+
+            while (cache.buildNext([]
+                                   { return false; }))
+            {
+            }
+
+            std::cout << "  rendered " << cache.getNumReady() << " notes, "
+                      << juce::String(static_cast<double>(cache.getSizeInBytes()) / (1024.0 * 1024.0), 1) << " MB, in "
+                      << juce::String(juce::Time::getMillisecondCounterHiRes() - startMs, 0) << " ms" << std::endl;
+        }
+
+        for (int note : chord)
+            synth.noteOn(1, note, 0.8f);
+
+        const double time = measureMicroseconds(200, [&]
+                                                {
+                                                    output.clear();
+                                                    synth.renderNextBlock(output, noMidi, 0, blockSize);
+                                                });
+
+        reportLoad(juce::String(cached ? "8 voices, pre-rendered notes" : "8 voices, realtime interpolation") + ", 512 block",
+                   time, blockSize, sampleRate);
+    }
+}
+
+//==============================================================================
+static void benchmarkCompressedVoices()
+{
+    std::cout << std::endl
+              << "Compressed playback" << std::endl;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    // A stereo ten second sample on the 16-bit grid, with a short sustain loop that starts and ends
+    // mid-block, played as an eight note chord that keeps going round the loop
+    juce::AudioBuffer<float> source(2, 480000);
+    juce::Random random(7);
+
+    for (int channel = 0; channel < source.getNumChannels(); ++channel)
+        for (int i = 0; i < source.getNumSamples(); ++i)
+            source.setSample(channel, i, std::round((random.nextFloat() * 2.0f - 1.0f) * 0.5f * 32768.0f) / 32768.0f);
+
+    SampleData sample;
+    sample.compressed = CompressedAudioBuffer::compress(*PagedAudioBuffer::fromBuffer(source), 16, false);
+    sample.sampleRate = sampleRate;
+    sample.maxLength = source.getNumSamples();
+    sample.bitsPerSample = 16;
+    sample.sustainLoop = SampleLoop(24500, 30100);
+
+    const std::array<int, 8> chord{48, 52, 55, 59, 62, 64, 67, 71};
+    juce::AudioBuffer<float> output(2, blockSize);
+    juce::MidiBuffer noMidi;
+
+    juce::Synthesiser synth;
+    synth.setCurrentPlaybackSampleRate(sampleRate);
+
+    for (size_t v = 0; v < chord.size(); ++v)
+    {
+        auto *voice = new ProxySamplerVoice();
+        voice->setAttackRate(sampleRate, 5.0);
+        voice->setReleaseRate(sampleRate, 100.0);
+        synth.addVoice(voice);
+    }
+
+    synth.addSound(new ProxySamplerSound("bench", sample, 10.0f));
+
+    for (int note : chord)
+        synth.noteOn(1, note, 0.8f);
+
+    const double time = measureMicroseconds(2000, [&]
+                                            {
+                                                output.clear();
+                                                synth.renderNextBlock(output, noMidi, 0, blockSize);
+                                            });
+
+    reportLoad("8 voices, block decode cache, 512 block", time, blockSize, sampleRate);
+
+    // Blocks decoded inside the render loop rather than ahead of it
+    juce::uint64 misses = 0;
+
+    for (int v = 0; v < synth.getNumVoices(); ++v)
+        if (auto *voice = dynamic_cast<ProxySamplerVoice *>(synth.getVoice(v)))
+            misses += voice->getNumDecodeMisses();
+
+    std::cout << "  " << misses << " blocks decoded on a miss" << std::endl;
+}
+
+//==============================================================================
+static void benchmarkCommands()
+{
+    std::cout << std::endl
+              << "Page commands (one second of continuous dragging)" << std::endl;
+
+    // Mouse moves at 240 Hz, the page flushing once per 60 Hz frame
+    constexpr int eventsPerSecond = 240;
+    constexpr int framesPerSecond = 60;
+
+    SamplerProcessor sampler;
+    EditorSettings editorSettings;
+    CommandChannel commands(sampler, editorSettings);
+
+    for (const juce::String param : {"attack", "filterCutoff"})
+    {
+        std::vector<juce::String> urls;
+        std::vector<juce::String> batches;
+        size_t eventBytes = 0, batchBytes = 0;
+
+        for (int i = 0; i < eventsPerSecond; ++i)
+        {
+            urls.push_back("proxy:sampler:" + param + "=" + juce::URL::addEscapeChars(juce::String(100.0 + i * 0.37), true));
+            eventBytes += urls.back().getNumBytesAsUTF8();
+        }
+
+        // Each frame carries only the last value of the moves it covered
+        for (int frame = 0; frame < framesPerSecond; ++frame)
+        {
+            const int last = (frame + 1) * eventsPerSecond / framesPerSecond - 1;
+            auto *object = new juce::DynamicObject();
+            object->setProperty(param, 100.0 + last * 0.37);
+
+            batches.push_back("proxy:batch:" + juce::URL::addEscapeChars(juce::JSON::toString(juce::var(object), true), true));
+            batchBytes += batches.back().getNumBytesAsUTF8();
+        }
+
+        // Before: one navigation per move, each a string command parsed and applied on its own
+        const double perEvent = measureMicroseconds(50, [&]
+                                                    {
+                                                        for (const auto &url : urls)
+                                                        {
+                                                            const auto command = url.fromFirstOccurrenceOf("proxy:sampler:", false, true);
+                                                            commands.apply(command.upToFirstOccurrenceOf("=", false, true),
+                                                                           juce::URL::removeEscapeChars(command.fromFirstOccurrenceOf("=", false, true)));
+                                                        }
+                                                    });
+
+        // After: one batch per frame, through the navigation fallback (the native event arrives already parsed)
+        const double perFrame = measureMicroseconds(50, [&]
+                                                    {
+                                                        for (const auto &batch : batches)
+                                                            commands.applyBatch(juce::JSON::parse(juce::URL::removeEscapeChars(batch.fromFirstOccurrenceOf("proxy:batch:", false, true))));
+                                                    });
+
+        report(param + " drag: per event", perEvent, eventBytes);
+        report(param + " drag: batched per frame", perFrame, batchBytes);
+
+        std::cout << "  message thread busy " << juce::String(perEvent / 1.0e4, 3) << " % -> "
+                  << juce::String(perFrame / 1.0e4, 3) << " %, " << eventsPerSecond << " -> " << framesPerSecond
+                  << " round trips" << std::endl;
+    }
+}
+
+int main(int, char **)
+{
+    std::cout << "ProxyBench (median of repeated runs)" << std::endl;
+
+    benchmarkTransport();
+    benchmarkGrains();
+    benchmarkVoiceFilters();
+    benchmarkModulation();
+    benchmarkConvolution();
+    benchmarkNoteCache();
+    benchmarkCompressedVoices();
+    benchmarkCommands();
+
+    return 0;
+}
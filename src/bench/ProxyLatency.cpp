@@ -0,0 +1,231 @@
+#include <JuceHeader.h>
+#include "SamplerProcessor.h"
+
+// Headless MIDI-to-audio timing check.
+//
+//   ProxyLatency [--tolerance samples] [--verbose]
+//
+// Plays timestamped note-ons through SamplerProcessor at several block sizes and in each
+// playback mode, finds where each note's audio starts, and reports the offset from the
+// note-on for every note together with the spread of those offsets (the jitter).
+// The test sample is DC, so the first non-zero output sample is the onset.
+// The exit code is non-zero if a note goes missing or the jitter of any run exceeds the tolerance.
+
+namespace
+{
+constexpr double sampleRate = 48000.0;
+constexpr int numNotes = 32;
+constexpr int noteLength = 2000;   // frames from note-on to note-off
+constexpr int noteSpacing = 9000;  // long enough for granular tails to finish between notes
+constexpr int maxBlockSize = 1024;
+constexpr float onsetThreshold = 1.0e-4f;
+
+struct Mode
+{
+    const char *name;
+    bool monophonic;
+    PlaybackMode playback;
+};
+
+struct RunResult
+{
+    std::vector<int> offsets; // onset minus note-on time, per detected note
+    int missed = 0;
+};
+
+juce::File writeTestSample()
+{
+    // One second of DC, so there is signal from the first frame of every note
+    juce::AudioBuffer<float> dc(1, static_cast<int>(sampleRate));
+    juce::FloatVectorOperations::fill(dc.getWritePointer(0), 0.5f, dc.getNumSamples());
+
+    auto file = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("ProxyLatencyDC.wav");
+    file.deleteFile();
+
+    juce::WavAudioFormat wav;
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+    std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate, 1, 32, {}, 0));
+
+    if (writer != nullptr)
+    {
+        stream.release(); // the writer owns it now
+        writer->writeFromAudioSampleBuffer(dc, 0, dc.getNumSamples());
+    }
+
+    return file;
+}
+
+// blockSize 0 means a different random block size every block, as some hosts do
+RunResult run(const Mode &mode, int blockSize, const juce::File &sampleFile)
+{
+    SamplerProcessor sampler;
+    sampler.loadSample(sampleFile);
+    sampler.setAttack(0.0f);
+    sampler.setRelease(0.0f);
+    sampler.setMonophonic(mode.monophonic);
+    sampler.setPlaybackMode(mode.playback);
+    sampler.prepareToPlay(sampleRate, blockSize > 0 ? blockSize : maxBlockSize);
+
+    // Note-on times spread so they land at every kind of position within a block
+    juce::Random random(42);
+    std::vector<juce::int64> noteTimes;
+
+    for (int n = 0; n < numNotes; ++n)
+        noteTimes.push_back(2 * maxBlockSize + static_cast<juce::int64>(n) * noteSpacing + random.nextInt(1000));
+
+    const juce::int64 totalLength = noteTimes.back() + noteSpacing;
+    std::vector<float> recording(static_cast<size_t>(totalLength), 0.0f);
+
+    juce::AudioBuffer<float> buffer(2, maxBlockSize);
+    juce::MidiBuffer midi;
+    juce::Random blockSizes(7);
+
+    for (juce::int64 blockStart = 0; blockStart < totalLength;)
+    {
+        const int numSamples = static_cast<int>(juce::jmin<juce::int64>(blockSize > 0 ? blockSize : 1 + blockSizes.nextInt(maxBlockSize),
+                                                                         totalLength - blockStart));
+        const juce::int64 blockEnd = blockStart + numSamples;
+
+        midi.clear();
+
+        for (const auto time : noteTimes)
+        {
+            if (time >= blockStart && time < blockEnd)
+                midi.addEvent(juce::MidiMessage::noteOn(1, 60, 0.8f), static_cast<int>(time - blockStart));
+
+            if (time + noteLength >= blockStart && time + noteLength < blockEnd)
+                midi.addEvent(juce::MidiMessage::noteOff(1, 60), static_cast<int>(time + noteLength - blockStart));
+        }
+
+        buffer.setSize(2, numSamples, false, false, true);
+        sampler.processBlock(buffer, midi);
+
+        std::copy(buffer.getReadPointer(0), buffer.getReadPointer(0) + numSamples, recording.begin() + blockStart);
+        blockStart = blockEnd;
+    }
+
+    // Look for each onset from just after the previous note had time to finish
+    RunResult result;
+
+    for (const auto time : noteTimes)
+    {
+        const juce::int64 searchStart = time - maxBlockSize - 32;
+        const juce::int64 searchEnd = juce::jmin(totalLength, time + noteLength);
+        juce::int64 onset = -1;
+
+        for (juce::int64 i = searchStart; i < searchEnd; ++i)
+        {
+            if (std::abs(recording[static_cast<size_t>(i)]) > onsetThreshold)
+            {
+                onset = i;
+                break;
+            }
+        }
+
+        if (onset < 0)
+            ++result.missed;
+        else
+            result.offsets.push_back(static_cast<int>(onset - time));
+    }
+
+    return result;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    double tolerance = 1.0;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String option(argv[i]);
+
+        if (option == "--tolerance" && i + 1 < argc)
+            tolerance = juce::String(argv[++i]).getDoubleValue();
+        else if (option == "--verbose")
+            verbose = true;
+    }
+
+    const auto sampleFile = writeTestSample();
+
+    const Mode modes[] = {
+        {"sample poly", false, PlaybackMode::sample},
+        {"sample mono", true, PlaybackMode::sample},
+        {"granular poly", false, PlaybackMode::granular},
+    };
+
+    std::cout << "ProxyLatency: note-on to first audio sample, " << sampleRate / 1000.0 << " kHz, "
+              << numNotes << " notes per run (offsets in samples)" << std::endl
+              << std::endl;
+
+    std::cout << juce::String("mode").paddedRight(' ', 16) << juce::String("block").paddedLeft(' ', 8)
+              << juce::String("missed").paddedLeft(' ', 8) << juce::String("min").paddedLeft(' ', 8)
+              << juce::String("mean").paddedLeft(' ', 9) << juce::String("max").paddedLeft(' ', 8)
+              << juce::String("jitter").paddedLeft(' ', 9) << juce::String("p-p").paddedLeft(' ', 7) << std::endl;
+
+    int numFailures = 0;
+
+    for (const auto &mode : modes)
+    {
+        for (int blockSize : {32, 64, 128, 256, 512, 1024, 4096, 0})
+        {
+            const auto result = run(mode, blockSize, sampleFile);
+
+            double mean = 0.0, variance = 0.0;
+            int minimum = 0, maximum = 0;
+
+            if (!result.offsets.empty())
+            {
+                minimum = *std::min_element(result.offsets.begin(), result.offsets.end());
+                maximum = *std::max_element(result.offsets.begin(), result.offsets.end());
+
+                for (const int offset : result.offsets)
+                    mean += offset;
+
+                mean /= static_cast<double>(result.offsets.size());
+
+                for (const int offset : result.offsets)
+                    variance += (offset - mean) * (offset - mean);
+
+                variance /= static_cast<double>(result.offsets.size());
+            }
+
+            const bool failed = result.missed > 0 || maximum - minimum > tolerance;
+
+            std::cout << juce::String(mode.name).paddedRight(' ', 16)
+                      << (blockSize > 0 ? juce::String(blockSize) : juce::String("var")).paddedLeft(' ', 8)
+                      << juce::String(result.missed).paddedLeft(' ', 8)
+                      << juce::String(minimum).paddedLeft(' ', 8)
+                      << juce::String(mean, 2).paddedLeft(' ', 9)
+                      << juce::String(maximum).paddedLeft(' ', 8)
+                      << juce::String(std::sqrt(variance), 2).paddedLeft(' ', 9)
+                      << juce::String(maximum - minimum).paddedLeft(' ', 7)
+                      << (failed ? "  FAILED" : "") << std::endl;
+
+            if (verbose || failed)
+            {
+                juce::String offsets;
+
+                for (const int offset : result.offsets)
+                    offsets << offset << " ";
+
+                std::cout << "  offsets: " << offsets.trimEnd() << std::endl;
+            }
+
+            if (failed)
+                ++numFailures;
+        }
+    }
+
+    sampleFile.deleteFile();
+
+    if (numFailures > 0)
+    {
+        std::cout << std::endl
+                  << numFailures << " run(s) outside the " << tolerance << " sample tolerance" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,716 @@
+#include <JuceHeader.h>
+#include "SampleLibrary.h"
+#include "SamplerVoice.h"
+#include "CompressedAudioBuffer.h"
+#include "AntiPopFade.h"
+#include "BinaryPayload.h"
+#include "BenchSupport.h"
+
+// Focused timings for individual kernels, each checked against a plain scalar reference.
+//
+//   ProxyMicroBench [--filter text] [--csv results.csv] [--baseline previous.csv]
+//
+// Every benchmark warms up first, then reports the median, the fastest run and the
+// interquartile spread over many runs, so numbers from two commits on the same machine
+// can be compared. --csv writes the results; --baseline prints the change against a file
+// written by an earlier run. The exit code is non-zero if any parity check fails.
+
+//==============================================================================
+class MicroBench
+{
+public:
+    MicroBench(const juce::String &nameFilter, const juce::File &baselineFile)
+        : filter(nameFilter)
+    {
+        if (baselineFile.existsAsFile())
+        {
+            juce::StringArray lines;
+            baselineFile.readLines(lines);
+
+            for (const auto &line : lines)
+            {
+                const auto fields = juce::StringArray::fromTokens(line, ",", "\"");
+
+                if (fields.size() >= 2 && fields[1].containsOnly("0123456789.e-+"))
+                    baseline.set(fields[0].unquoted(), fields[1].getDoubleValue());
+            }
+        }
+    }
+
+    bool isSelected(const juce::String &name) const
+    {
+        return filter.isEmpty() || name.containsIgnoreCase(filter);
+    }
+
+    // Time callsPerRun calls per run over numRuns runs, after a warm-up.
+    // unitsPerCall / microseconds gives the throughput in millions of units per second.
+    template <typename Function>
+    void measure(const juce::String &name, int numRuns, int callsPerRun, double unitsPerCall,
+                 const juce::String &unit, Function &&function)
+    {
+        if (!isSelected(name))
+            return;
+
+        // Warm caches, branch predictors and the CPU clock before anything is timed
+        for (int run = 0; run < juce::jmax(1, numRuns / 10); ++run)
+            for (int call = 0; call < callsPerRun; ++call)
+                function();
+
+        std::vector<double> timings;
+        timings.reserve(static_cast<size_t>(numRuns));
+
+        for (int run = 0; run < numRuns; ++run)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int call = 0; call < callsPerRun; ++call)
+                function();
+
+            const auto end = juce::Time::getHighResolutionTicks();
+            timings.push_back(juce::Time::highResolutionTicksToSeconds(end - start) * 1.0e6 / callsPerRun);
+        }
+
+        std::sort(timings.begin(), timings.end());
+
+        Result result;
+        result.name = name;
+        result.median = timings[timings.size() / 2];
+        result.minimum = timings.front();
+        result.spread = (timings[timings.size() * 3 / 4] - timings[timings.size() / 4]) / juce::jmax(1.0e-9, result.median);
+        results.push_back(result);
+
+        std::cout << name.paddedRight(' ', 44)
+                  << juce::String(result.median, 3).paddedLeft(' ', 12) << " us"
+                  << juce::String(result.minimum, 3).paddedLeft(' ', 12) << " min"
+                  << ("+-" + juce::String(result.spread * 100.0, 1) + "%").paddedLeft(' ', 9);
+
+        if (unitsPerCall > 0.0)
+            std::cout << juce::String(unitsPerCall / result.median, 1).paddedLeft(' ', 10) << " " << unit << "/s";
+
+        if (baseline.contains(name))
+        {
+            const double change = (result.median / baseline[name] - 1.0) * 100.0;
+            std::cout << "  " << (change >= 0.0 ? "+" : "") << juce::String(change, 1) << "% vs baseline";
+        }
+
+        std::cout << std::endl;
+    }
+
+    void check(const juce::String &name, bool passed, const juce::String &detail)
+    {
+        if (!isSelected(name))
+            return;
+
+        std::cout << ("  parity: " + name).paddedRight(' ', 44) << (passed ? "ok" : "FAILED") << "  " << detail << std::endl;
+
+        if (!passed)
+            ++numFailures;
+    }
+
+    void writeCsv(const juce::File &file) const
+    {
+        juce::String text = "name,median_us,min_us,spread\n";
+
+        for (const auto &result : results)
+            text << result.name.quoted() << "," << result.median << "," << result.minimum << "," << result.spread << "\n";
+
+        if (file.replaceWithText(text))
+            std::cout << std::endl
+                      << "Results written to " << file.getFullPathName() << std::endl;
+    }
+
+    int getNumFailures() const { return numFailures; }
+
+private:
+    struct Result
+    {
+        juce::String name;
+        double median = 0.0;  // microseconds per call
+        double minimum = 0.0;
+        double spread = 0.0;  // interquartile range relative to the median
+    };
+
+    juce::String filter;
+    std::vector<Result> results;
+    juce::HashMap<juce::String, double> baseline;
+    int numFailures = 0;
+};
+
+static void fillWithNoise(juce::AudioBuffer<float> &buffer, int seed, float amplitude)
+{
+    juce::Random random(seed);
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            buffer.setSample(channel, i, (random.nextFloat() * 2.0f - 1.0f) * amplitude);
+}
+
+static float maxDifference(const float *a, const float *b, int numSamples)
+{
+    float difference = 0.0f;
+
+    for (int i = 0; i < numSamples; ++i)
+        difference = juce::jmax(difference, std::abs(a[i] - b[i]));
+
+    return difference;
+}
+
+static juce::String describeDifference(float difference)
+{
+    return "max difference " + juce::String(difference, 9);
+}
+
+//==============================================================================
+// Per-sample reference for the ProxySamplerVoice kernels, deciding everything inside the loop
+static void referenceSegment(const float *inL, const float *inR, float *outL, float *outR, int count,
+                             double position, double step, double stepDelta,
+                             double envelope, double envelopeDelta,
+                             float modulation, float modulationDelta,
+                             float gainL, float gainR, bool interpolate)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const int index = static_cast<int>(position);
+        const float alpha = interpolate ? static_cast<float>(position - index) : 0.0f;
+        const float level = static_cast<float>(envelope) * modulation;
+
+        outL[i] += (inL[index] + alpha * (inL[index + 1] - inL[index])) * level * gainL;
+
+        if (outR != nullptr)
+            outR[i] += (inR[index] + alpha * (inR[index + 1] - inR[index])) * level * gainR;
+
+        position += step;
+        step += stepDelta;
+        envelope += envelopeDelta;
+        modulation += modulationDelta;
+    }
+}
+
+static void benchmarkVoiceKernel(MicroBench &bench)
+{
+    std::cout << std::endl
+              << "Voice kernel (512 frames)" << std::endl;
+
+    constexpr int frames = 512;
+
+    juce::AudioBuffer<float> source(2, 4096);
+    fillWithNoise(source, 1, 1.0f);
+
+    juce::AudioBuffer<float> output(2, frames);
+    juce::AudioBuffer<float> expected(2, frames);
+
+    // A pitch ramp with the envelope and modulation ramping as well, as in a modulated attack
+    const double startPosition = 100.25;
+    const double startStep = 1.0;
+    const double stepDelta = 0.06 / frames;
+    const double startEnvelope = 0.2;
+    const double envelopeDelta = 0.7 / frames;
+    const float startModulation = 1.0f;
+    const float modulationDelta = -0.2f / frames;
+
+    for (bool interpolate : {true, false})
+    {
+        for (int sourceChannels : {2, 1})
+        {
+            for (bool stereo : {true, false})
+            {
+                const juce::String variant = juce::String(interpolate ? "linear" : "nearest")
+                                             + (sourceChannels > 1 ? ", stereo" : ", mono") + (stereo ? " to stereo" : " to mono");
+                const float *inL = source.getReadPointer(0);
+                const float *inR = sourceChannels > 1 ? source.getReadPointer(1) : inL; // voices pass mono sources like this
+                float *outR = stereo ? output.getWritePointer(1) : nullptr;
+
+                // Picked once, as a voice does at note start
+                const auto kernel = ProxySamplerVoice::chooseKernel(sourceChannels, stereo ? 2 : 1, interpolate);
+
+                auto renderOptimized = [&]
+                {
+                    double position = startPosition, step = startStep, envelope = startEnvelope;
+                    float modulation = startModulation, peak = 0.0f;
+                    kernel(inL, inR, output.getWritePointer(0), outR, frames,
+                           position, step, stepDelta, envelope, envelopeDelta,
+                           modulation, modulationDelta, 0.7f, 0.6f, peak);
+                };
+
+                auto renderReference = [&]
+                {
+                    referenceSegment(inL, inR, expected.getWritePointer(0), stereo ? expected.getWritePointer(1) : nullptr, frames,
+                                     startPosition, startStep, stepDelta, startEnvelope, envelopeDelta,
+                                     startModulation, modulationDelta, 0.7f, 0.6f, interpolate);
+                };
+
+                output.clear();
+                expected.clear();
+                renderOptimized();
+                renderReference();
+
+                float difference = maxDifference(output.getReadPointer(0), expected.getReadPointer(0), frames);
+
+                if (stereo)
+                    difference = juce::jmax(difference, maxDifference(output.getReadPointer(1), expected.getReadPointer(1), frames));
+
+                bench.check("voice " + variant, difference <= 1.0e-6f, describeDifference(difference));
+
+                bench.measure("voice " + variant + ": scalar", 301, 20, frames, "Mframes", renderReference);
+                bench.measure("voice " + variant + ": kernel", 301, 20, frames, "Mframes", renderOptimized);
+            }
+        }
+    }
+}
+
+//==============================================================================
+// The crossfade as it was written inline in SamplerProcessor
+static void referenceAntiPop(float *buffer, const float *previous, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const int fadeSamples = 32;
+
+        if (i < fadeSamples)
+        {
+            float alpha = static_cast<float>(i) / fadeSamples;
+            buffer[i] = buffer[i] * alpha + previous[i] * (1.0f - alpha);
+        }
+    }
+}
+
+static void benchmarkAntiPop(MicroBench &bench)
+{
+    std::cout << std::endl
+              << "Anti-pop crossfade (stereo, 512 frames)" << std::endl;
+
+    constexpr int frames = 512;
+
+    juce::AudioBuffer<float> previous(2, frames);
+    juce::AudioBuffer<float> current(2, frames);
+    fillWithNoise(previous, 2, 1.0f);
+    fillWithNoise(current, 3, 1.0f);
+
+    juce::AudioBuffer<float> optimized, expected;
+    optimized.makeCopyOf(current);
+    expected.makeCopyOf(current);
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        AntiPopFade::apply(optimized.getWritePointer(channel), previous.getReadPointer(channel), frames);
+        referenceAntiPop(expected.getWritePointer(channel), previous.getReadPointer(channel), frames);
+    }
+
+    float difference = 0.0f;
+
+    for (int channel = 0; channel < 2; ++channel)
+        difference = juce::jmax(difference, maxDifference(optimized.getReadPointer(channel), expected.getReadPointer(channel), frames));
+
+    bench.check("anti-pop fade", difference <= 1.0e-6f, describeDifference(difference));
+
+    bench.measure("anti-pop: scalar", 301, 1000, frames * 2, "Msamples", [&]
+                  {
+                      for (int channel = 0; channel < 2; ++channel)
+                          referenceAntiPop(expected.getWritePointer(channel), previous.getReadPointer(channel), frames);
+                  });
+
+    bench.measure("anti-pop: vector", 301, 1000, frames * 2, "Msamples", [&]
+                  {
+                      for (int channel = 0; channel < 2; ++channel)
+                          AntiPopFade::apply(optimized.getWritePointer(channel), previous.getReadPointer(channel), frames);
+                  });
+}
+
+//==============================================================================
+static void benchmarkLibrary(MicroBench &bench)
+{
+    std::cout << std::endl
+              << "Sample library (10 s stereo, 44.1 kHz)" << std::endl;
+
+    constexpr double sampleRate = 44100.0;
+
+    juce::AudioBuffer<float> source(2, 441000);
+    fillWithNoise(source, 4, 0.5f);
+
+    struct Format
+    {
+        const char *name;
+        std::unique_ptr<juce::AudioFormat> format;
+        int bitsPerSample;
+        int quality;
+        float tolerance; // largest difference decoding may introduce, or 0 for a lossy format
+    };
+
+    std::vector<Format> formats;
+    formats.push_back({"WAV 16-bit", std::make_unique<juce::WavAudioFormat>(), 16, 0, 1.0f / 32767.0f});
+    formats.push_back({"WAV 24-bit", std::make_unique<juce::WavAudioFormat>(), 24, 0, 1.0f / 8388607.0f});
+    formats.push_back({"WAV 32-bit float", std::make_unique<juce::WavAudioFormat>(), 32, 0, 1.0e-7f});
+    formats.push_back({"AIFF 24-bit", std::make_unique<juce::AiffAudioFormat>(), 24, 0, 1.0f / 8388607.0f});
+#if JUCE_USE_FLAC
+    formats.push_back({"FLAC 24-bit", std::make_unique<juce::FlacAudioFormat>(), 24, 0, 1.0f / 8388607.0f});
+#endif
+#if JUCE_USE_OGGVORBIS
+    formats.push_back({"Ogg Vorbis q5", std::make_unique<juce::OggVorbisAudioFormat>(), 16, 5, 0.0f});
+#endif
+
+    const auto folder = juce::File::getSpecialLocation(juce::File::tempDirectory);
+
+    for (auto &format : formats)
+    {
+        const juce::String name = "loadFromFile " + juce::String(format.name);
+
+        if (!bench.isSelected(name))
+            continue;
+
+        auto file = folder.getNonexistentChildFile("ProxyMicroBench", format.format->getFileExtensions()[0]);
+
+        {
+            auto stream = std::make_unique<juce::FileOutputStream>(file);
+            std::unique_ptr<juce::AudioFormatWriter> writer(format.format->createWriterFor(stream.get(), sampleRate, 2, format.bitsPerSample, {}, format.quality));
+
+            if (writer == nullptr)
+            {
+                bench.check(name, false, "no writer for this format");
+                continue;
+            }
+
+            stream.release(); // the writer owns it now
+            writer->writeFromAudioSampleBuffer(source, 0, source.getNumSamples());
+        }
+
+        SampleLibrary library;
+        library.setPoolSharing(false); // time the decoding, not the previous run's audio coming back from the pool
+        bench.measure(name, 11, 1, static_cast<double>(file.getSize()), "MB", [&]
+                      { library.loadFromFile("sample", file); });
+
+        // Decoded audio should match what was written, to within the format's resolution
+        const auto loaded = library.getSampleAudioBuffer("sample");
+        bool passed = loaded.buffer != nullptr && loaded.buffer->getNumChannels() == 2 && loaded.buffer->getNumFrames() >= source.getNumSamples();
+        juce::String detail = passed ? juce::String(loaded.buffer->getNumFrames()) + " frames" : "wrong shape";
+
+        if (passed && format.tolerance > 0.0f)
+        {
+            const auto decoded = loaded.buffer->toAudioBuffer(0, source.getNumSamples());
+            float difference = 0.0f;
+
+            for (int channel = 0; channel < 2; ++channel)
+                difference = juce::jmax(difference, maxDifference(decoded.getReadPointer(channel), source.getReadPointer(channel), source.getNumSamples()));
+
+            passed = difference <= format.tolerance * 1.01f;
+            detail = describeDifference(difference);
+        }
+        else if (passed)
+        {
+            detail << ", lossy: shape only";
+        }
+
+        bench.check(name, passed, detail);
+        file.deleteFile();
+    }
+
+    // A second library (another plugin instance) loading the same file gets the first one's audio
+    {
+        auto file = folder.getNonexistentChildFile("ProxyMicroBench", ".wav");
+
+        {
+            juce::WavAudioFormat wav;
+            auto stream = std::make_unique<juce::FileOutputStream>(file);
+            std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate, 2, 16, {}, 0));
+
+            if (writer != nullptr)
+            {
+                stream.release(); // the writer owns it now
+                writer->writeFromAudioSampleBuffer(source, 0, source.getNumSamples());
+            }
+        }
+
+        SampleLibrary first, second;
+        first.loadFromFile("sample", file);
+
+        bench.measure("loadFromFile from the shared pool", 11, 1, static_cast<double>(file.getSize()), "MB", [&]
+                      { second.loadFromFile("sample", file); });
+
+        const auto original = first.getSampleAudioBuffer("sample");
+        const auto shared = second.getSampleAudioBuffer("sample");
+        const bool passed = original.buffer != nullptr && shared.buffer == original.buffer;
+        bench.check("sample pool", passed, passed ? "one copy for both libraries" : "decoded twice");
+        file.deleteFile();
+    }
+
+    // Lookups; the audio is shared rather than copied, so length shouldn't matter
+    SampleLibrary library;
+    juce::AudioBuffer<float> tiny(2, 64);
+    fillWithNoise(tiny, 5, 0.5f);
+
+    for (int i = 0; i < 2000; ++i)
+        library.loadFromBuffer("Sample " + juce::String(i), tiny, sampleRate, "Category " + juce::String(i % 20));
+
+    library.loadFromBuffer("Long", source, sampleRate, "Category 0");
+
+    SampleData data;
+    bench.measure("getSampleAudioBuffer 10 s stereo", 301, 100, 0.0, {}, [&]
+                  { data = library.getSampleAudioBuffer("Long"); });
+    bench.measure("getSampleAudioBuffer 64 frames", 301, 100, 0.0, {}, [&]
+                  { data = library.getSampleAudioBuffer("Sample 1234"); });
+    bench.measure("getSampleAudioBuffer missing", 301, 100, 0.0, {}, [&]
+                  { data = library.getSampleAudioBuffer("Missing"); });
+
+    data = library.getSampleAudioBuffer("Long");
+    float difference = 1.0f;
+
+    if (data.buffer != nullptr && data.buffer->getNumFrames() == source.getNumSamples())
+    {
+        const auto stored = data.buffer->toAudioBuffer(0, source.getNumSamples());
+        difference = 0.0f;
+
+        for (int channel = 0; channel < 2; ++channel)
+            difference = juce::jmax(difference, maxDifference(stored.getReadPointer(channel), source.getReadPointer(channel), source.getNumSamples()));
+    }
+
+    bench.check("getSampleAudioBuffer", difference == 0.0f, describeDifference(difference));
+}
+
+//==============================================================================
+static void benchmarkCompressedStorage(MicroBench &bench)
+{
+    std::cout << std::endl
+              << "Compressed sample storage (10 s stereo, 16-bit drum hits)" << std::endl;
+
+    // Decaying noise hits with silence between them, on the 16-bit grid like a decoded WAV
+    constexpr int frames = 441000;
+    constexpr int hitSpacing = 22050;
+    juce::AudioBuffer<float> source(2, frames);
+    juce::Random random(6);
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        float *data = source.getWritePointer(channel);
+
+        for (int i = 0; i < frames; ++i)
+        {
+            const int sinceHit = i % hitSpacing;
+            const float envelope = sinceHit < hitSpacing / 2 ? std::exp(-static_cast<float>(sinceHit) / 2000.0f) : 0.0f;
+            data[i] = std::round(envelope * (random.nextFloat() * 2.0f - 1.0f) * 0.8f * 32768.0f) / 32768.0f;
+        }
+    }
+
+    const auto paged = PagedAudioBuffer::fromBuffer(source);
+    const auto compressed = CompressedAudioBuffer::compress(*paged, 16, false);
+
+    const double ratio = static_cast<double>(paged->getSizeInBytes()) / static_cast<double>(compressed->getSizeInBytes());
+    bench.check("compressed storage: ratio", ratio >= 2.0, juce::String(ratio, 2) + "x, "
+                                                           + juce::String(compressed->getSizeInBytes() / 1024) + " KB");
+
+    juce::HeapBlock<float> decoded(CompressedAudioBuffer::DECODED_BLOCK_FRAMES);
+    int block = 0;
+
+    bench.measure("compressed storage: decodeBlock", 301, 100, CompressedAudioBuffer::BLOCK_FRAMES, "Msamples", [&]
+                  {
+                      compressed->decodeBlock(0, block, decoded.get());
+                      block = (block + 1) % compressed->getNumBlocks();
+                  });
+
+    // Lossless: everything decodes back to exactly the source
+    const auto restored = compressed->decompress()->toAudioBuffer(0, frames);
+    float difference = 0.0f;
+
+    for (int channel = 0; channel < 2; ++channel)
+        difference = juce::jmax(difference, maxDifference(restored.getReadPointer(channel), source.getReadPointer(channel), frames));
+
+    bench.check("compressed storage: decompress", difference == 0.0f, describeDifference(difference));
+}
+
+//==============================================================================
+static void benchmarkSampleAnalysis(MicroBench &bench)
+{
+    std::cout << std::endl
+              << "Sample analysis (10 s stereo, A3 after 25 ms of silence)" << std::endl;
+
+    // A decaying tone with a few harmonics that has faded out a second before the end
+    constexpr double sampleRate = 44100.0;
+    constexpr int frames = 441000;
+    constexpr int onset = 1102;
+    constexpr int toneLength = 9 * 44100;
+    constexpr double frequency = 220.0;
+    juce::AudioBuffer<float> source(2, frames);
+    source.clear();
+
+    for (int i = 0; i < toneLength; ++i)
+    {
+        const double t = i / sampleRate;
+        const double phase = juce::MathConstants<double>::twoPi * frequency * t;
+        const double fade = i < toneLength - 4410 ? 1.0 : (toneLength - i) / 4410.0;
+        const auto value = static_cast<float>(fade * std::exp(-t * 0.5) * (0.5 * std::sin(phase) + 0.3 * std::sin(2.0 * phase) + 0.1 * std::sin(3.0 * phase)));
+        source.setSample(0, onset + i, value);
+        source.setSample(1, onset + i, value * 0.7f);
+    }
+
+    const auto paged = PagedAudioBuffer::fromBuffer(source);
+    const auto analysis = SampleAnalysis::analyse(*paged, sampleRate);
+
+    bench.measure("analysis: 10 s stereo", 21, 1, frames, "Mframes", [&]
+                  { SampleAnalysis::analyse(*paged, sampleRate); });
+
+    const double expectedRoot = 69.0 + 12.0 * std::log2(frequency / 440.0);
+    bench.check("analysis: root", analysis.pitched && std::abs(analysis.rootNote - expectedRoot) < 0.05,
+                "root " + juce::String(analysis.rootNote, 3) + ", confidence " + juce::String(analysis.pitchConfidence, 2));
+
+    // The start backs off at most 5 ms from the onset, and the tone ends where it fades out
+    const bool trimmed = analysis.startFrame <= onset && analysis.startFrame >= onset - 221
+                      && analysis.endFrame > onset + toneLength - 4410 && analysis.endFrame <= onset + toneLength + 441;
+    bench.check("analysis: trim", trimmed, "start " + juce::String(analysis.startFrame) + ", end " + juce::String(analysis.endFrame));
+
+    bench.check("analysis: loudness", analysis.loudnessLufs > -30.0f && analysis.loudnessLufs < -5.0f,
+                juce::String(analysis.loudnessLufs, 1) + " LUFS, gain " + juce::String(analysis.getNormalisationGain(), 2));
+}
+
+//==============================================================================
+// The JSON array inside a legacy script, parsed back into values
+static juce::var parseLegacyArray(const juce::String &script)
+{
+    return juce::JSON::parse(script.substring(script.indexOfChar('['), script.lastIndexOfChar(']') + 1));
+}
+
+static juce::MemoryBlock decodePayload(const juce::String &script)
+{
+    juce::MemoryOutputStream decoded;
+    const juce::String base64 = script.fromFirstOccurrenceOf("('", false, false).upToFirstOccurrenceOf("'", false, false);
+    juce::Base64::convertFromBase64(decoded, base64);
+    return decoded.getMemoryBlock();
+}
+
+static void benchmarkUiPayloads(MicroBench &bench)
+{
+    std::cout << std::endl
+              << "UI payloads (updateWaveformDisplay, updateSamplesList)" << std::endl;
+
+    juce::AudioBuffer<float> waveform(2, 441000);
+    fillWithNoise(waveform, 6, 1.0f);
+    const auto pagedWaveform = PagedAudioBuffer::fromBuffer(waveform);
+
+    juce::String legacy, binary;
+    int numPoints = 0;
+
+    auto buildLegacyWaveform = [&]
+    { legacy = legacyWaveformScript(waveform); };
+
+    auto buildBinaryWaveform = [&]
+    {
+        auto payload = BinaryPayload::encodeWaveform(*pagedWaveform, 2, numPoints);
+        binary = BinaryPayload::buildCall("setWaveformBinary", payload, "2, " + juce::String(numPoints));
+    };
+
+    buildLegacyWaveform();
+    buildBinaryWaveform();
+
+    // Both should carry the same points; the JSON text only keeps as many digits as it prints
+    {
+        const auto points = parseLegacyArray(legacy);
+        const auto payload = decodePayload(binary);
+        const auto *values = static_cast<const float *>(payload.getData());
+        bool passed = points.isArray() && points.size() == 2 && payload.getSize() == sizeof(float) * 2 * static_cast<size_t>(numPoints);
+        float difference = 0.0f;
+
+        for (int channel = 0; passed && channel < 2; ++channel)
+        {
+            const auto &channelPoints = points[channel];
+            passed = channelPoints.size() == numPoints;
+
+            for (int i = 0; passed && i < numPoints; ++i)
+                difference = juce::jmax(difference, std::abs(static_cast<float>(channelPoints[i]) - values[channel * numPoints + i]));
+        }
+
+        bench.check("waveform payload", passed && difference <= 1.0e-5f, describeDifference(difference));
+    }
+
+    bench.measure("waveform 1000 pts: JSON", 101, 1, static_cast<double>(legacy.getNumBytesAsUTF8()), "MB", buildLegacyWaveform);
+    bench.measure("waveform 1000 pts: binary", 101, 1, static_cast<double>(binary.getNumBytesAsUTF8()), "MB", buildBinaryWaveform);
+
+    SampleLibrary library;
+    juce::AudioBuffer<float> tiny(1, 1);
+    tiny.clear();
+
+    for (int i = 0; i < 10000; ++i)
+        library.loadFromBuffer("Sample \"" + juce::String(i) + "\" kick", tiny, 44100.0, "Category " + juce::String(i % 20));
+
+    auto buildLegacyList = [&]
+    { legacy = legacySampleListScript(library); };
+
+    auto buildBinaryList = [&]
+    { binary = BinaryPayload::buildCall("setSampleListData", BinaryPayload::encodeSampleList(library)); };
+
+    buildLegacyList();
+    buildBinaryList();
+
+    // Same categories, in the same order, holding the same names
+    {
+        const auto categories = parseLegacyArray(legacy);
+        const auto payload = decodePayload(binary);
+        juce::MemoryInputStream stream(payload, false);
+
+        const int numCategories = stream.readInt();
+        bool passed = categories.isArray() && categories.size() == numCategories;
+        std::vector<int> counts;
+
+        for (int i = 0; passed && i < numCategories; ++i)
+            counts.push_back(stream.readInt());
+
+        int numNames = 0;
+
+        for (int i = 0; passed && i < numCategories; ++i)
+        {
+            const auto &category = categories[i];
+            passed = stream.readString() == category["name"].toString()
+                     && category["samples"].size() == counts[static_cast<size_t>(i)];
+
+            for (int j = 0; passed && j < counts[static_cast<size_t>(i)]; ++j, ++numNames)
+                passed = stream.readString() == category["samples"][j].toString();
+        }
+
+        bench.check("sample list payload", passed, juce::String(numNames) + " names compared");
+    }
+
+    bench.measure("library 10k entries: JSON", 21, 1, static_cast<double>(legacy.getNumBytesAsUTF8()), "MB", buildLegacyList);
+    bench.measure("library 10k entries: binary", 21, 1, static_cast<double>(binary.getNumBytesAsUTF8()), "MB", buildBinaryList);
+}
+
+//==============================================================================
+int main(int argc, char **argv)
+{
+    juce::String filter;
+    juce::File csvFile, baselineFile;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const juce::String option(argv[i]);
+        const juce::String value(argv[i + 1]);
+
+        if (option == "--filter")
+            filter = value;
+        else if (option == "--csv")
+            csvFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+        else if (option == "--baseline")
+            baselineFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+    }
+
+    // Fewer interruptions from the rest of the system while timing
+    juce::Process::setPriority(juce::Process::HighPriority);
+
+    std::cout << "ProxyMicroBench (median per call, fastest run, interquartile spread)" << std::endl;
+
+    MicroBench bench(filter, baselineFile);
+
+    benchmarkVoiceKernel(bench);
+    benchmarkAntiPop(bench);
+    benchmarkLibrary(bench);
+    benchmarkCompressedStorage(bench);
+    benchmarkSampleAnalysis(bench);
+    benchmarkUiPayloads(bench);
+
+    if (csvFile != juce::File())
+        bench.writeCsv(csvFile);
+
+    if (bench.getNumFailures() > 0)
+    {
+        std::cout << std::endl
+                  << bench.getNumFailures() << " parity check(s) failed" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include "EditorSettings.h"
+
+EditorMode EditorSettings::getEffectiveMode() const
+{
+    const auto own = mode.load();
+    return own == EditorMode::useDefault ? getDefault() : own;
+}
+
+juce::File EditorSettings::getSettingsFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("Proxy/Settings.xml");
+}
+
+EditorMode EditorSettings::getDefault()
+{
+    // Read each time, so a default changed in another instance (or another process) applies to the next editor
+    if (auto xml = juce::parseXML(getSettingsFile()))
+        if (fromString(xml->getStringAttribute("editor")) == EditorMode::native)
+            return EditorMode::native;
+
+    return EditorMode::web;
+}
+
+void EditorSettings::setDefault(EditorMode newDefault)
+{
+    const auto file = getSettingsFile();
+    auto xml = juce::parseXML(file);
+
+    if (xml == nullptr)
+        xml = std::make_unique<juce::XmlElement>("ProxySettings");
+
+    xml->setAttribute("editor", toString(newDefault == EditorMode::native ? EditorMode::native : EditorMode::web));
+
+    file.getParentDirectory().createDirectory();
+    xml->writeTo(file);
+}
+
+juce::String EditorSettings::toString(EditorMode mode)
+{
+    switch (mode)
+    {
+    case EditorMode::web:
+        return "web";
+    case EditorMode::native:
+        return "native";
+    case EditorMode::useDefault:
+        break;
+    }
+
+    return "default";
+}
+
+EditorMode EditorSettings::fromString(const juce::String &text)
+{
+    if (text == "web")
+        return EditorMode::web;
+
+    if (text == "native")
+        return EditorMode::native;
+
+    return EditorMode::useDefault;
+}
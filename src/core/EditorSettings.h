@@ -0,0 +1,35 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+enum class EditorMode
+{
+    useDefault, // whatever the default editor is
+    web,        // the WebView page
+    native      // JUCE components only, no browser
+};
+
+// Which editor an instance opens. Each instance can choose its own (saved with its state) or
+// follow the default, which is shared by every instance and kept in Documents/Proxy/Settings.xml.
+// The instance's choice may be restored on a host thread; the default is only used on the message thread.
+class EditorSettings
+{
+public:
+    EditorMode getMode() const { return mode.load(); }
+    void setMode(EditorMode newMode) { mode = newMode; }
+
+    // The instance's own choice, or the default when it has none
+    EditorMode getEffectiveMode() const;
+
+    static EditorMode getDefault();
+    static void setDefault(EditorMode newDefault);
+
+    // "default", "web" or "native", as used in saved settings and page commands
+    static juce::String toString(EditorMode mode);
+    static EditorMode fromString(const juce::String &text);
+
+private:
+    std::atomic<EditorMode> mode{EditorMode::useDefault};
+
+    static juce::File getSettingsFile();
+};
@@ -2,13 +2,10 @@
 
 ProxyAudioProcessorEditor::ProxyAudioProcessorEditor(ProxyAudioProcessor &p)
     : AudioProcessorEditor(&p),
-      audioProcessor(p),
-      layoutView(p.getSamplerProcessor())
+      audioProcessor(p)
 {
-    addAndMakeVisible(layoutView);
-
-    // Start the timer for UI updates
-    startTimerHz(30);
+    // All periodic UI updates are driven by the view's timer
+    showChosenView();
 
     // Set initial size
     setSize(CANVAS_WIDTH, CANVAS_HEIGHT);
@@ -22,41 +19,61 @@ ProxyAudioProcessorEditor::ProxyAudioProcessorEditor(ProxyAudioProcessor &p)
 
 ProxyAudioProcessorEditor::~ProxyAudioProcessorEditor()
 {
-    stopTimer();
 }
 
-void ProxyAudioProcessorEditor::paint(juce::Graphics &g)
+void ProxyAudioProcessorEditor::showChosenView()
 {
-    // Painting is handled by the LayoutView
-}
+    const bool native = audioProcessor.getEditorSettings().getEffectiveMode() == EditorMode::native;
 
-void ProxyAudioProcessorEditor::resized()
-{
-    // Make the LayoutView fill the entire window
-    layoutView.setBounds(getLocalBounds());
-}
+    if (native ? nativeView != nullptr : layoutView != nullptr)
+        return;
 
-void ProxyAudioProcessorEditor::timerCallback()
-{
-    // Update UI with current meter levels
-    float leftLevel = audioProcessor.getLeftLevel();
-    float rightLevel = audioProcessor.getRightLevel();
+    layoutView = nullptr;
+    nativeView = nullptr;
+
+    // The choice is made from inside the view being replaced, so the swap waits until that call has returned
+    auto onEditorModeChanged = [safeThis = juce::Component::SafePointer<ProxyAudioProcessorEditor>(this)]
+    {
+        juce::MessageManager::callAsync([safeThis]
+                                        {
+                                            if (safeThis != nullptr)
+                                                safeThis->showChosenView();
+                                        });
+    };
 
-    // Scale meter values for display (convert RMS to dB then to percentage)
-    float leftDb = juce::Decibels::gainToDecibels(leftLevel, -60.0f);
-    float rightDb = juce::Decibels::gainToDecibels(rightLevel, -60.0f);
+    auto &samplerProcessor = audioProcessor.getSamplerProcessor();
+    auto &telemetry = audioProcessor.getTelemetry();
+    auto &editorSettings = audioProcessor.getEditorSettings();
+    juce::Component *view;
 
-    // Map from -60dB..0dB to 0%..100%
-    leftLevel = juce::jmap(leftDb, -60.0f, 0.0f, 0.0f, 100.0f);
-    rightLevel = juce::jmap(rightDb, -60.0f, 0.0f, 0.0f, 100.0f);
+    if (native)
+    {
+        nativeView = std::make_unique<NativeView>(samplerProcessor, telemetry, editorSettings);
+        nativeView->onEditorModeChanged = onEditorModeChanged;
+        view = nativeView.get();
+    }
+    else
+    {
+        layoutView = std::make_unique<LayoutView>(samplerProcessor, telemetry, editorSettings);
+        layoutView->onEditorModeChanged = onEditorModeChanged;
+        view = layoutView.get();
+    }
 
-    // Clip to valid range
-    leftLevel = juce::jlimit(0.0f, 100.0f, leftLevel);
-    rightLevel = juce::jlimit(0.0f, 100.0f, rightLevel);
+    addAndMakeVisible(view);
+    view->setBounds(getLocalBounds());
+}
+
+void ProxyAudioProcessorEditor::paint(juce::Graphics &g)
+{
+    // Painting is handled by the view
+}
 
-    // Update the layout view
-    layoutView.updateLevels(leftLevel, rightLevel);
+void ProxyAudioProcessorEditor::resized()
+{
+    // Make the view fill the entire window
+    if (layoutView != nullptr)
+        layoutView->setBounds(getLocalBounds());
 
-    // Update all voice positions
-    layoutView.updateAllPlaybackPositions();
-}
\ No newline at end of file
+    if (nativeView != nullptr)
+        nativeView->setBounds(getLocalBounds());
+}
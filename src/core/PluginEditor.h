@@ -3,9 +3,9 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 #include "LayoutView.h"
+#include "NativeView.h"
 
-class ProxyAudioProcessorEditor : public juce::AudioProcessorEditor,
-                                  private juce::Timer
+class ProxyAudioProcessorEditor : public juce::AudioProcessorEditor
 {
 public:
     static constexpr int CANVAS_WIDTH = 800;
@@ -20,9 +20,12 @@ public:
 private:
     ProxyAudioProcessor &audioProcessor;
 
-    LayoutView layoutView;
+    // One of the two is open, as chosen in the instance's EditorSettings
+    std::unique_ptr<LayoutView> layoutView;
+    std::unique_ptr<NativeView> nativeView;
 
-    void timerCallback() override;
+    // Open the chosen editor if it isn't the one showing
+    void showChosenView();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProxyAudioProcessorEditor)
-};
\ No newline at end of file
+};
@@ -1,18 +1,18 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "Trace.h"
 
+// An instrument, so the main input stays off; it is there so hosts treat the next bus as a sidechain
 ProxyAudioProcessor::ProxyAudioProcessor()
     : AudioProcessor(BusesProperties()
+                         .withInput("Input", juce::AudioChannelSet::stereo(), false)
+                         .withInput("Sidechain", juce::AudioChannelSet::stereo(), false)
                          .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
       attackTimeMs(5.0f),
       releaseTimeMs(100.0f),
       gainValue(1.0f),
       monophonic(false)
 {
-    // Initialize level meters
-    levelLeft.reset(getSampleRate(), 0.1); // Smooth over 100ms
-    levelRight.reset(getSampleRate(), 0.1);
-
     // Set initial parameters to the sampler
     samplerProcessor.setAttack(attackTimeMs);
     samplerProcessor.setRelease(releaseTimeMs);
@@ -46,7 +46,7 @@ bool ProxyAudioProcessor::isMidiEffect() const
 
 double ProxyAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return samplerProcessor.getTailLengthSeconds();
 }
 
 int ProxyAudioProcessor::getNumPrograms()
@@ -77,9 +77,8 @@ void ProxyAudioProcessor::changeProgramName(int index, const juce::String &newNa
 
 void ProxyAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    // Initialize level meters with the correct sample rate
-    levelLeft.reset(sampleRate, 0.1);
-    levelRight.reset(sampleRate, 0.1);
+    // Prepare metering for the largest block we can be given
+    meterEngine.prepare(sampleRate, samplesPerBlock);
 
     // Prepare sampler processor
     samplerProcessor.prepareToPlay(sampleRate, samplesPerBlock);
@@ -96,6 +95,16 @@ bool ProxyAudioProcessor::isBusesLayoutSupported(const BusesLayout &layouts) con
     if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono() && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
         return false;
 
+    // Nothing reads the main input
+    if (!layouts.getMainInputChannelSet().isDisabled())
+        return false;
+
+    // The sidechain, only used for recording, can be off, mono or stereo
+    const auto sidechain = layouts.getChannelSet(true, SIDECHAIN_BUS);
+
+    if (!sidechain.isDisabled() && sidechain != juce::AudioChannelSet::mono() && sidechain != juce::AudioChannelSet::stereo())
+        return false;
+
     return true;
 }
 
@@ -104,6 +113,11 @@ void ProxyAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::M
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
+    auto &recorder = samplerProcessor.getRecorder();
+
+    // The sidechain arrives in the output channels, so it is recorded before the sampler writes over it
+    if (totalNumInputChannels > 0 && getBusCount(true) > SIDECHAIN_BUS)
+        recorder.capture(SampleRecorder::Source::sidechain, getBusBuffer(buffer, true, SIDECHAIN_BUS), buffer.getNumSamples());
 
     // Clear any output channels that didn't contain input data
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
@@ -112,18 +126,41 @@ void ProxyAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::M
     // Process through our sampler
     samplerProcessor.processBlock(buffer, midiMessages);
 
+    recorder.capture(SampleRecorder::Source::output, buffer, buffer.getNumSamples());
+
     // Update level meters
-    if (totalNumOutputChannels > 0)
-    {
-        levelLeft.setTargetValue(buffer.getRMSLevel(0, 0, buffer.getNumSamples()));
-        levelLeft.skip(buffer.getNumSamples());
-    }
+    meterEngine.process(buffer, buffer.getNumSamples());
+
+    publishTelemetry();
+}
 
-    if (totalNumOutputChannels > 1)
+void ProxyAudioProcessor::publishTelemetry()
+{
+    TelemetryFrame frame;
+    frame.meters = meterEngine.getSnapshot();
+    frame.sampleLength = samplerProcessor.getCurrentSampleLength();
+
+    const auto &voicePositions = samplerProcessor.getAllVoicePositions();
+
+    for (int i = 0; i < SamplerProcessor::MAX_VOICES; ++i)
     {
-        levelRight.setTargetValue(buffer.getRMSLevel(1, 0, buffer.getNumSamples()));
-        levelRight.skip(buffer.getNumSamples());
+        if (voicePositions[i].isActive)
+        {
+            frame.voicePositions[i] = voicePositions[i].position;
+            frame.voiceLevels[i] = voicePositions[i].level;
+            frame.numActiveVoices++;
+        }
     }
+
+    // Once the UI has been sent one idle frame there is nothing more to tell it. An idle frame that
+    // didn't fit (no editor is draining the ring) is sent again, so a reopened editor gets one.
+    const bool idle = frame.isIdle();
+
+    if (idle && telemetryIdle)
+        return;
+
+    const bool sent = telemetry.push(frame);
+    telemetryIdle = idle && sent;
 }
 
 bool ProxyAudioProcessor::hasEditor() const
@@ -148,11 +185,90 @@ void ProxyAudioProcessor::getStateInformation(juce::MemoryBlock &destData)
     stream.writeBool(samplerProcessor.isMonophonic());
 
     // Save currently selected sample name
-    stream.writeString(samplerProcessor.getCurrentSampleName());
+    const auto sample = samplerProcessor.getCurrentSampleReference();
+    stream.writeString(sample.name);
+
+    // Save loop points and crossfade (appended, so older states still load)
+    const auto &sustainLoop = samplerProcessor.getSustainLoop();
+    const auto &releaseLoop = samplerProcessor.getReleaseLoop();
+    auto toInt = [](juce::int64 frame) { return static_cast<int>(juce::jmin<juce::int64>(frame, std::numeric_limits<int>::max())); };
+    stream.writeInt(toInt(sustainLoop.start));
+    stream.writeInt(toInt(sustainLoop.end));
+    stream.writeInt(toInt(releaseLoop.start));
+    stream.writeInt(toInt(releaseLoop.end));
+    stream.writeFloat(samplerProcessor.getLoopCrossfade());
+
+    // Save playback mode and granular controls
+    const auto &granular = samplerProcessor.getGranularParameters();
+    stream.writeInt(static_cast<int>(samplerProcessor.getPlaybackMode()));
+    stream.writeFloat(granular.position);
+    stream.writeFloat(granular.speed);
+    stream.writeFloat(granular.spray);
+    stream.writeFloat(granular.density);
+    stream.writeFloat(granular.grainSizeMs);
+    stream.writeFloat(granular.pitchSemitones);
+
+    // Save filter settings
+    const auto &filter = samplerProcessor.getFilterParameters();
+    stream.writeInt(static_cast<int>(filter.mode));
+    stream.writeFloat(filter.cutoffHz);
+    stream.writeFloat(filter.resonance);
+    stream.writeFloat(filter.envelopeAmount);
+    stream.writeFloat(filter.velocityAmount);
+    stream.writeFloat(filter.attackMs);
+    stream.writeFloat(filter.decayMs);
+    stream.writeFloat(filter.sustain);
+    stream.writeFloat(filter.releaseMs);
+
+    // Save reverb impulse response and mix
+    stream.writeString(samplerProcessor.getReverbImpulse());
+    stream.writeFloat(samplerProcessor.getReverbMix());
+
+    // Save modulation settings
+    const auto &modulation = samplerProcessor.getModulationParameters();
+    stream.writeFloat(modulation.pitchBendRange);
+    stream.writeInt(modulation.mpeEnabled ? 1 : 0);
+    stream.writeFloat(modulation.mpeBendRange);
+    stream.writeFloat(modulation.glideMs);
+    stream.writeFloat(modulation.pressureToVolume);
+    stream.writeFloat(modulation.timbreToCutoff);
+
+    for (const auto &lfo : modulation.lfos)
+    {
+        stream.writeFloat(lfo.rateHz);
+        stream.writeFloat(lfo.depth);
+        stream.writeInt(static_cast<int>(lfo.shape));
+        stream.writeInt(static_cast<int>(lfo.target));
+    }
+
+    // Save the loop points again at full 64-bit range; the int copies above are for older versions
+    stream.writeInt64(sustainLoop.start);
+    stream.writeInt64(sustainLoop.end);
+    stream.writeInt64(releaseLoop.start);
+    stream.writeInt64(releaseLoop.end);
+
+    // Sample storage mode
+    stream.writeBool(samplerProcessor.isCompressedStorage());
+
+    // Where the sample came from, so it can be found by content or path without the library scan
+    stream.writeString(sample.contentHash);
+    stream.writeString(sample.file.getFullPathName());
+
+    // This instance's editor choice
+    stream.writeInt(static_cast<int>(editorSettings.getMode()));
+
+    // Pitched note cache budget
+    stream.writeInt(samplerProcessor.getNoteCacheBudget());
+
+    // Whether notes follow the sample's analysis
+    stream.writeBool(samplerProcessor.isAnalysisApplied());
 }
 
 void ProxyAudioProcessor::setStateInformation(const void *data, int sizeInBytes)
 {
+    PROXY_TRACE_SCOPE("setStateInformation");
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+
     // Restore processor state
     juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
 
@@ -173,13 +289,141 @@ void ProxyAudioProcessor::setStateInformation(const void *data, int sizeInBytes)
         samplerProcessor.setGain(gain);
         samplerProcessor.setMonophonic(isMonophonic);
 
-        // Load sample name
-        juce::String sampleName = stream.readString();
-        if (sampleName.isNotEmpty())
+        // Load sample name; the sample itself is restored last, once everything about it has been read
+        SampleReference sample;
+        sample.name = stream.readString();
+
+        std::optional<SampleLoop> sustainLoop, releaseLoop;
+
+        // Load loop points and crossfade if present
+        if (stream.getNumBytesRemaining() >= sizeof(int) * 4 + sizeof(float))
         {
-            samplerProcessor.setSample(sampleName);
+            SampleLoop loops[2];
+
+            for (auto &loop : loops)
+            {
+                loop.start = stream.readInt();
+                loop.end = stream.readInt();
+            }
+
+            sustainLoop = loops[0];
+            releaseLoop = loops[1];
+
+            samplerProcessor.setLoopCrossfade(stream.readFloat());
+        }
+
+        // Load playback mode and granular controls if present
+        if (stream.getNumBytesRemaining() >= sizeof(int) + sizeof(float) * 6)
+        {
+            const bool granularMode = stream.readInt() == static_cast<int>(PlaybackMode::granular);
+
+            GranularParameters granular;
+            granular.position = stream.readFloat();
+            granular.speed = stream.readFloat();
+            granular.spray = stream.readFloat();
+            granular.density = stream.readFloat();
+            granular.grainSizeMs = stream.readFloat();
+            granular.pitchSemitones = stream.readFloat();
+
+            samplerProcessor.setGranularParameters(granular);
+            samplerProcessor.setPlaybackMode(granularMode ? PlaybackMode::granular : PlaybackMode::sample);
+        }
+
+        // Load filter settings if present
+        if (stream.getNumBytesRemaining() >= sizeof(int) + sizeof(float) * 8)
+        {
+            FilterParameters filter;
+            filter.mode = static_cast<FilterParameters::Mode>(juce::jlimit(0, static_cast<int>(FilterParameters::Mode::notch), stream.readInt()));
+            filter.cutoffHz = stream.readFloat();
+            filter.resonance = stream.readFloat();
+            filter.envelopeAmount = stream.readFloat();
+            filter.velocityAmount = stream.readFloat();
+            filter.attackMs = stream.readFloat();
+            filter.decayMs = stream.readFloat();
+            filter.sustain = stream.readFloat();
+            filter.releaseMs = stream.readFloat();
+
+            samplerProcessor.setFilterParameters(filter);
+        }
+
+        // Load reverb settings if present
+        if (stream.getNumBytesRemaining() >= 1 + sizeof(float))
+        {
+            samplerProcessor.setReverbImpulse(stream.readString());
+            samplerProcessor.setReverbMix(stream.readFloat());
         }
+
+        // Load modulation settings if present
+        if (stream.getNumBytesRemaining() >= sizeof(int) + sizeof(float) * 5 + (sizeof(float) * 2 + sizeof(int) * 2) * ModulationParameters::NUM_LFOS)
+        {
+            ModulationParameters modulation;
+            modulation.pitchBendRange = stream.readFloat();
+            modulation.mpeEnabled = stream.readInt() != 0;
+            modulation.mpeBendRange = stream.readFloat();
+            modulation.glideMs = stream.readFloat();
+            modulation.pressureToVolume = stream.readFloat();
+            modulation.timbreToCutoff = stream.readFloat();
+
+            for (auto &lfo : modulation.lfos)
+            {
+                lfo.rateHz = stream.readFloat();
+                lfo.depth = stream.readFloat();
+                lfo.shape = static_cast<ModulationParameters::LfoShape>(juce::jlimit(0, static_cast<int>(ModulationParameters::LfoShape::square), stream.readInt()));
+                lfo.target = static_cast<ModulationParameters::LfoTarget>(juce::jlimit(0, static_cast<int>(ModulationParameters::LfoTarget::volume), stream.readInt()));
+            }
+
+            samplerProcessor.setModulationParameters(modulation);
+        }
+
+        // Load 64-bit loop points if present; they replace the int ones for samples past 2^31 frames
+        if (stream.getNumBytesRemaining() >= sizeof(juce::int64) * 4)
+        {
+            SampleLoop loops[2];
+
+            for (auto &loop : loops)
+            {
+                loop.start = stream.readInt64();
+                loop.end = stream.readInt64();
+            }
+
+            sustainLoop = loops[0];
+            releaseLoop = loops[1];
+        }
+
+        // Load sample storage mode if present
+        if (stream.getNumBytesRemaining() >= 1)
+            samplerProcessor.setCompressedStorage(stream.readBool());
+
+        // Load the sample's content hash and file if present
+        if (stream.getNumBytesRemaining() >= 2)
+        {
+            sample.contentHash = stream.readString();
+
+            const auto path = stream.readString();
+
+            if (juce::File::isAbsolutePath(path))
+                sample.file = juce::File(path);
+        }
+
+        // Load the editor choice if present
+        if (stream.getNumBytesRemaining() >= sizeof(int))
+            editorSettings.setMode(static_cast<EditorMode>(juce::jlimit(0, static_cast<int>(EditorMode::native), stream.readInt())));
+
+        // Load the note cache budget if present, before the sample so its sound is made with it
+        if (stream.getNumBytesRemaining() >= sizeof(int))
+            samplerProcessor.setNoteCacheBudget(stream.readInt());
+
+        // Load the analysis setting if present, also before the sample. Projects saved before there was
+        // one played samples untouched, so they keep doing so; only new instances start with it on.
+        samplerProcessor.setAnalysisApplied(stream.getNumBytesRemaining() >= 1 && stream.readBool());
+
+        // Doesn't wait for the sample: one that isn't loaded yet decodes in the background
+        if (sample.name.isNotEmpty() || sample.contentHash.isNotEmpty())
+            samplerProcessor.restoreSample(sample, sustainLoop, releaseLoop);
     }
+
+    juce::Logger::writeToLog("Proxy state restored in " + juce::String(juce::Time::getMillisecondCounterHiRes() - startMs, 1) + " ms"
+                             + (samplerProcessor.isRestoringSample() ? ", sample loading in the background" : ""));
 }
 
 // This creates new instances of the plugin
@@ -2,6 +2,9 @@
 
 #include <JuceHeader.h>
 #include "SamplerProcessor.h"
+#include "TelemetryChannel.h"
+#include "MeterEngine.h"
+#include "EditorSettings.h"
 
 class ProxyAudioProcessor : public juce::AudioProcessor
 {
@@ -38,11 +41,16 @@ public:
     // Access to the sampler processor
     SamplerProcessor &getSamplerProcessor() { return samplerProcessor; }
 
-    // Audio level metering
-    float getLeftLevel() const { return levelLeft.getCurrentValue(); }
-    float getRightLevel() const { return levelRight.getCurrentValue(); }
+    // Meter levels and voice positions for the UI, published once per block
+    TelemetryChannel &getTelemetry() { return telemetry; }
+
+    // Which editor this instance opens
+    EditorSettings &getEditorSettings() { return editorSettings; }
 
 private:
+    // Input buses: the main input (always off) and the sidechain, which is only recorded
+    static constexpr int SIDECHAIN_BUS = 1;
+
     SamplerProcessor samplerProcessor;
 
     // Parameter values
@@ -52,7 +60,15 @@ private:
     bool monophonic;
 
     // Level metering
-    juce::LinearSmoothedValue<float> levelLeft, levelRight;
+    MeterEngine meterEngine;
+
+    // UI telemetry
+    TelemetryChannel telemetry;
+    bool telemetryIdle = false;
+
+    EditorSettings editorSettings;
+
+    void publishTelemetry();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProxyAudioProcessor)
 };
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "RenderGovernor.h"
+
+void RenderGovernor::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    reset();
+}
+
+void RenderGovernor::reset()
+{
+    quality = Quality::full;
+    smoothedLoad = 0.0;
+    quietBlocks = 0;
+
+    // Render at least one block before deciding that nothing is sounding
+    silent = false;
+    samplesUntilSilent = 0;
+}
+
+void RenderGovernor::updateSilence(bool sounding, int numSamples, double tailSeconds)
+{
+    if (sounding)
+    {
+        // Effects keep ringing for their tail after the last voice stops
+        samplesUntilSilent = static_cast<juce::int64>(std::ceil(tailSeconds * sampleRate));
+        silent = false;
+        return;
+    }
+
+    samplesUntilSilent -= numSamples;
+    silent = samplesUntilSilent <= 0;
+}
+
+void RenderGovernor::endBlock(juce::int64 startTicks, int numSamples)
+{
+    counters.renderedBlocks.fetch_add(1, std::memory_order_relaxed);
+
+    if (numSamples <= 0)
+        return;
+
+    const double elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    const double load = elapsed * sampleRate / numSamples;
+    smoothedLoad += 0.1 * (load - smoothedLoad);
+
+    const bool late = load > DEADLINE_LOAD;
+
+    if (late)
+        counters.lateBlocks.fetch_add(1, std::memory_order_relaxed);
+
+    // Step down at once when a block comes close to the deadline or the average is too high
+    if ((late || smoothedLoad > PRESSURE_LOAD) && quality != Quality::cullInaudible)
+    {
+        quality = static_cast<Quality>(static_cast<int>(quality) + 1);
+        counters.qualityReductions.fetch_add(1, std::memory_order_relaxed);
+        quietBlocks = 0;
+        return;
+    }
+
+    // Step back up only after a sustained stretch of headroom
+    quietBlocks = smoothedLoad < RECOVERY_LOAD ? quietBlocks + 1 : 0;
+
+    if (quietBlocks >= RECOVERY_BLOCKS && quality != Quality::full)
+    {
+        quality = static_cast<Quality>(static_cast<int>(quality) - 1);
+        counters.qualityRestores.fetch_add(1, std::memory_order_relaxed);
+        quietBlocks = 0;
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Keeps the sampler inside its CPU budget.
+// While nothing is sounding and every effect tail has rung out, blocks can skip voice work
+// entirely. Under load it steps quality down (cheaper interpolation, then culling voices that
+// are releasing below audibility) and steps back up once there is headroom again.
+// Everything it does is counted so it can be inspected from outside the audio thread.
+class RenderGovernor
+{
+public:
+    enum class Quality
+    {
+        full,                 // linear interpolation, every voice kept
+        reducedInterpolation, // nearest-sample reads
+        cullInaudible         // also stop releasing voices below CULL_LEVEL
+    };
+
+    // Share of the block's real-time budget that counts as pressure, and as near the deadline
+    static constexpr double PRESSURE_LOAD = 0.6;
+    static constexpr double DEADLINE_LOAD = 0.9;
+
+    // Smoothed load below which quality steps back up, after RECOVERY_BLOCKS in a row
+    static constexpr double RECOVERY_LOAD = 0.3;
+    static constexpr int RECOVERY_BLOCKS = 100;
+
+    // Voice peak (after gain) below which a releasing voice may be culled
+    static constexpr float CULL_LEVEL = 0.001f; // -60 dBFS
+
+    struct Counters
+    {
+        std::atomic<juce::uint64> renderedBlocks{0};
+        std::atomic<juce::uint64> idleBlocks{0};       // skipped by the idle fast path
+        std::atomic<juce::uint64> lateBlocks{0};       // rendered in more than DEADLINE_LOAD of the budget
+        std::atomic<juce::uint64> qualityReductions{0};
+        std::atomic<juce::uint64> qualityRestores{0};
+        std::atomic<juce::uint64> voicesCulled{0};
+    };
+
+    RenderGovernor() = default;
+
+    void prepare(double sampleRate);
+    void reset();
+
+    // Idle fast path: true once nothing is sounding and every tail has finished
+    bool canSkipBlock() const { return silent; }
+    void skipBlock() { counters.idleBlocks.fetch_add(1, std::memory_order_relaxed); }
+
+    // After rendering: whether anything is still sounding, and how long effects may ring after it stops
+    void updateSilence(bool sounding, int numSamples, double tailSeconds);
+
+    // Time a rendered block against its real-time budget and adjust quality
+    juce::int64 beginBlock() const { return juce::Time::getHighResolutionTicks(); }
+    void endBlock(juce::int64 startTicks, int numSamples);
+
+    Quality getQuality() const { return quality; }
+    bool shouldInterpolate() const { return quality == Quality::full; }
+    bool shouldCullInaudible() const { return quality == Quality::cullInaudible; }
+    void countCulledVoice() { counters.voicesCulled.fetch_add(1, std::memory_order_relaxed); }
+
+    // Smoothed share of the real-time budget spent rendering
+    double getLoad() const { return smoothedLoad; }
+
+    const Counters &getCounters() const { return counters; }
+
+private:
+    double sampleRate = 44100.0;
+    Quality quality = Quality::full;
+    double smoothedLoad = 0.0;
+    int quietBlocks = 0;
+
+    bool silent = false;
+    juce::int64 samplesUntilSilent = 0;
+
+    Counters counters;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderGovernor)
+};
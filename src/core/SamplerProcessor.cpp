@@ -1,263 +1,11 @@
 #include "SamplerProcessor.h"
 #include <BinaryData.h>
+#include "SamplerVoice.h"
+#include "GranularVoice.h"
+#include "AntiPopFade.h"
+#include "Trace.h"
 
-// Forward declare our custom classes
-class ProxySamplerSound;
-class ProxySamplerVoice;
-
-// Custom sampler sound that contains an audio buffer
-class ProxySamplerSound : public juce::SynthesiserSound
-{
-public:
-    ProxySamplerSound(const juce::String &soundName, const juce::AudioBuffer<float> &buffer)
-        : name(soundName)
-    {
-        // Make a copy of the buffer
-        audioData.setSize(buffer.getNumChannels(), buffer.getNumSamples());
-        audioData.copyFrom(0, 0, buffer, 0, 0, buffer.getNumSamples());
-        if (buffer.getNumChannels() > 1)
-            audioData.copyFrom(1, 0, buffer, 1, 0, buffer.getNumSamples());
-    }
-
-    // SynthesiserSound interface implementation
-    bool appliesToNote(int /*midiNoteNumber*/) override { return true; }
-    bool appliesToChannel(int /*midiChannel*/) override { return true; }
-
-    // Provide access to the audio data
-    const juce::AudioBuffer<float> &getAudioData() const { return audioData; }
-
-    const juce::String &getName() const { return name; }
-
-private:
-    juce::AudioBuffer<float> audioData;
-    juce::String name;
-};
-
-// A custom sampler voice that plays a buffer
-class ProxySamplerVoice : public juce::SynthesiserVoice
-{
-public:
-    ProxySamplerVoice()
-        : currentSamplePosition(0.0),
-          pitchRatio(0.0),
-          sourceSamplePosition(0.0),
-          lgain(0.0f),
-          rgain(0.0f),
-          attackSamples(0.0),
-          releaseSamples(0.0),
-          attackRate(0.0),
-          releaseRate(0.0),
-          attackPhase(false),
-          releasePhase(false),
-          envelopeLevel(0.0),
-          currentMidiNote(-1),
-          sampleRate(44100.0), // Default sample rate
-          shouldKill(false)
-    {
-    }
-
-    bool canPlaySound(juce::SynthesiserSound *sound) override
-    {
-        // Check if this is our custom sound class
-        return dynamic_cast<ProxySamplerSound *>(sound) != nullptr;
-    }
-
-    void startNote(int midiNoteNumber, float velocity,
-                   juce::SynthesiserSound *s, int /*currentPitchWheelPosition*/) override
-    {
-        if (auto *sound = dynamic_cast<ProxySamplerSound *>(s))
-        {
-            // Calculate pitch ratio based on the difference between the played MIDI note and middle C (60)
-            pitchRatio = std::pow(2.0, (midiNoteNumber - 60) / 12.0);
-
-            // Store the MIDI note number
-            currentMidiNote = midiNoteNumber;
-
-            // Reset sample position for the new note
-            sourceSamplePosition = 0.0;
-
-            // Apply velocity scaling
-            lgain = velocity;
-            rgain = velocity;
-
-            // Reset envelope
-            envelopeLevel = 0.0;
-
-            attackPhase = true;
-            releasePhase = false;
-            shouldKill = false;
-        }
-        else
-        {
-            stopNote(0.0f, false);
-        }
-    }
-
-    void stopNote(float /*velocity*/, bool allowTailOff) override
-    {
-        if (allowTailOff)
-        {
-            releasePhase = true;
-            attackPhase = false;
-        }
-        else
-        {
-            shouldKill = true;
-        }
-    }
-
-    void setAttackRate(double newSampleRate, double attackTimeMs)
-    {
-        sampleRate = newSampleRate;
-        attackSamples = sampleRate * (attackTimeMs / 1000.0);
-        attackRate = attackSamples > 0 ? 1.0 / attackSamples : 1.0;
-    }
-
-    void setReleaseRate(double newSampleRate, double releaseTimeMs)
-    {
-        sampleRate = newSampleRate;
-        releaseSamples = sampleRate * (releaseTimeMs / 1000.0);
-        releaseRate = releaseSamples > 0 ? 1.0 / releaseSamples : 1.0;
-    }
-
-    void pitchWheelMoved(int /*newValue*/) override {}
-    void controllerMoved(int /*controllerNumber*/, int /*newValue*/) override {}
-
-    void renderNextBlock(juce::AudioBuffer<float> &outputBuffer, int startSample, int numSamples) override
-    {
-        if (shouldKill)
-        {
-            clearCurrentNote();
-            return;
-        }
-
-        if (auto *playingSound = dynamic_cast<ProxySamplerSound *>(getCurrentlyPlayingSound().get()))
-        {
-            const juce::AudioBuffer<float> &audioData = playingSound->getAudioData();
-            const float *const inL = audioData.getReadPointer(0);
-            const float *const inR = audioData.getNumChannels() > 1 ? audioData.getReadPointer(1) : nullptr;
-
-            float *outL = outputBuffer.getWritePointer(0, startSample);
-            float *outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer(1, startSample) : nullptr;
-
-            // Working copies of member variables for better performance
-            double localSourceSamplePosition = this->sourceSamplePosition;
-            double localEnvelopeLevel = this->envelopeLevel;
-            bool localAttackPhase = this->attackPhase;
-            bool localReleasePhase = this->releasePhase;
-
-            for (int sampleIndex = 0; sampleIndex < numSamples; ++sampleIndex)
-            {
-                // Current position in the sample
-                int pos = static_cast<int>(localSourceSamplePosition);
-                float alpha = static_cast<float>(localSourceSamplePosition - pos);
-                float invAlpha = 1.0f - alpha;
-
-                // Safety check for position
-                if (pos >= audioData.getNumSamples() - 1)
-                {
-                    pos = audioData.getNumSamples() - 2;
-                    if (pos < 0)
-                        pos = 0;
-                }
-                int nextPos = pos + 1;
-
-                // Update envelope
-                if (localAttackPhase)
-                {
-                    localEnvelopeLevel += attackRate;
-                    if (localEnvelopeLevel >= 1.0)
-                    {
-                        localEnvelopeLevel = 1.0;
-                        localAttackPhase = false;
-                    }
-                }
-                else if (localReleasePhase)
-                {
-                    localEnvelopeLevel -= releaseRate;
-                    if (localEnvelopeLevel <= 0.0)
-                    {
-                        clearCurrentNote();
-                        break;
-                    }
-                }
-
-                // Get current sample with interpolation
-                float l = (inL[pos] * invAlpha + inL[nextPos] * alpha) * static_cast<float>(localEnvelopeLevel);
-                float r = inR != nullptr ? (inR[pos] * invAlpha + inR[nextPos] * alpha) * static_cast<float>(localEnvelopeLevel) : l;
-
-                // Apply output gain
-                if (outR != nullptr)
-                {
-                    outL[sampleIndex] += l * lgain;
-                    outR[sampleIndex] += r * rgain;
-                }
-                else
-                {
-                    outL[sampleIndex] += l * lgain;
-                }
-
-                // Update source position
-                localSourceSamplePosition += pitchRatio;
-
-                // Handle loop or end of sample
-                if (localSourceSamplePosition >= audioData.getNumSamples())
-                {
-                    if (!localReleasePhase)
-                    {
-                        localReleasePhase = true;
-                    }
-                    localSourceSamplePosition = 0.0;
-                }
-            }
-
-            // Save back the updated values
-            this->sourceSamplePosition = localSourceSamplePosition;
-            this->envelopeLevel = localEnvelopeLevel;
-            this->attackPhase = localAttackPhase;
-            this->releasePhase = localReleasePhase;
-            this->currentSamplePosition = static_cast<int>(localSourceSamplePosition);
-        }
-    }
-
-    bool isVoiceActive() const
-    {
-        return getCurrentlyPlayingSound() != nullptr && !releasePhase && !shouldKill;
-    }
-
-    // Current sample position as a percentage of the total length
-    double getCurrentSamplePosition() const
-    {
-        if (auto *sound = dynamic_cast<ProxySamplerSound *>(getCurrentlyPlayingSound().get()))
-        {
-            // Return current sample position as a proportion of the total sample length
-            return sourceSamplePosition;
-        }
-        return 0.0;
-    }
-
-    int getCurrentMidiNote() const
-    {
-        return currentMidiNote;
-    }
-
-private:
-    double currentSamplePosition;
-    double pitchRatio;
-    double sourceSamplePosition;
-    float lgain, rgain;
-
-    // Envelope parameters
-    double attackSamples, releaseSamples;
-    double attackRate, releaseRate;
-    bool attackPhase, releasePhase;
-    double envelopeLevel;
-
-    // MIDI and state
-    int currentMidiNote;
-    double sampleRate;
-    bool shouldKill;
-};
+static_assert(SamplerProcessor::MAX_VOICES == VoiceFilterBank::MAX_VOICES, "one filter lane per voice");
 
 SamplerProcessor::SamplerProcessor()
     : currentSamplePosition(0),
@@ -270,10 +18,7 @@ SamplerProcessor::SamplerProcessor()
     sampler = std::make_unique<juce::Synthesiser>();
 
     // Add voices to the sampler
-    for (int i = 0; i < MAX_VOICES; ++i)
-    {
-        sampler->addVoice(new ProxySamplerVoice());
-    }
+    createVoices();
 
     // Initialize voice positions
     for (auto &voicePos : voicePositions)
@@ -283,9 +28,25 @@ SamplerProcessor::SamplerProcessor()
     }
 
     // Initialize anti-pop buffer
-    antiPopBuffer.setSize(2, 512); // 2 channels, small buffer
+    antiPopBuffer.setSize(2, MAX_SUB_BLOCK);
     antiPopBuffer.clear();
 
+    // Finished recordings join the library and play straight away
+    recorder.onFinished = [this](SampleData recording)
+    {
+        sampleLibrary.addRecording(std::move(recording), [this](const juce::String &name)
+                                   { setSample(name); });
+    };
+
+    // A sound made before its sample's mipmap was built only has the source to read; once the octaves
+    // are there it is made again, so transposing up reads them instead of aliasing. Playing notes keep
+    // the old sound until they end.
+    sampleLibrary.onMipmapReady = [this](const juce::String &name)
+    {
+        if (name == currentSampleName && !restorePending)
+            setSample(name);
+    };
+
     // Load the default samples
     loadDefaultSamples();
 }
@@ -296,14 +57,20 @@ SamplerProcessor::~SamplerProcessor()
 
 void SamplerProcessor::loadDefaultSamples()
 {
-    // Scan the user's samples folder in Documents/Proxy/Samples
-    juce::StringArray userSamples = sampleLibrary.scanUserSamplesFolder();
-
-    // If user samples were found, use the first one as default
-    if (userSamples.size() > 0)
-    {
-        setSample(userSamples[0]);
-    }
+    // Scan the user's samples folder in Documents/Proxy/Samples, off the thread creating the plugin
+    sampleLibrary.scanUserSamplesFolderInBackground([this]
+                                                    {
+                                                        // A restored state may have named an impulse the library didn't have yet
+                                                        if (pendingReverbImpulse.isNotEmpty())
+                                                            setReverbImpulse(pendingReverbImpulse);
+
+                                                        // If user samples were found, use the first one as default, unless a
+                                                        // sample was chosen or restored meanwhile
+                                                        juce::StringArray userSamples = sampleLibrary.getAvailableSamples();
+
+                                                        if (currentSampleName.isEmpty() && !restorePending && userSamples.size() > 0)
+                                                            setSample(userSamples[0]);
+                                                    });
     // No fallback to built-in samples - we'll just display a message when no samples are found
 }
 
@@ -316,17 +83,31 @@ void SamplerProcessor::loadSample(const juce::File &file)
 
 bool SamplerProcessor::setSample(const juce::String &name)
 {
+    PROXY_TRACE_SCOPE("setSample");
+
     auto sampleData = sampleLibrary.getSampleAudioBuffer(name);
 
-    if (sampleData.buffer && sampleData.buffer->getNumSamples() > 0)
+    if (sampleData.getNumFrames() > 0)
     {
         sampler->clearSounds();
 
-        // Create a new ProxySamplerSound with the buffer
-        auto *sound = new ProxySamplerSound(name, *sampleData.buffer);
+        // Without its analysis the sound plays the whole sample, at its own level, rooted on middle C
+        if (!analysisApplied)
+            sampleData.analysis = SampleAnalysis();
+
+        // Create a new ProxySamplerSound with the buffer; granular voices need it decoded to floats,
+        // and only sample playback reads whole notes at a fixed pitch, so only it gets a note cache
+        const bool granular = playbackMode == PlaybackMode::granular;
+        auto *sound = new ProxySamplerSound(name, sampleData, loopCrossfadeMs, granular,
+                                            granular ? 0 : static_cast<size_t>(noteCacheMb) << 20);
 
         sampler->addSound(sound);
+        noteCacheBuilder.setCache(sound->getNoteCache());
         currentSampleName = name;
+        currentSampleLength = sampleData.getNumFrames();
+        currentSustainLoop = sampleData.sustainLoop;
+        currentReleaseLoop = sampleData.releaseLoop;
+        restorePending = false; // an explicit choice replaces a sample still being restored
         updateVoiceParameters();
         return true;
     }
@@ -334,6 +115,79 @@ bool SamplerProcessor::setSample(const juce::String &name)
     return false;
 }
 
+void SamplerProcessor::restoreSample(const SampleReference &reference, std::optional<SampleLoop> sustainLoop, std::optional<SampleLoop> releaseLoop)
+{
+    PROXY_TRACE_SCOPE("restoreSample");
+
+    restoreStartMs = juce::Time::getMillisecondCounterHiRes();
+    const int generation = ++restoreGeneration;
+
+    auto applyLoops = [this, sustainLoop, releaseLoop]
+    {
+        if (sustainLoop.has_value() && *sustainLoop != currentSustainLoop)
+            setSustainLoop(*sustainLoop);
+
+        if (releaseLoop.has_value() && *releaseLoop != currentReleaseLoop)
+            setReleaseLoop(*releaseLoop);
+    };
+
+    // Already loaded, by content or by name
+    auto name = sampleLibrary.findSampleByHash(reference.contentHash);
+
+    if (name.isEmpty() && sampleLibrary.containsSample(reference.name))
+        name = reference.name;
+
+    if (name.isNotEmpty() && setSample(name))
+    {
+        applyLoops();
+        restoreLatencyMs = juce::Time::getMillisecondCounterHiRes() - restoreStartMs;
+        return;
+    }
+
+    // Silent until it arrives: with no sound, note-ons don't start any voices
+    sampler->clearSounds();
+    noteCacheBuilder.setCache(nullptr);
+    pendingReference = reference;
+    restorePending = true;
+    currentSampleName = reference.name;
+    currentSampleLength = 0;
+    currentSustainLoop = sustainLoop.value_or(SampleLoop());
+    currentReleaseLoop = releaseLoop.value_or(SampleLoop());
+
+    sampleLibrary.loadInBackground(reference, [this, generation, applyLoops](const juce::String &loadedName)
+                                   {
+                                       // Superseded by a later restore or by choosing another sample
+                                       if (!restorePending || generation != restoreGeneration)
+                                           return;
+
+                                       restoreLatencyMs = juce::Time::getMillisecondCounterHiRes() - restoreStartMs;
+
+                                       // Still pending if it's missing, so saving keeps the reference
+                                       if (loadedName.isEmpty() || !setSample(loadedName))
+                                       {
+                                           juce::Logger::writeToLog("Proxy couldn't find sample '" + pendingReference.name + "'");
+                                           return;
+                                       }
+
+                                       applyLoops();
+                                       juce::Logger::writeToLog("Proxy restored sample '" + loadedName + "' in " + juce::String(restoreLatencyMs, 1) + " ms");
+                                   });
+}
+
+SampleReference SamplerProcessor::getCurrentSampleReference() const
+{
+    if (restorePending)
+        return pendingReference;
+
+    const auto sampleData = sampleLibrary.getSampleAudioBuffer(currentSampleName);
+
+    SampleReference reference;
+    reference.name = currentSampleName;
+    reference.contentHash = sampleData.contentHash;
+    reference.file = sampleData.file;
+    return reference;
+}
+
 juce::StringArray SamplerProcessor::getAvailableSamples() const
 {
     return sampleLibrary.getAvailableSamples();
@@ -344,22 +198,82 @@ juce::String SamplerProcessor::getCurrentSampleName() const
     return currentSampleName;
 }
 
+bool SamplerProcessor::startRecording(SampleRecorder::Source source)
+{
+    return recorder.start(source, sampleLibrary.getSamplesFolder().getChildFile("Recordings"));
+}
+
 void SamplerProcessor::prepareToPlay(double sampleRate, int /*samplesPerBlock*/)
 {
+    // Nothing renders more than a sub-block at a time, so that is all the scratch space needs,
+    // even when the host sends more than it announced
     sampler->setCurrentPlaybackSampleRate(sampleRate);
+    filterBank.prepare(sampleRate, MAX_SUB_BLOCK);
+    modulation.prepare(sampleRate, MAX_SUB_BLOCK);
+    performanceMessages.ensureSize(2048);
+    subBlockMidi.ensureSize(2048);
+    reverb.prepare(sampleRate, MAX_SUB_BLOCK);
+    governor.prepare(sampleRate);
+    antiPopBuffer.setSize(2, MAX_SUB_BLOCK, false, true, true);
+    recorder.prepare(sampleRate);
     updateVoiceParameters();
 }
 
 void SamplerProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
 {
+    PROXY_TRACE_THREAD("Audio");
+    PROXY_TRACE_SCOPE("processBlock");
+
+    const int numSamples = buffer.getNumSamples();
+
+    if (numSamples <= MAX_SUB_BLOCK)
+    {
+        processSubBlock(buffer, midiMessages);
+        return;
+    }
+
+    // Offline hosts can send blocks of thousands of frames; each piece refers into the host buffer,
+    // with its MIDI moved to the piece's own timeline
+    for (int start = 0; start < numSamples; start += MAX_SUB_BLOCK)
+    {
+        const int length = juce::jmin(MAX_SUB_BLOCK, numSamples - start);
+        juce::AudioBuffer<float> subBlock(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, length);
+
+        subBlockMidi.clear();
+
+        for (auto it = midiMessages.findNextSamplePosition(start); it != midiMessages.cend(); ++it)
+        {
+            const auto metadata = *it;
+
+            if (metadata.samplePosition >= start + length)
+                break;
+
+            subBlockMidi.addEvent(metadata.data, metadata.numBytes, metadata.samplePosition - start);
+        }
+
+        processSubBlock(subBlock, subBlockMidi);
+    }
+}
+
+void SamplerProcessor::processSubBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
+{
+    // Idle fast path: no notes arriving, nothing sounding and every tail rung out
+    if (midiMessages.isEmpty() && governor.canSkipBlock())
+    {
+        buffer.clear();
+        governor.skipBlock();
+        return;
+    }
+
+    const auto startTicks = governor.beginBlock();
     buffer.clear();
 
+    // Control points for the block, shared by the anti-pop capture and the render
+    modulation.beginBlock(buffer.getNumSamples());
+
     // Check for monophonic mode and handle it specially
     if (monophonic && !midiMessages.isEmpty())
     {
-        // Capture current audio state before processing new notes (anti-pop mechanism)
-        captureAntiPopBuffer(buffer);
-
         // Process all MIDI events in this block
         juce::MidiBuffer::Iterator it(midiMessages);
         juce::MidiMessage message;
@@ -382,13 +296,31 @@ void SamplerProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::Midi
                 // Only process note-offs for the current note
                 handleMidiEvent(message);
             }
+            else if (!message.isNoteOnOrOff())
+            {
+                // All notes off and all sound off end the held note too, so a note-off still on its way
+                // for it isn't mistaken for one that ends a later note
+                if (message.isAllNotesOff() || message.isAllSoundOff())
+                    lastMonophonicNote = -1;
+
+                // Keep bends, pressure and controllers for the voice
+                performanceMessages.addEvent(message, samplePosition);
+            }
         }
 
         // Clear existing MIDI messages and only process the latest note-on if there is one
+        // Copied rather than swapped, so the preallocated buffer stays ours. The host's buffer already
+        // held these events and the note-on that replaces the rest, so refilling it doesn't allocate.
         midiMessages.clear();
+        midiMessages.addEvents(performanceMessages, 0, -1, 0);
+        performanceMessages.clear();
 
         if (latestNoteOn >= 0)
         {
+            // Render what the old note would have played over this block for the crossfade. This
+            // moves its voices on by a block, which is fine as they are cut straight after.
+            captureAntiPopBuffer(buffer);
+
             // Stop all playing notes first
             sampler->allNotesOff(1, false);
 
@@ -398,14 +330,16 @@ void SamplerProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::Midi
         }
     }
 
-    // Process incoming MIDI messages
+    // The synthesiser starts and stops notes at their sample positions while it renders.
+    // Passing them to handleMidiEvent as well would start every note twice, once at the
+    // start of the block, so only what the synthesiser doesn't track is handled here.
     for (const auto &metadata : midiMessages)
     {
-        handleMidiEvent(metadata.getMessage());
+        trackMasterBend(metadata.getMessage());
     }
 
     // Render the sampler audio
-    sampler->renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
+    renderVoices(buffer, midiMessages, buffer.getNumSamples());
 
     // Apply monophonic mode anti-pop processing if we have captured a buffer
     if (monophonic && antiPopCaptured)
@@ -419,8 +353,13 @@ void SamplerProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::Midi
         buffer.applyGain(gain);
     }
 
-    // Update voice positions for display purposes
-    updateVoicePositions();
+    reverb.process(buffer, buffer.getNumSamples());
+
+    // Update voice positions for display purposes, and see whether anything is still sounding
+    const int numSounding = updateVoicePositions();
+
+    governor.updateSilence(numSounding > 0 || !filterBank.isSilent(), buffer.getNumSamples(), reverb.getTailLengthSeconds());
+    governor.endBlock(startTicks, buffer.getNumSamples());
 }
 
 void SamplerProcessor::captureAntiPopBuffer(const juce::AudioBuffer<float> &buffer)
@@ -432,24 +371,16 @@ void SamplerProcessor::captureAntiPopBuffer(const juce::AudioBuffer<float> &buff
         return;
     }
 
-    // Make sure our anti-pop buffer is the right size
+    // Sized for a whole sub-block in prepareToPlay
     const int samplesToCapture = juce::jmin(buffer.getNumSamples(), antiPopBuffer.getNumSamples());
 
-    // Resize if needed (keeping data)
-    if (antiPopBuffer.getNumSamples() < samplesToCapture)
-    {
-        antiPopBuffer.setSize(buffer.getNumChannels(), samplesToCapture, true, true, true);
-    }
-
     // Capture a silent buffer to be filled by the sampler
     antiPopBuffer.clear();
 
     // Flag that we've captured
     antiPopCaptured = true;
 
-    // Remember the current voice states to restore later if needed
-    // This is a simplification - in a real implementation you'd store more state
-    sampler->renderNextBlock(antiPopBuffer, juce::MidiBuffer(), 0, samplesToCapture);
+    renderVoices(antiPopBuffer, juce::MidiBuffer(), samplesToCapture);
 }
 
 void SamplerProcessor::applyAntiPopProcessing(juce::AudioBuffer<float> &buffer)
@@ -462,28 +393,55 @@ void SamplerProcessor::applyAntiPopProcessing(juce::AudioBuffer<float> &buffer)
 
     // Apply a short crossfade between the old and new audio
     for (int channel = 0; channel < numChannels; ++channel)
-    {
-        float *bufferData = buffer.getWritePointer(channel);
-        const float *antiPopData = antiPopBuffer.getReadPointer(channel);
+        AntiPopFade::apply(buffer.getWritePointer(channel), antiPopBuffer.getReadPointer(channel), numSamples);
 
-        for (int i = 0; i < numSamples; ++i)
+    // Reset for next time
+    antiPopCaptured = false;
+}
+
+void SamplerProcessor::renderVoices(juce::AudioBuffer<float> &buffer, const juce::MidiBuffer &midiMessages, int numSamples)
+{
+    PROXY_TRACE_SCOPE("renderVoices");
+
+    const bool filtered = filterBank.isEnabled();
+
+    // With the filter on, each voice renders into its own buffer for the filter bank to mix
+    for (int i = 0; i < sampler->getNumVoices(); ++i)
+    {
+        if (auto *voice = dynamic_cast<ProxyVoice *>(sampler->getVoice(i)))
         {
-            // Short crossfade - 32 samples is about 0.7ms at 44.1kHz
-            const int fadeSamples = 32;
+            voice->setRenderTarget(filtered && i < MAX_VOICES ? &filterBank.getVoiceBuffer(i) : nullptr);
+            voice->setInterpolationEnabled(governor.shouldInterpolate());
+        }
+    }
 
-            if (i < fadeSamples)
-            {
-                float alpha = static_cast<float>(i) / fadeSamples;
-                bufferData[i] = bufferData[i] * alpha + antiPopData[i] * (1.0f - alpha);
-            }
+    if (filtered)
+        filterBank.beginBlock(numSamples);
+
+    sampler->renderNextBlock(buffer, midiMessages, 0, numSamples);
+
+    if (!filtered)
+        return;
+
+    std::array<VoiceFilterBank::VoiceState, MAX_VOICES> voiceStates;
+
+    for (int i = 0; i < sampler->getNumVoices() && i < MAX_VOICES; ++i)
+    {
+        if (auto *voice = dynamic_cast<ProxyVoice *>(sampler->getVoice(i)))
+        {
+            auto &state = voiceStates[static_cast<size_t>(i)];
+            state.playing = voice->getCurrentlyPlayingSound() != nullptr;
+            state.held = voice->isVoiceActive();
+            state.velocity = voice->getNoteVelocity();
+            state.noteId = voice->getNoteId();
+            state.cutoffOffset = modulation.getCutoffOffset(voice->getNoteModulation());
         }
     }
 
-    // Reset for next time
-    antiPopCaptured = false;
+    filterBank.process(voiceStates, buffer, 0, numSamples);
 }
 
-void SamplerProcessor::updateVoicePositions()
+int SamplerProcessor::updateVoicePositions()
 {
     // Reset all voice positions
     for (auto &voicePos : voicePositions)
@@ -493,15 +451,38 @@ void SamplerProcessor::updateVoicePositions()
 
     // Update positions for active voices
     int activeVoiceCount = 0;
+    int soundingVoiceCount = 0;
+    const bool cull = governor.shouldCullInaudible();
 
-    for (int i = 0; i < sampler->getNumVoices() && activeVoiceCount < MAX_VOICES; ++i)
+    for (int i = 0; i < sampler->getNumVoices(); ++i)
     {
-        if (auto *voice = dynamic_cast<ProxySamplerVoice *>(sampler->getVoice(i)))
+        if (auto *voice = dynamic_cast<ProxyVoice *>(sampler->getVoice(i)))
         {
+            const float level = voice->takeBlockPeak();
+
+            if (voice->getCurrentlyPlayingSound() == nullptr)
+                continue;
+
+            // Under load, a release that can no longer be heard is not worth finishing
+            if (cull && !voice->isVoiceActive() && level * gain < RenderGovernor::CULL_LEVEL)
+            {
+                voice->stopNote(0.0f, false);
+                governor.countCulledVoice();
+
+                // Gone from the next block, so not counted in the load the governor sees
+                continue;
+            }
+
+            soundingVoiceCount++;
+
+            if (activeVoiceCount >= MAX_VOICES)
+                continue;
+
             if (voice->isVoiceActive())
             {
-                voicePositions[activeVoiceCount].position = static_cast<int>(voice->getCurrentSamplePosition());
+                voicePositions[activeVoiceCount].position = static_cast<juce::int64>(voice->getCurrentSamplePosition());
                 voicePositions[activeVoiceCount].isActive = true;
+                voicePositions[activeVoiceCount].level = level * gain;
                 activeVoiceCount++;
             }
         }
@@ -510,8 +491,10 @@ void SamplerProcessor::updateVoicePositions()
     // Store the position of the first voice (for backward compatibility)
     if (activeVoiceCount > 0)
     {
-        currentSamplePosition = voicePositions[0].position;
+        currentSamplePosition = static_cast<int>(juce::jmin<juce::int64>(voicePositions[0].position, std::numeric_limits<int>::max()));
     }
+
+    return soundingVoiceCount;
 }
 
 bool SamplerProcessor::isAnyVoiceActive() const
@@ -521,7 +504,7 @@ bool SamplerProcessor::isAnyVoiceActive() const
 
     for (int i = 0; i < sampler->getNumVoices(); ++i)
     {
-        if (auto *voice = dynamic_cast<ProxySamplerVoice *>(sampler->getVoice(i)))
+        if (auto *voice = dynamic_cast<ProxyVoice *>(sampler->getVoice(i)))
         {
             if (voice->isVoiceActive())
                 return true;
@@ -535,6 +518,8 @@ void SamplerProcessor::reset()
 {
     sampler->allNotesOff(0, false);
     antiPopCaptured = false;
+    governor.reset();
+    modulation.reset();
 }
 
 void SamplerProcessor::releaseResources()
@@ -542,8 +527,21 @@ void SamplerProcessor::releaseResources()
     reset();
 }
 
+double SamplerProcessor::getTailLengthSeconds() const
+{
+    // Voices finish their release, grains already started play out, then the reverb rings
+    double seconds = releaseTimeMs / 1000.0;
+
+    if (playbackMode == PlaybackMode::granular)
+        seconds += granularParameters.grainSizeMs / 1000.0;
+
+    return seconds + reverb.getTailLengthSeconds();
+}
+
 void SamplerProcessor::handleMidiEvent(const juce::MidiMessage &midiMessage)
 {
+    trackMasterBend(midiMessage);
+
     // Pass the MIDI message directly to the sampler
     if (sampler != nullptr)
     {
@@ -588,6 +586,14 @@ void SamplerProcessor::handleMidiEvent(const juce::MidiMessage &midiMessage)
     }
 }
 
+void SamplerProcessor::trackMasterBend(const juce::MidiMessage &midiMessage)
+{
+    // In MPE mode channel 1 is the master channel and bends every note; the synthesiser
+    // only passes bends to notes on the same channel, so it is tracked here
+    if (midiMessage.isPitchWheel() && modulationParameters.mpeEnabled && midiMessage.getChannel() == 1)
+        modulation.setMasterBend((midiMessage.getPitchWheelValue() - 8192) / 8192.0f);
+}
+
 void SamplerProcessor::setAttack(float newAttackTimeMs)
 {
     attackTimeMs = newAttackTimeMs;
@@ -618,6 +624,183 @@ void SamplerProcessor::setMonophonic(bool isMonophonic)
     }
 }
 
+bool SamplerProcessor::setSustainLoop(const SampleLoop &loop)
+{
+    if (!sampleLibrary.setSampleLoops(currentSampleName, loop, currentReleaseLoop))
+        return false;
+
+    // Rebuild the sound so its loop seams are rendered again
+    return setSample(currentSampleName);
+}
+
+bool SamplerProcessor::setReleaseLoop(const SampleLoop &loop)
+{
+    if (!sampleLibrary.setSampleLoops(currentSampleName, currentSustainLoop, loop))
+        return false;
+
+    return setSample(currentSampleName);
+}
+
+void SamplerProcessor::setLoopCrossfade(float crossfadeMs)
+{
+    crossfadeMs = juce::jlimit(0.0f, MAX_LOOP_CROSSFADE_MS, crossfadeMs);
+
+    if (crossfadeMs != loopCrossfadeMs)
+    {
+        loopCrossfadeMs = crossfadeMs;
+
+        if (currentSampleName.isNotEmpty())
+            setSample(currentSampleName);
+    }
+}
+
+void SamplerProcessor::setPlaybackMode(PlaybackMode newMode)
+{
+    if (playbackMode != newMode)
+    {
+        playbackMode = newMode;
+
+        // Swap the whole voice set; clearVoices() waits for the audio thread
+        sampler->allNotesOff(0, false);
+        createVoices();
+
+        // Granular voices only play sounds held as floats
+        if (currentSampleName.isNotEmpty())
+            setSample(currentSampleName);
+
+        updateVoiceParameters();
+    }
+}
+
+void SamplerProcessor::setCompressedStorage(bool shouldCompress)
+{
+    if (sampleLibrary.isCompressedStorage() != shouldCompress)
+    {
+        // The playing sound shares the old storage until its sample is converted, then it is rebuilt
+        sampleLibrary.setCompressedStorage(shouldCompress, [this](const juce::String &name)
+                                           {
+                                               if (name == currentSampleName && !restorePending)
+                                                   setSample(name);
+                                           });
+    }
+}
+
+void SamplerProcessor::setNoteCacheBudget(int megabytes)
+{
+    megabytes = juce::jlimit(0, MAX_NOTE_CACHE_MB, megabytes);
+
+    if (megabytes != noteCacheMb)
+    {
+        noteCacheMb = megabytes;
+
+        // A new sound starts a new cache with the new budget
+        if (currentSampleName.isNotEmpty())
+            setSample(currentSampleName);
+    }
+}
+
+void SamplerProcessor::setAnalysisApplied(bool shouldApply)
+{
+    if (shouldApply != analysisApplied)
+    {
+        analysisApplied = shouldApply;
+
+        // The sound takes its root, gain and play range when it is made
+        if (currentSampleName.isNotEmpty())
+            setSample(currentSampleName);
+    }
+}
+
+void SamplerProcessor::setGranularParameters(const GranularParameters &newParameters)
+{
+    granularParameters = newParameters;
+    granularParameters.position = juce::jlimit(0.0f, 1.0f, granularParameters.position);
+    granularParameters.speed = juce::jlimit(-4.0f, 4.0f, granularParameters.speed);
+    granularParameters.spray = juce::jlimit(0.0f, 1.0f, granularParameters.spray);
+    granularParameters.density = juce::jlimit(1.0f, ProxyGranularVoice::MAX_DENSITY, granularParameters.density);
+    granularParameters.grainSizeMs = juce::jlimit(ProxyGranularVoice::MIN_GRAIN_MS, ProxyGranularVoice::MAX_GRAIN_MS,
+                                                  granularParameters.grainSizeMs);
+    granularParameters.pitchSemitones = juce::jlimit(-24.0f, 24.0f, granularParameters.pitchSemitones);
+    updateVoiceParameters();
+}
+
+void SamplerProcessor::setFilterParameters(const FilterParameters &newParameters)
+{
+    filterParameters = newParameters;
+    filterParameters.cutoffHz = juce::jlimit(20.0f, 20000.0f, filterParameters.cutoffHz);
+    filterParameters.resonance = juce::jlimit(0.1f, 20.0f, filterParameters.resonance);
+    filterParameters.envelopeAmount = juce::jlimit(-8.0f, 8.0f, filterParameters.envelopeAmount);
+    filterParameters.velocityAmount = juce::jlimit(-8.0f, 8.0f, filterParameters.velocityAmount);
+    filterParameters.attackMs = juce::jlimit(0.0f, 10000.0f, filterParameters.attackMs);
+    filterParameters.decayMs = juce::jlimit(0.0f, 10000.0f, filterParameters.decayMs);
+    filterParameters.sustain = juce::jlimit(0.0f, 1.0f, filterParameters.sustain);
+    filterParameters.releaseMs = juce::jlimit(0.0f, 10000.0f, filterParameters.releaseMs);
+    filterBank.setParameters(filterParameters);
+}
+
+void SamplerProcessor::setModulationParameters(const ModulationParameters &newParameters)
+{
+    modulationParameters = newParameters;
+    modulationParameters.pitchBendRange = juce::jlimit(0.0f, 48.0f, modulationParameters.pitchBendRange);
+    modulationParameters.mpeBendRange = juce::jlimit(0.0f, 96.0f, modulationParameters.mpeBendRange);
+    modulationParameters.glideMs = juce::jlimit(0.0f, 5000.0f, modulationParameters.glideMs);
+    modulationParameters.pressureToVolume = juce::jlimit(0.0f, 1.0f, modulationParameters.pressureToVolume);
+    modulationParameters.timbreToCutoff = juce::jlimit(-8.0f, 8.0f, modulationParameters.timbreToCutoff);
+
+    for (auto &lfo : modulationParameters.lfos)
+    {
+        lfo.rateHz = juce::jlimit(0.01f, 50.0f, lfo.rateHz);
+        lfo.depth = juce::jlimit(-24.0f, 24.0f, lfo.depth);
+    }
+
+    modulation.setParameters(modulationParameters);
+}
+
+bool SamplerProcessor::setReverbImpulse(const juce::String &name)
+{
+    if (name.isEmpty())
+    {
+        pendingReverbImpulse = {};
+        reverb.clearImpulseResponse();
+        return true;
+    }
+
+    auto impulseData = sampleLibrary.getSampleAudioBuffer(name);
+
+    // Remembered in case the library scan is still to find it
+    pendingReverbImpulse = impulseData.getNumFrames() == 0 ? name : juce::String();
+
+    if (impulseData.getNumFrames() == 0)
+        return false;
+
+    // The convolver wants contiguous audio, and only uses the first MAX_IMPULSE_SECONDS of it
+    const auto maxFrames = static_cast<juce::int64>(ConvolutionReverb::MAX_IMPULSE_SECONDS * impulseData.sampleRate);
+    const auto numFrames = static_cast<int>(juce::jmin(impulseData.getNumFrames(), maxFrames));
+    const auto impulse = impulseData.buffer != nullptr ? impulseData.buffer->toAudioBuffer(0, numFrames)
+                                                       : impulseData.compressed->toAudioBuffer(0, numFrames);
+
+    reverb.setImpulseResponse(impulse, impulseData.sampleRate, name);
+    return true;
+}
+
+void SamplerProcessor::createVoices()
+{
+    sampler->clearVoices();
+
+    for (int i = 0; i < MAX_VOICES; ++i)
+    {
+        ProxyVoice *voice = nullptr;
+
+        if (playbackMode == PlaybackMode::granular)
+            voice = new ProxyGranularVoice();
+        else
+            voice = new ProxySamplerVoice();
+
+        voice->setModulationEngine(&modulation);
+        sampler->addVoice(voice);
+    }
+}
+
 void SamplerProcessor::updateActiveVoices()
 {
     // Only needed for the old implementation
@@ -630,37 +813,34 @@ void SamplerProcessor::updateVoiceParameters()
     {
         for (int i = 0; i < sampler->getNumVoices(); ++i)
         {
-            if (auto *voice = dynamic_cast<ProxySamplerVoice *>(sampler->getVoice(i)))
+            if (auto *voice = dynamic_cast<ProxyVoice *>(sampler->getVoice(i)))
             {
                 voice->setAttackRate(sampleRate, attackTimeMs);
                 voice->setReleaseRate(sampleRate, releaseTimeMs);
             }
+
+            if (auto *voice = dynamic_cast<ProxyGranularVoice *>(sampler->getVoice(i)))
+            {
+                voice->setParameters(granularParameters);
+            }
         }
     }
 }
 
 void SamplerProcessor::refreshSamples()
 {
-    // Get the current sample name (to restore selection if possible)
-    juce::String currentSample = getCurrentSampleName();
-
-    // Scan for samples
-    juce::StringArray samples = sampleLibrary.scanUserSamplesFolder();
-
-    // If no samples found, just return
-    if (samples.isEmpty())
-    {
-        return;
-    }
-
-    // Try to restore the previous sample selection
-    if (samples.contains(currentSample))
-    {
-        setSample(currentSample);
-    }
-    else
-    {
-        // If previous sample not found, use the first one
-        setSample(samples[0]);
-    }
+    // Scan on the library's loading thread, then restore the selection once the new list is in
+    sampleLibrary.scanUserSamplesFolderInBackground([this]
+                                                    {
+                                                        juce::StringArray samples = sampleLibrary.getAvailableSamples();
+
+                                                        // If no samples found, just return
+                                                        if (samples.isEmpty())
+                                                            return;
+
+                                                        // Keep the current sample if it is still there, otherwise use the first one
+                                                        const juce::String currentSample = getCurrentSampleName();
+                                                        setSample(samples.contains(currentSample) ? currentSample : samples[0]);
+                                                    },
+                                                    true);
 }
\ No newline at end of file
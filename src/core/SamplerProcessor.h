@@ -1,21 +1,43 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <optional>
 #include "SampleLibrary.h"
+#include "SampleRecorder.h"
+#include "GranularVoice.h"
+#include "VoiceFilterBank.h"
+#include "ConvolutionReverb.h"
+#include "RenderGovernor.h"
+#include "ModulationEngine.h"
+#include "PitchedNoteCache.h"
 
 // Structure to store voice playback positions
 struct VoicePosition
 {
-    int position;
+    juce::int64 position;
     bool isActive;
+    float level; // output peak of the voice over the last block
 
-    VoicePosition() : position(0), isActive(false) {}
+    VoicePosition() : position(0), isActive(false), level(0.0f) {}
+};
+
+// How notes are played from the current sample
+enum class PlaybackMode
+{
+    sample,  // the whole sample, pitched by the note
+    granular // a stream of short grains around a movable read head
 };
 
 class SamplerProcessor
 {
 public:
     static constexpr int MAX_VOICES = 8;
+    static constexpr float MAX_LOOP_CROSSFADE_MS = 500.0f;
+    static constexpr int MAX_NOTE_CACHE_MB = 4096;
+
+    // Longer host blocks are rendered in pieces of this size, so the voice, filter and reverb
+    // scratch stays in cache and is sized once in prepareToPlay, whatever the host sends
+    static constexpr int MAX_SUB_BLOCK = 512;
 
     SamplerProcessor();
     ~SamplerProcessor();
@@ -26,23 +48,52 @@ public:
     bool setSample(const juce::String &name);
     juce::StringArray getAvailableSamples() const;
     juce::String getCurrentSampleName() const;
+    juce::int64 getCurrentSampleLength() const { return currentSampleLength.load(); }
 
-    // Refresh samples from folder
+    // Select a saved sample without waiting for it: it is found by content hash, then file path, then
+    // name. If it isn't loaded yet, notes stay silent while it decodes in the background, and the
+    // loops are applied once it is ready; without them the sample keeps its own. Message thread.
+    void restoreSample(const SampleReference &reference, std::optional<SampleLoop> sustainLoop, std::optional<SampleLoop> releaseLoop);
+
+    // The current sample as it should be saved, including one that is still being restored
+    SampleReference getCurrentSampleReference() const;
+    bool isRestoringSample() const { return restorePending; }
+
+    // Time from the last restoreSample() call until its sample was playable
+    double getRestoreLatencyMs() const { return restoreLatencyMs; }
+
+    // Rescan the samples folder in the background, keeping the current sample if it is still there
     void refreshSamples();
 
+    // Resampling: record the output or the sidechain input into a new sample in the samples folder's
+    // Recordings category. It is selected as soon as it is written. Message thread.
+    bool startRecording(SampleRecorder::Source source);
+    void stopRecording() { recorder.stop(); }
+    bool isRecording() const { return recorder.isRecording(); }
+
+    // The audio thread hands it the sidechain and the output
+    SampleRecorder &getRecorder() { return recorder; }
+    const SampleRecorder &getRecorder() const { return recorder; }
+
     // AudioProcessor methods
     void prepareToPlay(double sampleRate, int samplesPerBlock);
     void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages);
     void reset();
     void releaseResources();
 
+    // Release, grain and reverb tails that continue after the last note ends
+    double getTailLengthSeconds() const;
+
+    // Idle fast path, quality steps and voice culling, with their counters
+    const RenderGovernor &getGovernor() const { return governor; }
+
     // MIDI and voice handling
     void handleMidiEvent(const juce::MidiMessage &midiMessage);
     void setCurrentPlaybackSamplePosition(int pos) { currentSamplePosition = pos; }
     int getCurrentPlaybackSamplePosition() const { return currentSamplePosition; }
     bool isAnyVoiceActive() const;
 
-    // Get all voice positions
+    // Get all voice positions (audio thread only, the UI reads them through the telemetry channel)
     const std::array<VoicePosition, MAX_VOICES> &getAllVoicePositions() const { return voicePositions; }
 
     // Parameters
@@ -52,6 +103,52 @@ public:
     void setMonophonic(bool isMonophonic);
     void updateActiveVoices();
 
+    // Loop points of the current sample, in frames. Changing them re-renders the loop seams.
+    bool setSustainLoop(const SampleLoop &loop);
+    bool setReleaseLoop(const SampleLoop &loop);
+    void setLoopCrossfade(float crossfadeMs);
+
+    const SampleLoop &getSustainLoop() const { return currentSustainLoop; }
+    const SampleLoop &getReleaseLoop() const { return currentReleaseLoop; }
+    float getLoopCrossfade() const { return loopCrossfadeMs; }
+
+    // Playback mode and granular controls
+    void setPlaybackMode(PlaybackMode newMode);
+    void setGranularParameters(const GranularParameters &newParameters);
+
+    PlaybackMode getPlaybackMode() const { return playbackMode; }
+    const GranularParameters &getGranularParameters() const { return granularParameters; }
+
+    // Keep integer PCM samples losslessly compressed in memory; voices decode blocks as they play
+    void setCompressedStorage(bool shouldCompress);
+    bool isCompressedStorage() const { return sampleLibrary.isCompressedStorage(); }
+
+    // Memory for notes of the current sample pre-rendered at their pitch, 0 to turn the cache off.
+    // Sample playback only; notes are rendered in the background the first time they are played.
+    void setNoteCacheBudget(int megabytes);
+    int getNoteCacheBudget() const { return noteCacheMb; }
+
+    // Tune notes to the sample's analysed root, normalise its loudness and skip silence at either end
+    void setAnalysisApplied(bool shouldApply);
+    bool isAnalysisApplied() const { return analysisApplied; }
+
+    // Per-voice filter
+    void setFilterParameters(const FilterParameters &newParameters);
+    const FilterParameters &getFilterParameters() const { return filterParameters; }
+
+    // Pitch bend, MPE, glide and LFOs
+    void setModulationParameters(const ModulationParameters &newParameters);
+    const ModulationParameters &getModulationParameters() const { return modulationParameters; }
+
+    // Convolution reverb after the voices; impulse responses come from the sample library.
+    // An empty name removes the reverb.
+    bool setReverbImpulse(const juce::String &name);
+    void setReverbMix(float newMix) { reverb.setMix(newMix); }
+
+    juce::String getReverbImpulse() const { return reverb.getImpulseName(); }
+    float getReverbMix() const { return reverb.getMix(); }
+    double getReverbTailSeconds() const { return reverb.getTailLengthSeconds(); }
+
     float getAttack() const { return attackTimeMs; }
     float getRelease() const { return releaseTimeMs; }
     float getGain() const { return gain; }
@@ -64,10 +161,25 @@ private:
     // Sample managers
     SampleLibrary sampleLibrary;
     std::unique_ptr<juce::Synthesiser> sampler;
+    SampleRecorder recorder;
+    NoteCacheBuilder noteCacheBuilder;
 
     // Current state
     juce::String currentSampleName;
+    std::atomic<juce::int64> currentSampleLength{0};
     int currentSamplePosition;
+    SampleLoop currentSustainLoop;
+    SampleLoop currentReleaseLoop;
+
+    // Sample being restored in the background; restoreGeneration tells a stale load from the latest one
+    SampleReference pendingReference;
+    bool restorePending = false;
+    int restoreGeneration = 0;
+    double restoreStartMs = 0.0;
+    double restoreLatencyMs = 0.0;
+
+    // A reverb impulse named by a restored state before the library scan found it
+    juce::String pendingReverbImpulse;
 
     // Track positions for all voices
     std::array<VoicePosition, MAX_VOICES> voicePositions;
@@ -77,21 +189,52 @@ private:
     float releaseTimeMs;
     float gain;
     bool monophonic;
+    float loopCrossfadeMs = 10.0f;
+    int noteCacheMb = 0;
+    bool analysisApplied = true;
+    PlaybackMode playbackMode = PlaybackMode::sample;
+    GranularParameters granularParameters;
+    FilterParameters filterParameters;
+    ModulationParameters modulationParameters;
+
+    // Per-voice filters, applied after the voices render
+    VoiceFilterBank filterBank;
+
+    // Control-rate modulation shared by the voices
+    ModulationEngine modulation;
+
+    // Reverb insert, applied after the gain
+    ConvolutionReverb reverb;
+
+    // CPU budget: idle skipping and quality under load
+    RenderGovernor governor;
 
     // Monophonic mode tracking
     int lastMonophonicNote;
+    juce::MidiBuffer performanceMessages; // non-note events kept through the monophonic filter
 
     // Anti-pop buffer for monophonic mode
     juce::AudioBuffer<float> antiPopBuffer;
     bool antiPopCaptured = false;
 
+    // MIDI of the sub-block being rendered, when a host block is split
+    juce::MidiBuffer subBlockMidi;
+
+    // One piece of a host block, at most MAX_SUB_BLOCK long
+    void processSubBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages);
+
+    // MPE master channel bend, which the synthesiser doesn't pass to notes on other channels
+    void trackMasterBend(const juce::MidiMessage &midiMessage);
+
     // Anti-pop methods
     void captureAntiPopBuffer(const juce::AudioBuffer<float> &buffer);
     void applyAntiPopProcessing(juce::AudioBuffer<float> &buffer);
 
     // Voice management
+    void createVoices();
+    void renderVoices(juce::AudioBuffer<float> &buffer, const juce::MidiBuffer &midiMessages, int numSamples);
     void updateVoiceParameters();
-    void updateVoicePositions();
+    int updateVoicePositions();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplerProcessor)
 };
\ No newline at end of file
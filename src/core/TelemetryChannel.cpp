@@ -0,0 +1,72 @@
+#include "TelemetryChannel.h"
+
+bool TelemetryFrame::isIdle() const
+{
+    // Anything below -80dB is treated as silence
+    const float silenceThreshold = 0.0001f;
+
+    return numActiveVoices == 0 &&
+           juce::jmax(meters.peakHold[0], meters.peakHold[1], meters.rms[0], meters.rms[1]) < silenceThreshold;
+}
+
+TelemetryChannel::TelemetryChannel()
+    : fifo(CAPACITY)
+{
+}
+
+bool TelemetryChannel::push(const TelemetryFrame &frame)
+{
+    const auto scope = fifo.write(1);
+
+    if (scope.blockSize1 > 0)
+        frames[static_cast<size_t>(scope.startIndex1)] = frame;
+    else if (scope.blockSize2 > 0)
+        frames[static_cast<size_t>(scope.startIndex2)] = frame;
+    else
+        return false;
+
+    return true;
+}
+
+bool TelemetryChannel::drain(TelemetryFrame &result)
+{
+    const int numReady = fifo.getNumReady();
+
+    if (numReady == 0)
+        return false;
+
+    const auto scope = fifo.read(numReady);
+    MeterSnapshot peaks;
+    std::array<float, SamplerProcessor::MAX_VOICES> voicePeaks{};
+
+    auto collapse = [&](int start, int count)
+    {
+        for (int i = start; i < start + count; ++i)
+        {
+            const auto &frame = frames[static_cast<size_t>(i)];
+
+            for (size_t channel = 0; channel < 2; ++channel)
+            {
+                peaks.peak[channel] = juce::jmax(peaks.peak[channel], frame.meters.peak[channel]);
+                peaks.peakHold[channel] = juce::jmax(peaks.peakHold[channel], frame.meters.peakHold[channel]);
+                peaks.truePeak[channel] = juce::jmax(peaks.truePeak[channel], frame.meters.truePeak[channel]);
+                peaks.rms[channel] = juce::jmax(peaks.rms[channel], frame.meters.rms[channel]);
+            }
+
+            for (size_t voice = 0; voice < voicePeaks.size(); ++voice)
+                voicePeaks[voice] = juce::jmax(voicePeaks[voice], frame.voiceLevels[voice]);
+
+            result = frame;
+        }
+    };
+
+    collapse(scope.startIndex1, scope.blockSize1);
+    collapse(scope.startIndex2, scope.blockSize2);
+
+    result.meters.peak = peaks.peak;
+    result.meters.peakHold = peaks.peakHold;
+    result.meters.truePeak = peaks.truePeak;
+    result.meters.rms = peaks.rms;
+    result.voiceLevels = voicePeaks;
+    return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SamplerProcessor.h"
+#include "MeterEngine.h"
+
+// One snapshot of audio-thread state for the UI, written once per processed block
+struct TelemetryFrame
+{
+    MeterSnapshot meters;
+    juce::int64 sampleLength = 0;
+    int numActiveVoices = 0;
+
+    // Playback position of each voice slot, or -1 when the slot is inactive
+    std::array<juce::int64, SamplerProcessor::MAX_VOICES> voicePositions;
+
+    // Output peak of each voice slot
+    std::array<float, SamplerProcessor::MAX_VOICES> voiceLevels;
+
+    TelemetryFrame()
+    {
+        voicePositions.fill(-1);
+        voiceLevels.fill(0.0f);
+    }
+
+    // True when there is nothing playing and nothing left on the meters
+    bool isIdle() const;
+};
+
+// Single-producer/single-consumer ring carrying telemetry from the audio thread to the UI.
+// The audio thread never blocks or allocates; if the UI falls behind, new frames are dropped.
+class TelemetryChannel
+{
+public:
+    static constexpr int CAPACITY = 32;
+
+    TelemetryChannel();
+
+    // Audio thread: publish one frame; false if the ring was full and it was dropped
+    bool push(const TelemetryFrame &frame);
+
+    // UI thread: consume every pending frame and collapse them into one.
+    // Positions and loudness come from the newest frame, peaks and levels are the maximum seen.
+    // Returns false if nothing was pending.
+    bool drain(TelemetryFrame &result);
+
+private:
+    juce::AbstractFifo fifo;
+    std::array<TelemetryFrame, CAPACITY> frames;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TelemetryChannel)
+};
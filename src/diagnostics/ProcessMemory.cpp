@@ -0,0 +1,50 @@
+// The platform headers come first so JUCE's own definitions don't clash with them
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#include <fstream>
+#endif
+
+#include "ProcessMemory.h"
+
+size_t ProcessMemory::getResidentBytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<size_t>(counters.WorkingSetSize);
+#elif defined(__APPLE__)
+    mach_task_basic_info info{};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS)
+        return static_cast<size_t>(info.resident_size);
+#elif defined(__linux__)
+    // Second field of statm: resident pages
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0, residentPages = 0;
+
+    if (statm >> totalPages >> residentPages)
+        return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+
+    return 0;
+}
+
+juce::String ProcessMemory::describeGrowth(size_t before, size_t after)
+{
+    if (before == 0 || after == 0)
+        return "unknown";
+
+    const double megabytes = (static_cast<double>(after) - static_cast<double>(before)) / (1024.0 * 1024.0);
+    return (megabytes >= 0.0 ? "+" : "") + juce::String(megabytes, 1) + " MB";
+}
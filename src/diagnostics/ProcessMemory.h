@@ -0,0 +1,14 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Memory the operating system has given this process, for before/after comparisons such as
+// opening an editor. Helper processes (a WebView's browser and renderer) are not included.
+namespace ProcessMemory
+{
+    // Resident set size (working set on Windows) in bytes, or 0 where it can't be read
+    size_t getResidentBytes();
+
+    // "+12.3 MB" style difference between two readings
+    juce::String describeGrowth(size_t before, size_t after);
+}
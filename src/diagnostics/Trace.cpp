@@ -0,0 +1,163 @@
+#include "Trace.h"
+
+#if PROXY_TRACING
+
+namespace
+{
+struct Event
+{
+    const char *name;
+    juce::int64 start;
+    juce::int64 end;
+};
+
+// One writer (its thread), any number of readers that tolerate being overtaken
+struct ThreadBuffer
+{
+    std::vector<Event> events = std::vector<Event>(static_cast<size_t>(Trace::EVENTS_PER_THREAD));
+    std::atomic<juce::uint64> numWritten{0};
+    std::atomic<const char *> name{nullptr};
+    juce::String fallbackName;
+    int id = 0;
+};
+
+// Buffers live until the process exits, so a trace can still be exported after its thread ends
+struct Registry
+{
+    juce::CriticalSection lock;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+Registry &getRegistry()
+{
+    static Registry registry;
+    return registry;
+}
+
+ThreadBuffer &getThreadBuffer()
+{
+    thread_local ThreadBuffer *buffer = nullptr;
+
+    // The only lock and allocation: a thread's first event
+    if (buffer == nullptr)
+    {
+        auto newBuffer = std::make_unique<ThreadBuffer>();
+
+        if (auto *thread = juce::Thread::getCurrentThread())
+            newBuffer->fallbackName = thread->getThreadName();
+        else if (juce::MessageManager::existsAndIsCurrentThread())
+            newBuffer->fallbackName = "Message thread";
+
+        auto &registry = getRegistry();
+        const juce::ScopedLock sl(registry.lock);
+
+        newBuffer->id = static_cast<int>(registry.buffers.size()) + 1;
+
+        if (newBuffer->fallbackName.isEmpty())
+            newBuffer->fallbackName = "Thread " + juce::String(newBuffer->id);
+
+        buffer = newBuffer.get();
+        registry.buffers.push_back(std::move(newBuffer));
+    }
+
+    return *buffer;
+}
+
+juce::String escape(const juce::String &text)
+{
+    return text.replace("\\", "\\\\").replace("\"", "\\\"");
+}
+} // namespace
+
+void Trace::record(const char *name, juce::int64 start, juce::int64 end) noexcept
+{
+    auto &buffer = getThreadBuffer();
+    const auto index = buffer.numWritten.load(std::memory_order_relaxed);
+
+    buffer.events[static_cast<size_t>(index % EVENTS_PER_THREAD)] = {name, start, end};
+    buffer.numWritten.store(index + 1, std::memory_order_release);
+}
+
+void Trace::setThreadName(const char *name) noexcept
+{
+    getThreadBuffer().name.store(name, std::memory_order_relaxed);
+}
+
+juce::String Trace::toChromeJson()
+{
+    struct ThreadEvents
+    {
+        int id;
+        juce::String name;
+        std::vector<Event> events;
+    };
+
+    std::vector<ThreadEvents> threads;
+
+    {
+        auto &registry = getRegistry();
+        const juce::ScopedLock sl(registry.lock);
+
+        for (const auto &buffer : registry.buffers)
+        {
+            ThreadEvents thread;
+            thread.id = buffer->id;
+
+            const char *name = buffer->name.load(std::memory_order_relaxed);
+            thread.name = name != nullptr ? juce::String(name) : buffer->fallbackName;
+
+            // Copy what the ring holds, then drop anything the writer may have overwritten meanwhile
+            const auto end = buffer->numWritten.load(std::memory_order_acquire);
+            const auto begin = end > static_cast<juce::uint64>(EVENTS_PER_THREAD) ? end - EVENTS_PER_THREAD : 0;
+
+            for (auto i = begin; i < end; ++i)
+                thread.events.push_back(buffer->events[static_cast<size_t>(i % EVENTS_PER_THREAD)]);
+
+            const auto endAfter = buffer->numWritten.load(std::memory_order_acquire);
+            const auto overwritten = endAfter > static_cast<juce::uint64>(EVENTS_PER_THREAD) ? endAfter - EVENTS_PER_THREAD : 0;
+
+            if (overwritten > begin)
+                thread.events.erase(thread.events.begin(), thread.events.begin() + static_cast<std::ptrdiff_t>(juce::jmin(overwritten - begin, end - begin)));
+
+            threads.push_back(std::move(thread));
+        }
+    }
+
+    // Timestamps relative to the earliest event, in microseconds
+    juce::int64 origin = std::numeric_limits<juce::int64>::max();
+
+    for (const auto &thread : threads)
+        for (const auto &event : thread.events)
+            origin = juce::jmin(origin, event.start);
+
+    auto toMicroseconds = [](juce::int64 ticks)
+    { return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6; };
+
+    juce::MemoryOutputStream json;
+    json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+
+    for (const auto &thread : threads)
+    {
+        json << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.id
+             << ",\"args\":{\"name\":\"" << escape(thread.name) << "\"}}";
+        first = false;
+
+        for (const auto &event : thread.events)
+        {
+            json << ",\n{\"name\":\"" << escape(event.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.id
+                 << ",\"ts\":" << juce::String(toMicroseconds(event.start - origin), 3)
+                 << ",\"dur\":" << juce::String(toMicroseconds(event.end - event.start), 3) << "}";
+        }
+    }
+
+    json << "\n]}\n";
+    return json.toString();
+}
+
+bool Trace::writeChromeJson(const juce::File &file)
+{
+    return file.replaceWithText(toChromeJson());
+}
+
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Scoped trace events for correlating audio, loader and UI activity.
+// Build with PROXY_TRACING=1 (the PROXY_ENABLE_TRACING CMake option) to record; otherwise
+// every PROXY_TRACE_* macro expands to nothing and none of this is compiled in.
+//
+//   void SamplerProcessor::processBlock(...)
+//   {
+//       PROXY_TRACE_SCOPE("processBlock");
+//       ...
+//
+// Each thread records into its own fixed ring, so recording never locks or allocates after a
+// thread's first event. Old events are overwritten once a ring is full. Names must be string
+// literals (only the pointer is stored).
+
+#ifndef PROXY_TRACING
+#define PROXY_TRACING 0
+#endif
+
+#if PROXY_TRACING
+
+class Trace
+{
+public:
+    // Ring size per thread; about 10 seconds of per-voice events at small block sizes
+    static constexpr int EVENTS_PER_THREAD = 1 << 16;
+
+    // Records the time from construction to destruction as one complete event
+    class Scope
+    {
+    public:
+        explicit Scope(const char *eventName) noexcept
+            : name(eventName), start(juce::Time::getHighResolutionTicks()) {}
+
+        ~Scope() noexcept { record(name, start, juce::Time::getHighResolutionTicks()); }
+
+    private:
+        const char *name;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+
+    // Name the calling thread in the exported trace (threads JUCE didn't create have no name)
+    static void setThreadName(const char *name) noexcept;
+
+    // Everything still held in the per-thread rings, as Chrome trace event JSON
+    // (chrome://tracing, ui.perfetto.dev)
+    static juce::String toChromeJson();
+    static bool writeChromeJson(const juce::File &file);
+
+private:
+    static void record(const char *name, juce::int64 start, juce::int64 end) noexcept;
+};
+
+#define PROXY_TRACE_SCOPE(name) const Trace::Scope JUCE_JOIN_MACRO(proxyTraceScope, __LINE__)(name)
+#define PROXY_TRACE_THREAD(name) Trace::setThreadName(name)
+
+#else
+
+#define PROXY_TRACE_SCOPE(name)
+#define PROXY_TRACE_THREAD(name)
+
+#endif
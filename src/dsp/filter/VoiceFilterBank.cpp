@@ -0,0 +1,256 @@
+#include "VoiceFilterBank.h"
+
+VoiceFilterBank::VoiceFilterBank()
+{
+    for (auto &buffer : voiceBuffers)
+        buffer.setSize(NUM_CHANNELS, 512);
+}
+
+void VoiceFilterBank::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+
+    for (auto &buffer : voiceBuffers)
+        buffer.setSize(NUM_CHANNELS, juce::jmax(1, maximumBlockSize), false, true, true);
+
+    reset();
+}
+
+void VoiceFilterBank::reset()
+{
+    for (auto &channel : ic1)
+        std::fill(std::begin(channel), std::end(channel), 0.0f);
+    for (auto &channel : ic2)
+        std::fill(std::begin(channel), std::end(channel), 0.0f);
+
+    for (auto &envelope : envelopes)
+        envelope = Envelope();
+}
+
+void VoiceFilterBank::beginBlock(int numSamples)
+{
+    for (auto &buffer : voiceBuffers)
+    {
+        // Hosts may send more than they announced; growing here is the rare exception
+        if (buffer.getNumSamples() < numSamples)
+            buffer.setSize(NUM_CHANNELS, numSamples, false, false, true);
+
+        buffer.clear(0, numSamples);
+    }
+}
+
+void VoiceFilterBank::process(const std::array<VoiceState, MAX_VOICES> &voices, juce::AudioBuffer<float> &output,
+                              int startSample, int numSamples)
+{
+    // Work out which voices need filtering: sounding, just started, or still ringing out
+    std::array<bool, MAX_VOICES> active{};
+
+    for (int v = 0; v < MAX_VOICES; ++v)
+    {
+        const auto &voice = voices[static_cast<size_t>(v)];
+        bool newNote = voice.noteId != lastNoteIds[static_cast<size_t>(v)];
+
+        if (newNote)
+        {
+            // A new note starts from a clean filter and a retriggered envelope
+            lastNoteIds[static_cast<size_t>(v)] = voice.noteId;
+
+            for (int channel = 0; channel < NUM_CHANNELS; ++channel)
+                ic1[channel][v] = ic2[channel][v] = 0.0f;
+
+            envelopes[static_cast<size_t>(v)] = {EnvelopeStage::attack, 0.0f};
+        }
+
+        active[static_cast<size_t>(v)] = voice.playing || newNote || !isSettled(v);
+
+        // Flush what is left of a finished voice so it doesn't linger as denormals
+        if (!active[static_cast<size_t>(v)])
+        {
+            for (int channel = 0; channel < NUM_CHANNELS; ++channel)
+                ic1[channel][v] = ic2[channel][v] = 0.0f;
+        }
+    }
+
+    // Mode as a mix of the input, band-pass and low-pass outputs, so every lane runs the same code
+    damping = 1.0f / juce::jmax(0.1f, parameters.resonance);
+    float mixInput = 0.0f, mixBand = 0.0f, mixLow = 1.0f;
+
+    switch (parameters.mode)
+    {
+    case FilterParameters::Mode::bandPass:
+        mixBand = 1.0f;
+        mixLow = 0.0f;
+        break;
+    case FilterParameters::Mode::highPass:
+        mixInput = 1.0f;
+        mixBand = -damping;
+        mixLow = -1.0f;
+        break;
+    case FilterParameters::Mode::notch:
+        mixInput = 1.0f;
+        mixBand = -damping;
+        mixLow = 0.0f;
+        break;
+    default:
+        break;
+    }
+
+    const auto vMixInput = Vec::expand(mixInput);
+    const auto vMixBand = Vec::expand(mixBand);
+    const auto vMixLow = Vec::expand(mixLow);
+    const auto two = Vec::expand(2.0f);
+
+    // Voices always render in stereo; a mono output takes both channels folded down at half level each
+    const int numOutputChannels = juce::jmin(output.getNumChannels(), NUM_CHANNELS);
+    const float foldGain = numOutputChannels < NUM_CHANNELS ? 0.5f : 1.0f;
+
+    if (numOutputChannels == 0)
+        return;
+    alignas(sizeof(Vec)) float input[LANES] = {};
+
+    for (int offset = 0; offset < numSamples; offset += CONTROL_INTERVAL)
+    {
+        const int count = juce::jmin(CONTROL_INTERVAL, numSamples - offset);
+
+        // Control rate: envelopes and cutoff
+        for (int v = 0; v < MAX_VOICES; ++v)
+        {
+            if (active[static_cast<size_t>(v)])
+            {
+                advanceEnvelope(envelopes[static_cast<size_t>(v)], voices[static_cast<size_t>(v)].held, count);
+                updateCoefficients(v, voices[static_cast<size_t>(v)]);
+            }
+        }
+
+        for (int group = 0; group < NUM_GROUPS; ++group)
+        {
+            const int first = group * LANES;
+
+            // Nothing sounding in this group: skip it entirely
+            if (std::none_of(active.begin() + first, active.begin() + first + LANES, [](bool a)
+                             { return a; }))
+                continue;
+
+            const auto vA1 = Vec::fromRawArray(a1 + first);
+            const auto vA2 = Vec::fromRawArray(a2 + first);
+            const auto vA3 = Vec::fromRawArray(a3 + first);
+
+            for (int channel = 0; channel < NUM_CHANNELS; ++channel)
+            {
+                const float *voiceInput[LANES];
+
+                for (int lane = 0; lane < LANES; ++lane)
+                    voiceInput[lane] = voiceBuffers[static_cast<size_t>(first + lane)].getReadPointer(channel, offset);
+
+                float *out = output.getWritePointer(juce::jmin(channel, numOutputChannels - 1), startSample + offset);
+                auto s1 = Vec::fromRawArray(ic1[channel] + first);
+                auto s2 = Vec::fromRawArray(ic2[channel] + first);
+
+                for (int i = 0; i < count; ++i)
+                {
+                    for (int lane = 0; lane < LANES; ++lane)
+                        input[lane] = voiceInput[lane][i];
+
+                    // Trapezoidal state-variable filter, one voice per lane
+                    const auto v0 = Vec::fromRawArray(input);
+                    const auto v3 = v0 - s2;
+                    const auto v1 = vA1 * s1 + vA2 * v3;
+                    const auto v2 = s2 + vA2 * s1 + vA3 * v3;
+                    s1 = two * v1 - s1;
+                    s2 = two * v2 - s2;
+
+                    out[i] += (v0 * vMixInput + v1 * vMixBand + v2 * vMixLow).sum() * foldGain;
+                }
+
+                s1.copyToRawArray(ic1[channel] + first);
+                s2.copyToRawArray(ic2[channel] + first);
+            }
+        }
+    }
+}
+
+void VoiceFilterBank::advanceEnvelope(Envelope &envelope, bool held, int numSamples) const
+{
+    if (!held && envelope.stage != EnvelopeStage::idle)
+        envelope.stage = EnvelopeStage::release;
+
+    auto samplesFor = [this](float ms)
+    {
+        return static_cast<float>(juce::jmax(1.0, ms * sampleRate / 1000.0));
+    };
+
+    switch (envelope.stage)
+    {
+    case EnvelopeStage::attack:
+        envelope.level += numSamples / samplesFor(parameters.attackMs);
+        if (envelope.level >= 1.0f)
+        {
+            envelope.level = 1.0f;
+            envelope.stage = EnvelopeStage::decay;
+        }
+        break;
+
+    case EnvelopeStage::decay:
+        envelope.level -= numSamples * (1.0f - parameters.sustain) / samplesFor(parameters.decayMs);
+        if (envelope.level <= parameters.sustain)
+        {
+            envelope.level = parameters.sustain;
+            envelope.stage = EnvelopeStage::sustain;
+        }
+        break;
+
+    case EnvelopeStage::sustain:
+        envelope.level = parameters.sustain;
+        break;
+
+    case EnvelopeStage::release:
+        envelope.level -= numSamples / samplesFor(parameters.releaseMs);
+        if (envelope.level <= 0.0f)
+        {
+            envelope.level = 0.0f;
+            envelope.stage = EnvelopeStage::idle;
+        }
+        break;
+
+    case EnvelopeStage::idle:
+        break;
+    }
+}
+
+void VoiceFilterBank::updateCoefficients(int voice, const VoiceState &state)
+{
+    const float level = envelopes[static_cast<size_t>(voice)].level;
+    const float octaves = parameters.envelopeAmount * level + parameters.velocityAmount * state.velocity + state.cutoffOffset;
+    const double cutoff = juce::jlimit(20.0, sampleRate * 0.49, parameters.cutoffHz * std::exp2(static_cast<double>(octaves)));
+
+    const double g = std::tan(juce::MathConstants<double>::pi * cutoff / sampleRate);
+    const double coefficient1 = 1.0 / (1.0 + g * (g + damping));
+
+    a1[voice] = static_cast<float>(coefficient1);
+    a2[voice] = static_cast<float>(g * coefficient1);
+    a3[voice] = static_cast<float>(g * g * coefficient1);
+}
+
+bool VoiceFilterBank::isSilent() const
+{
+    if (!isEnabled())
+        return true;
+
+    for (int v = 0; v < MAX_VOICES; ++v)
+    {
+        if (!isSettled(v))
+            return false;
+    }
+
+    return true;
+}
+
+bool VoiceFilterBank::isSettled(int voice) const
+{
+    float energy = 0.0f;
+
+    for (int channel = 0; channel < NUM_CHANNELS; ++channel)
+        energy += std::abs(ic1[channel][voice]) + std::abs(ic2[channel][voice]);
+
+    return energy < 1.0e-6f;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Filter settings shared by every voice
+struct FilterParameters
+{
+    enum class Mode
+    {
+        off,
+        lowPass,
+        bandPass,
+        highPass,
+        notch
+    };
+
+    Mode mode = Mode::off;
+    float cutoffHz = 2000.0f;
+    float resonance = 0.707f;     // Q
+    float envelopeAmount = 0.0f;  // cutoff modulation at full envelope, in octaves
+    float velocityAmount = 0.0f;  // cutoff modulation at full velocity, in octaves
+    float attackMs = 5.0f;        // filter envelope
+    float decayMs = 200.0f;
+    float sustain = 1.0f;
+    float releaseMs = 200.0f;
+};
+
+// Per-voice multimode state-variable filters for the whole sampler.
+// Voices render into their own buffers, then the bank filters them and mixes the result
+// into the output. Filter state is laid out with one voice per SIMD lane, so each register
+// filters 4 (SSE/NEON) or 8 (AVX) voices at once, and groups with no sounding voice are skipped.
+// Coefficients and envelopes run at control rate, every CONTROL_INTERVAL samples.
+class VoiceFilterBank
+{
+public:
+    static constexpr int MAX_VOICES = 8;
+    static constexpr int NUM_CHANNELS = 2;
+    static constexpr int CONTROL_INTERVAL = 32;
+
+    // What the bank needs to know about a voice each block
+    struct VoiceState
+    {
+        bool playing = false;   // has a sound, including its release
+        bool held = false;      // note still held (gates the filter envelope)
+        float velocity = 0.0f;
+        juce::uint32 noteId = 0; // changes whenever the voice starts a new note
+        float cutoffOffset = 0.0f; // per-note cutoff modulation in octaves (MPE timbre)
+    };
+
+    VoiceFilterBank();
+
+    void prepare(double sampleRate, int maximumBlockSize);
+    void reset();
+
+    void setParameters(const FilterParameters &newParameters) { parameters = newParameters; }
+    bool isEnabled() const { return parameters.mode != FilterParameters::Mode::off; }
+
+    // True when no voice's filter is still ringing
+    bool isSilent() const;
+
+    // Buffer a voice renders into while the filter is enabled
+    juce::AudioBuffer<float> &getVoiceBuffer(int voice) { return voiceBuffers[static_cast<size_t>(voice)]; }
+
+    // Clear the voice buffers before the voices render (audio thread)
+    void beginBlock(int numSamples);
+
+    // Filter every voice buffer and add the result to the output (audio thread)
+    void process(const std::array<VoiceState, MAX_VOICES> &voices, juce::AudioBuffer<float> &output,
+                 int startSample, int numSamples);
+
+private:
+    using Vec = juce::dsp::SIMDRegister<float>;
+    static constexpr int LANES = static_cast<int>(Vec::SIMDNumElements);
+    static_assert(MAX_VOICES % LANES == 0, "voices must fill whole SIMD registers");
+    static constexpr int NUM_GROUPS = MAX_VOICES / LANES;
+
+    enum class EnvelopeStage
+    {
+        idle,
+        attack,
+        decay,
+        sustain,
+        release
+    };
+
+    struct Envelope
+    {
+        EnvelopeStage stage = EnvelopeStage::idle;
+        float level = 0.0f;
+    };
+
+    double sampleRate = 44100.0;
+    FilterParameters parameters;
+
+    std::array<juce::AudioBuffer<float>, MAX_VOICES> voiceBuffers;
+    std::array<Envelope, MAX_VOICES> envelopes;
+    std::array<juce::uint32, MAX_VOICES> lastNoteIds{};
+
+    // Integrator state per channel, one voice per lane
+    alignas(sizeof(Vec)) float ic1[NUM_CHANNELS][MAX_VOICES] = {};
+    alignas(sizeof(Vec)) float ic2[NUM_CHANNELS][MAX_VOICES] = {};
+
+    // Coefficients per voice, shared by both channels
+    alignas(sizeof(Vec)) float a1[MAX_VOICES] = {};
+    alignas(sizeof(Vec)) float a2[MAX_VOICES] = {};
+    alignas(sizeof(Vec)) float a3[MAX_VOICES] = {};
+
+    // Damping from the resonance, shared by all voices
+    float damping = 1.414f;
+
+    void advanceEnvelope(Envelope &envelope, bool held, int numSamples) const;
+    void updateCoefficients(int voice, const VoiceState &state);
+    bool isSettled(int voice) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VoiceFilterBank)
+};
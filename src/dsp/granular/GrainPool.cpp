@@ -0,0 +1,190 @@
+#include "GrainPool.h"
+
+namespace
+{
+    struct HannTable
+    {
+        std::array<float, GrainWindow::SIZE + 2> values{};
+
+        HannTable()
+        {
+            for (int i = 0; i <= GrainWindow::SIZE; ++i)
+            {
+                const double phase = juce::MathConstants<double>::twoPi * i / GrainWindow::SIZE;
+                values[static_cast<size_t>(i)] = static_cast<float>(0.5 - 0.5 * std::cos(phase));
+            }
+
+            // The window ends at zero and stays there
+            values[GrainWindow::SIZE] = 0.0f;
+            values[GrainWindow::SIZE + 1] = 0.0f;
+        }
+    };
+
+    // Source for unused SIMD lanes
+    const float silence[2] = {0.0f, 0.0f};
+}
+
+const float *GrainWindow::get()
+{
+    static const HannTable table;
+    return table.values.data();
+}
+
+//==============================================================================
+GrainPool::GrainPool()
+{
+    // Build the shared window now rather than on the audio thread
+    GrainWindow::get();
+}
+
+bool GrainPool::spawn(const float *inL, const float *inR, int sourceLength, double start, double step,
+                      int durationFrames, float gainL, float gainR)
+{
+    if (numActive >= CAPACITY)
+    {
+        ++numDropped;
+        return false;
+    }
+
+    if (sourceLength < 2 || durationFrames <= 0)
+        return false;
+
+    const int g = numActive++;
+    sourcesL[static_cast<size_t>(g)] = inL;
+    sourcesR[static_cast<size_t>(g)] = inR;
+    lastIndices[static_cast<size_t>(g)] = sourceLength - 2;
+    positions[static_cast<size_t>(g)] = juce::jlimit(0.0, static_cast<double>(sourceLength - 2), start);
+    steps[static_cast<size_t>(g)] = step;
+    windowPhases[static_cast<size_t>(g)] = 0.0f;
+    windowSteps[static_cast<size_t>(g)] = static_cast<float>(GrainWindow::SIZE) / static_cast<float>(durationFrames);
+    gainsL[static_cast<size_t>(g)] = gainL;
+    gainsR[static_cast<size_t>(g)] = gainR;
+
+    ++numSpawned;
+    return true;
+}
+
+void GrainPool::render(float *outL, float *outR, int numSamples, float &peak)
+{
+    if (numActive == 0 || numSamples <= 0)
+        return;
+
+    for (int first = 0; first < numActive; first += LANES)
+        renderGroup(first, juce::jmin(LANES, numActive - first), outL, outR, numSamples, peak);
+
+    retireFinished();
+}
+
+void GrainPool::renderGroup(int first, int lanes, float *outL, float *outR, int numSamples, float &peak)
+{
+    const float *window = GrainWindow::get();
+
+    // Group state in lane order; unused lanes read silence with a finished window and no gain
+    const float *sourceL[LANES];
+    const float *sourceR[LANES];
+    int lastIndex[LANES];
+    double position[LANES];
+    double step[LANES];
+    alignas(sizeof(Vec)) float phase[LANES];
+    alignas(sizeof(Vec)) float phaseStep[LANES];
+    alignas(sizeof(Vec)) float gainL[LANES];
+    alignas(sizeof(Vec)) float gainR[LANES];
+
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        const bool used = lane < lanes;
+        const auto g = static_cast<size_t>(first + lane);
+        sourceL[lane] = used ? sourcesL[g] : silence;
+        sourceR[lane] = used ? sourcesR[g] : silence;
+        lastIndex[lane] = used ? lastIndices[g] : 0;
+        position[lane] = used ? positions[g] : 0.0;
+        step[lane] = used ? steps[g] : 0.0;
+        phase[lane] = used ? windowPhases[g] : static_cast<float>(GrainWindow::SIZE);
+        phaseStep[lane] = used ? windowSteps[g] : 0.0f;
+        gainL[lane] = used ? gainsL[g] : 0.0f;
+        gainR[lane] = used ? gainsR[g] : 0.0f;
+    }
+
+    const auto vPhaseStep = Vec::fromRawArray(phaseStep);
+    const auto vGainL = Vec::fromRawArray(gainL);
+    const auto vGainR = Vec::fromRawArray(gainR);
+
+    // Gathered per sample: interpolation endpoints for source and window, and their fractions
+    alignas(sizeof(Vec)) float aL[LANES], bL[LANES], aR[LANES], bR[LANES], fraction[LANES];
+    alignas(sizeof(Vec)) float windowA[LANES], windowB[LANES], windowFraction[LANES];
+
+    float localPeak = peak;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            const int index = std::min(static_cast<int>(position[lane]), lastIndex[lane]);
+            fraction[lane] = std::min(1.0f, static_cast<float>(position[lane] - index));
+            aL[lane] = sourceL[lane][index];
+            bL[lane] = sourceL[lane][index + 1];
+            aR[lane] = sourceR[lane][index];
+            bR[lane] = sourceR[lane][index + 1];
+
+            const int w = std::min(static_cast<int>(phase[lane]), GrainWindow::SIZE);
+            windowFraction[lane] = phase[lane] - static_cast<float>(w);
+            windowA[lane] = window[w];
+            windowB[lane] = window[w + 1];
+
+            position[lane] += step[lane];
+        }
+
+        const auto vWindowA = Vec::fromRawArray(windowA);
+        const auto level = vWindowA + Vec::fromRawArray(windowFraction) * (Vec::fromRawArray(windowB) - vWindowA);
+        const auto vFraction = Vec::fromRawArray(fraction);
+
+        const auto vAL = Vec::fromRawArray(aL);
+        const float left = ((vAL + vFraction * (Vec::fromRawArray(bL) - vAL)) * level * vGainL).sum();
+        outL[i] += left;
+        localPeak = juce::jmax(localPeak, std::abs(left));
+
+        if (outR != nullptr)
+        {
+            const auto vAR = Vec::fromRawArray(aR);
+            const float right = ((vAR + vFraction * (Vec::fromRawArray(bR) - vAR)) * level * vGainR).sum();
+            outR[i] += right;
+            localPeak = juce::jmax(localPeak, std::abs(right));
+        }
+
+        (Vec::fromRawArray(phase) + vPhaseStep).copyToRawArray(phase);
+    }
+
+    for (int lane = 0; lane < lanes; ++lane)
+    {
+        const auto g = static_cast<size_t>(first + lane);
+        positions[g] = position[lane];
+        windowPhases[g] = phase[lane];
+    }
+
+    peak = localPeak;
+}
+
+void GrainPool::retireFinished()
+{
+    for (int g = 0; g < numActive;)
+    {
+        if (windowPhases[static_cast<size_t>(g)] < static_cast<float>(GrainWindow::SIZE))
+        {
+            ++g;
+            continue;
+        }
+
+        // Move the last active grain into this slot
+        const auto last = static_cast<size_t>(--numActive);
+        const auto slot = static_cast<size_t>(g);
+        sourcesL[slot] = sourcesL[last];
+        sourcesR[slot] = sourcesR[last];
+        lastIndices[slot] = lastIndices[last];
+        positions[slot] = positions[last];
+        steps[slot] = steps[last];
+        windowPhases[slot] = windowPhases[last];
+        windowSteps[slot] = windowSteps[last];
+        gainsL[slot] = gainsL[last];
+        gainsR[slot] = gainsR[last];
+    }
+}
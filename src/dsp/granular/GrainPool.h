@@ -0,0 +1,69 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Hann window shared by every grain, computed once per process
+class GrainWindow
+{
+public:
+    static constexpr int SIZE = 1024;
+
+    // SIZE + 2 entries: the window itself, then zeros so a finished grain reads silence
+    static const float *get();
+};
+
+// Fixed set of grains owned by one voice. All storage is allocated up front;
+// spawn() and render() never allocate and simply drop grains once the pool is full.
+// Grain state is kept as structure-of-arrays so several grains are mixed per SIMD register.
+class GrainPool
+{
+public:
+    static constexpr int CAPACITY = 256;
+
+    GrainPool();
+
+    // Start a grain reading inL/inR (inR may equal inL) from start, stepping by step frames per
+    // output sample, lasting durationFrames. Returns false if the pool is full.
+    bool spawn(const float *inL, const float *inR, int sourceLength, double start, double step,
+               int durationFrames, float gainL, float gainR);
+
+    // Mix every active grain into the output; outR may be null for mono output
+    void render(float *outL, float *outR, int numSamples, float &peak);
+
+    void clear() { numActive = 0; }
+
+    int getNumActive() const { return numActive; }
+    bool isEmpty() const { return numActive == 0; }
+
+    // Totals since construction (audio thread)
+    juce::uint64 getNumSpawned() const { return numSpawned; }
+    juce::uint64 getNumDropped() const { return numDropped; }
+
+private:
+    using Vec = juce::dsp::SIMDRegister<float>;
+    static constexpr int LANES = static_cast<int>(Vec::SIMDNumElements);
+
+    // Active grains are packed at the front
+    int numActive = 0;
+
+    std::array<const float *, CAPACITY> sourcesL{};
+    std::array<const float *, CAPACITY> sourcesR{};
+    std::array<int, CAPACITY> lastIndices{};
+    std::array<double, CAPACITY> positions{};
+    std::array<double, CAPACITY> steps{};
+    std::array<float, CAPACITY> windowPhases{};
+    std::array<float, CAPACITY> windowSteps{};
+    std::array<float, CAPACITY> gainsL{};
+    std::array<float, CAPACITY> gainsR{};
+
+    juce::uint64 numSpawned = 0;
+    juce::uint64 numDropped = 0;
+
+    // Mix one group of up to LANES grains starting at the given index
+    void renderGroup(int first, int lanes, float *outL, float *outR, int numSamples, float &peak);
+
+    // Remove grains whose window has run out
+    void retireFinished();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GrainPool)
+};
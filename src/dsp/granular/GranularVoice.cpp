@@ -0,0 +1,199 @@
+#include "GranularVoice.h"
+#include "Trace.h"
+
+bool ProxyGranularVoice::canPlaySound(juce::SynthesiserSound *sound)
+{
+    // Grains read float pages directly, so compressed sounds must have been decoded for granular mode
+    auto *samplerSound = dynamic_cast<ProxySamplerSound *>(sound);
+    return samplerSound != nullptr && samplerSound->hasFloatAudio();
+}
+
+void ProxyGranularVoice::startNote(int midiNoteNumber, float velocity,
+                                   juce::SynthesiserSound *s, int currentPitchWheelPosition)
+{
+    if (auto *sound = dynamic_cast<ProxySamplerSound *>(s))
+    {
+        // Same tuning and loudness as the sample voice: the sound's root plays at the original pitch
+        noteRatio = std::pow(2.0, (midiNoteNumber - sound->getRootNote()) / 12.0);
+        currentMidiNote = midiNoteNumber;
+        velocityGain = velocity * sound->getNormalisationGain();
+        beginNote(midiNoteNumber, velocity, currentPitchWheelPosition);
+
+        const auto length = static_cast<double>(sound->getAudioData().getNumFrames());
+        readHead = juce::jlimit(0.0f, 1.0f, parameters.position) * (length - 1);
+        framesUntilNextGrain = 0.0;
+
+        // A stolen voice may still have grains from its previous note
+        grains.clear();
+
+        envelopeLevel = 0.0;
+        attackPhase = true;
+        releasePhase = false;
+        shouldKill = false;
+    }
+    else
+    {
+        stopNote(0.0f, false);
+    }
+}
+
+void ProxyGranularVoice::stopNote(float /*velocity*/, bool allowTailOff)
+{
+    if (allowTailOff)
+    {
+        releasePhase = true;
+        attackPhase = false;
+    }
+    else
+    {
+        shouldKill = true;
+    }
+}
+
+void ProxyGranularVoice::setAttackRate(double newSampleRate, double attackTimeMs)
+{
+    sampleRate = newSampleRate;
+    const double attackSamples = sampleRate * (attackTimeMs / 1000.0);
+    attackRate = attackSamples > 0 ? 1.0 / attackSamples : 1.0;
+}
+
+void ProxyGranularVoice::setReleaseRate(double newSampleRate, double releaseTimeMs)
+{
+    sampleRate = newSampleRate;
+    const double releaseSamples = sampleRate * (releaseTimeMs / 1000.0);
+    releaseRate = releaseSamples > 0 ? 1.0 / releaseSamples : 1.0;
+}
+
+void ProxyGranularVoice::renderNextBlock(juce::AudioBuffer<float> &outputBuffer, int startSample, int numSamples)
+{
+    PROXY_TRACE_SCOPE("granular voice render");
+
+    if (shouldKill)
+    {
+        grains.clear();
+        clearCurrentNote();
+        return;
+    }
+
+    auto *sound = dynamic_cast<ProxySamplerSound *>(getCurrentlyPlayingSound().get());
+
+    if (sound == nullptr)
+        return;
+
+    auto &destination = getRenderBuffer(outputBuffer);
+    float *outL = destination.getWritePointer(0, startSample);
+    float *outR = destination.getNumChannels() > 1 ? destination.getWritePointer(1, startSample) : nullptr;
+
+    const auto length = static_cast<double>(sound->getAudioData().getNumFrames());
+    const double grainInterval = sampleRate / juce::jlimit(1.0f, MAX_DENSITY, parameters.density);
+
+    int done = 0;
+
+    // Render up to each grain start, then start it, so grains begin sample-accurately
+    while (done < numSamples)
+    {
+        while (framesUntilNextGrain <= 0.0)
+        {
+            // Once the release has finished, only the remaining grains play out
+            if (!(releasePhase && envelopeLevel <= 0.0))
+                spawnGrain(*sound, startSample + done);
+
+            framesUntilNextGrain += grainInterval;
+        }
+
+        const int count = juce::jmin(numSamples - done, static_cast<int>(std::ceil(framesUntilNextGrain)));
+
+        grains.render(outL + done, outR != nullptr ? outR + done : nullptr, count, blockPeak);
+        framesUntilNextGrain -= count;
+        advanceEnvelope(count);
+
+        if (auto *engine = getModulationEngine())
+            engine->advance(getNoteModulationState(), count);
+
+        // Move the read head, wrapping around the sample
+        readHead += parameters.speed * count;
+        readHead -= std::floor(readHead / length) * length;
+
+        done += count;
+    }
+
+    if (releasePhase && envelopeLevel <= 0.0 && grains.isEmpty())
+        clearCurrentNote();
+}
+
+void ProxyGranularVoice::spawnGrain(const ProxySamplerSound &sound, int offsetInBlock)
+{
+    ModulationEngine::Targets modulation;
+
+    if (auto *engine = getModulationEngine())
+        modulation = engine->evaluate(getNoteModulation(), offsetInBlock / ModulationEngine::CONTROL_INTERVAL);
+
+    // Grain pitch from the note, the transpose control and modulation, read from the matching mipmap octave
+    const double step = noteRatio * std::pow(2.0, parameters.pitchSemitones / 12.0) * modulation.pitchRatio;
+    const int octave = sound.chooseOctave(step);
+    const double levelScale = static_cast<double>(1 << octave);
+    const double levelStep = step / levelScale;
+
+    const auto &audio = *sound.getLevel(octave).audio;
+    const auto levelLength = static_cast<double>(audio.getNumFrames());
+
+    const float grainMs = juce::jlimit(MIN_GRAIN_MS, MAX_GRAIN_MS, parameters.grainSizeMs);
+    int grainFrames = juce::jmax(1, juce::roundToInt(grainMs * sampleRate / 1000.0));
+
+    // Scatter the start around the read head and keep the whole grain inside the sample
+    const double spray = parameters.spray * static_cast<double>(sound.getAudioData().getNumFrames()) * (random.nextDouble() * 2.0 - 1.0);
+    double span = grainFrames * levelStep;
+    double start = juce::jlimit(0.0, juce::jmax(0.0, levelLength - 2 - span), (readHead + spray) / levelScale);
+
+    // A grain reads a single page: one that would straddle a page boundary moves onto the page
+    // holding most of it, and one longer than a page is shortened to fit
+    const int page = juce::jlimit(0, audio.getNumPages() - 1, PagedAudioBuffer::pageOf(static_cast<juce::int64>(start + span * 0.5)));
+    const int pageLength = audio.getPageLength(page);
+
+    if (span > pageLength - 2)
+    {
+        grainFrames = juce::jmax(1, static_cast<int>((pageLength - 2) / levelStep));
+        span = grainFrames * levelStep;
+    }
+
+    start = juce::jlimit(0.0, juce::jmax(0.0, pageLength - 2 - span), start - static_cast<double>(PagedAudioBuffer::pageStart(page)));
+
+    // Keep the level steady as density and grain size change the number of overlapping grains
+    const float overlap = juce::jlimit(1.0f, MAX_DENSITY, parameters.density) * grainMs / 1000.0f;
+    const float gain = velocityGain * modulation.gain * static_cast<float>(envelopeLevel) / std::sqrt(juce::jmax(1.0f, overlap * 0.375f));
+
+    const float *inL = audio.getPage(0, page);
+    const float *inR = audio.getNumChannels() > 1 ? audio.getPage(1, page) : inL;
+
+    grains.spawn(inL, inR, pageLength, start, levelStep, grainFrames, gain, gain);
+}
+
+void ProxyGranularVoice::advanceEnvelope(int numFrames)
+{
+    if (attackPhase)
+    {
+        envelopeLevel += attackRate * numFrames;
+
+        if (envelopeLevel >= 1.0)
+        {
+            envelopeLevel = 1.0;
+            attackPhase = false;
+        }
+    }
+    else if (releasePhase)
+    {
+        envelopeLevel = juce::jmax(0.0, envelopeLevel - releaseRate * numFrames);
+    }
+}
+
+bool ProxyGranularVoice::isVoiceActive() const
+{
+    return getCurrentlyPlayingSound() != nullptr && !releasePhase && !shouldKill;
+}
+
+float ProxyGranularVoice::takeBlockPeak()
+{
+    const float peak = blockPeak;
+    blockPeak = 0.0f;
+    return peak;
+}
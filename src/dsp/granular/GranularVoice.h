@@ -0,0 +1,73 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SamplerVoice.h"
+#include "GrainPool.h"
+
+// Controls shared by every granular voice
+struct GranularParameters
+{
+    float position = 0.0f;       // where the read head starts, 0..1 of the sample
+    float speed = 1.0f;          // read head speed relative to the original, 0 freezes it
+    float spray = 0.05f;         // random start offset, 0..1 of the sample
+    float density = 40.0f;       // grains per second
+    float grainSizeMs = 80.0f;   // grain length
+    float pitchSemitones = 0.0f; // grain transposition on top of the played note
+};
+
+// A voice that plays the current sample as a stream of short windowed grains.
+// The note sets the grain pitch; the read head moves independently of it, so the
+// sample can be stretched or frozen. Grains outlive the note by at most one grain length.
+// Modulation is sampled as each grain starts, which is already a control rate.
+class ProxyGranularVoice : public ProxyVoice
+{
+public:
+    static constexpr float MIN_GRAIN_MS = 5.0f;
+    static constexpr float MAX_GRAIN_MS = 1000.0f;
+    static constexpr float MAX_DENSITY = 2000.0f;
+
+    ProxyGranularVoice() = default;
+
+    bool canPlaySound(juce::SynthesiserSound *sound) override;
+    void startNote(int midiNoteNumber, float velocity, juce::SynthesiserSound *s, int currentPitchWheelPosition) override;
+    void stopNote(float velocity, bool allowTailOff) override;
+
+    void setAttackRate(double newSampleRate, double attackTimeMs) override;
+    void setReleaseRate(double newSampleRate, double releaseTimeMs) override;
+    void setParameters(const GranularParameters &newParameters) { parameters = newParameters; }
+
+    void renderNextBlock(juce::AudioBuffer<float> &outputBuffer, int startSample, int numSamples) override;
+
+    bool isVoiceActive() const override;
+
+    // Read head position in frames of the original sample
+    double getCurrentSamplePosition() const override { return readHead; }
+    int getCurrentMidiNote() const override { return currentMidiNote; }
+    float takeBlockPeak() override;
+
+    const GrainPool &getGrainPool() const { return grains; }
+
+private:
+    GrainPool grains;
+    GranularParameters parameters;
+    juce::Random random;
+
+    double noteRatio = 1.0;
+    float velocityGain = 0.0f;
+    double readHead = 0.0;
+    double framesUntilNextGrain = 0.0;
+
+    // Envelope, applied to each grain as it starts
+    double attackRate = 1.0, releaseRate = 1.0;
+    bool attackPhase = false, releasePhase = false;
+    double envelopeLevel = 0.0;
+
+    float blockPeak = 0.0f;
+    int currentMidiNote = -1;
+    double sampleRate = 44100.0;
+    bool shouldKill = false;
+
+    // Start a grain with the modulation at this point in the block
+    void spawnGrain(const ProxySamplerSound &sound, int offsetInBlock);
+    void advanceEnvelope(int numFrames);
+};
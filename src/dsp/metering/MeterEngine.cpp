@@ -0,0 +1,370 @@
+#include "MeterEngine.h"
+
+MeterEngine::MeterEngine()
+{
+    designTruePeakFilter();
+}
+
+void MeterEngine::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+
+    // Hold peaks for 1.5s, then fall at 20dB per second
+    peakHoldTimeSamples = static_cast<int>(sampleRate * 1.5);
+    peakHoldDecayPerSample = static_cast<float>(std::pow(10.0, -20.0 / 20.0 / sampleRate));
+
+    stepLengthSamples = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+
+    truePeakHistory.setSize(NUM_CHANNELS, maximumBlockSize + TAPS_PER_PHASE - 1);
+    weighted.setSize(NUM_CHANNELS, maximumBlockSize);
+
+    designKWeighting();
+    reset();
+}
+
+void MeterEngine::reset()
+{
+    snapshot = MeterSnapshot();
+    peakHoldSamplesLeft.fill(0);
+    rmsState.fill(0.0f);
+    truePeakHistory.clear();
+
+    for (auto &filter : shelfFilters)
+        filter.reset();
+    for (auto &filter : highPassFilters)
+        filter.reset();
+
+    stepSamplesDone = 0;
+    stepEnergy = 0.0;
+    stepHistory.fill(0.0);
+    stepHistoryIndex = 0;
+    stepsSeen = 0;
+
+    resetIntegrated();
+}
+
+void MeterEngine::resetIntegrated()
+{
+    histogramCounts.fill(0);
+    histogramEnergy.fill(0.0);
+    snapshot.integratedLufs = MeterSnapshot::SILENCE_LUFS;
+}
+
+//==============================================================================
+float MeterEngine::findPeak(const float *data, int numSamples)
+{
+    if (numSamples <= 0)
+        return 0.0f;
+
+    const auto range = juce::FloatVectorOperations::findMinAndMax(data, numSamples);
+    return juce::jmax(-range.getStart(), range.getEnd());
+}
+
+float MeterEngine::sumOfSquares(const float *data, int numSamples)
+{
+    float sum = 0.0f;
+    int i = 0;
+
+    // Scalar head until the data is SIMD aligned
+    for (; i < numSamples && !Vec::isSIMDAligned(data + i); ++i)
+        sum += data[i] * data[i];
+
+    auto accumulator = Vec::expand(0.0f);
+
+    for (; i + static_cast<int>(Vec::size()) <= numSamples; i += static_cast<int>(Vec::size()))
+    {
+        const auto value = Vec::fromRawArray(data + i);
+        accumulator += value * value;
+    }
+
+    sum += accumulator.sum();
+
+    // Scalar tail
+    for (; i < numSamples; ++i)
+        sum += data[i] * data[i];
+
+    return sum;
+}
+
+//==============================================================================
+void MeterEngine::Biquad::process(const float *input, float *output, int numSamples)
+{
+    // Transposed direct form II, double precision state for the low frequency high-pass
+    double s1 = z1, s2 = z2;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const double x = input[i];
+        const double y = b0 * x + s1;
+        s1 = b1 * x - a1 * y + s2;
+        s2 = b2 * x - a2 * y;
+        output[i] = static_cast<float>(y);
+    }
+
+    z1 = s1;
+    z2 = s2;
+}
+
+void MeterEngine::designKWeighting()
+{
+    // Stage 1: high shelf modelling the head (BS.1770, recomputed for any sample rate)
+    {
+        const double f0 = 1681.974450955533;
+        const double gainDb = 3.999843853973347;
+        const double q = 0.7071752369554196;
+
+        const double k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double vh = std::pow(10.0, gainDb / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+
+        for (auto &filter : shelfFilters)
+        {
+            filter.b0 = (vh + vb * k / q + k * k) / a0;
+            filter.b1 = 2.0 * (k * k - vh) / a0;
+            filter.b2 = (vh - vb * k / q + k * k) / a0;
+            filter.a1 = 2.0 * (k * k - 1.0) / a0;
+            filter.a2 = (1.0 - k / q + k * k) / a0;
+        }
+    }
+
+    // Stage 2: RLB high-pass
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+
+        const double k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+
+        for (auto &filter : highPassFilters)
+        {
+            filter.b0 = 1.0;
+            filter.b1 = -2.0;
+            filter.b2 = 1.0;
+            filter.a1 = 2.0 * (k * k - 1.0) / a0;
+            filter.a2 = (1.0 - k / q + k * k) / a0;
+        }
+    }
+}
+
+void MeterEngine::designTruePeakFilter()
+{
+    // Windowed sinc interpolator with its cutoff at the original Nyquist frequency
+    const int numTaps = TAPS_PER_PHASE * OVERSAMPLING;
+    const double centre = (numTaps - 1) * 0.5;
+    std::array<double, TAPS_PER_PHASE * OVERSAMPLING> taps{};
+    double total = 0.0;
+
+    for (int n = 0; n < numTaps; ++n)
+    {
+        const double x = (n - centre) / OVERSAMPLING;
+        const double sinc = x == 0.0 ? 1.0 : std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+        const double window = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * (n + 0.5) / numTaps);
+        taps[static_cast<size_t>(n)] = sinc * window;
+        total += taps[static_cast<size_t>(n)];
+    }
+
+    // Split into phases, one phase per SIMD lane; spare lanes stay zero
+    truePeakTable.fill(0.0f);
+
+    for (int tap = 0; tap < TAPS_PER_PHASE; ++tap)
+        for (int phase = 0; phase < OVERSAMPLING && phase < static_cast<int>(Vec::SIMDNumElements); ++phase)
+            truePeakTable[static_cast<size_t>(tap) * Vec::SIMDNumElements + static_cast<size_t>(phase)] =
+                static_cast<float>(taps[static_cast<size_t>(tap * OVERSAMPLING + phase)] * OVERSAMPLING / total);
+}
+
+float MeterEngine::processTruePeak(int channel, const float *data, int numSamples)
+{
+    const int historyLength = TAPS_PER_PHASE - 1;
+    float *history = truePeakHistory.getWritePointer(channel);
+
+    // Append the block after the samples kept from the previous one
+    juce::FloatVectorOperations::copy(history + historyLength, data, numSamples);
+
+    auto maxValue = Vec::expand(0.0f);
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        // All oversampled phases of this input sample at once
+        const float *newest = history + historyLength + n;
+        auto accumulator = Vec::expand(0.0f);
+
+        for (int tap = 0; tap < TAPS_PER_PHASE; ++tap)
+            accumulator += Vec::fromRawArray(truePeakTable.data() + tap * Vec::SIMDNumElements) * Vec::expand(newest[-tap]);
+
+        maxValue = Vec::max(maxValue, Vec::abs(accumulator));
+    }
+
+    // Keep the tail for the next block
+    std::memmove(history, history + numSamples, sizeof(float) * static_cast<size_t>(historyLength));
+
+    float result = 0.0f;
+    for (size_t lane = 0; lane < Vec::SIMDNumElements; ++lane)
+        result = juce::jmax(result, maxValue.get(lane));
+
+    return result;
+}
+
+//==============================================================================
+void MeterEngine::process(const juce::AudioBuffer<float> &buffer, int numSamples)
+{
+    const int numChannels = juce::jmin(NUM_CHANNELS, buffer.getNumChannels());
+    numSamples = juce::jmin(numSamples, buffer.getNumSamples());
+
+    if (numChannels == 0 || numSamples <= 0 || weighted.getNumSamples() == 0)
+        return;
+
+    // Peaks are over the whole block, however many chunks it takes
+    snapshot.peak.fill(0.0f);
+    snapshot.truePeak.fill(0.0f);
+
+    // A host may send more than it prepared for; the scratch space is measured out a chunk at a time
+    for (int start = 0; start < numSamples; start += weighted.getNumSamples())
+        processChunk(buffer, numChannels, start, juce::jmin(numSamples - start, weighted.getNumSamples()));
+
+    // Mono output is shown on both meters
+    if (numChannels == 1)
+    {
+        snapshot.peak[1] = snapshot.peak[0];
+        snapshot.peakHold[1] = snapshot.peakHold[0];
+        snapshot.rms[1] = snapshot.rms[0];
+        snapshot.truePeak[1] = snapshot.truePeak[0];
+    }
+}
+
+void MeterEngine::processChunk(const juce::AudioBuffer<float> &buffer, int numChannels, int startSample, int numSamples)
+{
+    const float holdDecay = std::pow(peakHoldDecayPerSample, static_cast<float>(numSamples));
+    const float rmsCoefficient = static_cast<float>(std::exp(-numSamples / (rmsSmoothingTimeSeconds * sampleRate)));
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const float *data = buffer.getReadPointer(channel, startSample);
+        const size_t c = static_cast<size_t>(channel);
+
+        // Sample peak with hold
+        const float peak = findPeak(data, numSamples);
+        snapshot.peak[c] = juce::jmax(snapshot.peak[c], peak);
+
+        if (peak >= snapshot.peakHold[c])
+        {
+            snapshot.peakHold[c] = peak;
+            peakHoldSamplesLeft[c] = peakHoldTimeSamples;
+        }
+        else if (peakHoldSamplesLeft[c] > 0)
+        {
+            peakHoldSamplesLeft[c] -= numSamples;
+        }
+        else
+        {
+            snapshot.peakHold[c] = juce::jmax(peak, snapshot.peakHold[c] * holdDecay);
+        }
+
+        // Smoothed RMS
+        const float blockRms = std::sqrt(sumOfSquares(data, numSamples) / static_cast<float>(numSamples));
+        rmsState[c] = blockRms + rmsCoefficient * (rmsState[c] - blockRms);
+        snapshot.rms[c] = rmsState[c];
+
+        snapshot.truePeak[c] = juce::jmax(snapshot.truePeak[c], processTruePeak(channel, data, numSamples));
+
+        // K-weighted copy for loudness
+        float *weightedData = weighted.getWritePointer(channel);
+        shelfFilters[c].process(data, weightedData, numSamples);
+        highPassFilters[c].process(weightedData, weightedData, numSamples);
+    }
+
+    // Accumulate energy into 100ms gating steps
+    int position = 0;
+
+    while (position < numSamples)
+    {
+        const int count = juce::jmin(numSamples - position, stepLengthSamples - stepSamplesDone);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            stepEnergy += sumOfSquares(weighted.getReadPointer(channel, position), count);
+
+        stepSamplesDone += count;
+        position += count;
+
+        if (stepSamplesDone >= stepLengthSamples)
+            finishStep();
+    }
+}
+
+void MeterEngine::finishStep()
+{
+    stepHistory[static_cast<size_t>(stepHistoryIndex)] = stepEnergy / stepLengthSamples;
+    stepHistoryIndex = (stepHistoryIndex + 1) % STEPS_PER_SHORT_TERM;
+    stepsSeen++;
+
+    stepEnergy = 0.0;
+    stepSamplesDone = 0;
+
+    // Average the most recent steps
+    auto meanOfLastSteps = [this](int count)
+    {
+        count = juce::jmin(count, stepsSeen);
+        double sum = 0.0;
+
+        for (int i = 1; i <= count; ++i)
+            sum += stepHistory[static_cast<size_t>((stepHistoryIndex - i + STEPS_PER_SHORT_TERM) % STEPS_PER_SHORT_TERM)];
+
+        return sum / juce::jmax(1, count);
+    };
+
+    const double momentaryEnergy = meanOfLastSteps(STEPS_PER_MOMENTARY);
+    snapshot.momentaryLufs = energyToLufs(momentaryEnergy);
+    snapshot.shortTermLufs = energyToLufs(meanOfLastSteps(STEPS_PER_SHORT_TERM));
+
+    // Every complete 400ms block (75% overlap) feeds the integrated measurement
+    if (stepsSeen >= STEPS_PER_MOMENTARY && snapshot.momentaryLufs >= HISTOGRAM_MIN_LUFS)
+    {
+        const int bin = juce::jlimit(0, HISTOGRAM_BINS - 1,
+                                     static_cast<int>((snapshot.momentaryLufs - HISTOGRAM_MIN_LUFS) / HISTOGRAM_BIN_LU));
+        histogramCounts[static_cast<size_t>(bin)]++;
+        histogramEnergy[static_cast<size_t>(bin)] += momentaryEnergy;
+
+        updateIntegrated();
+    }
+}
+
+void MeterEngine::updateIntegrated()
+{
+    // Blocks above the absolute gate
+    double totalEnergy = 0.0;
+    int totalCount = 0;
+
+    for (int bin = 0; bin < HISTOGRAM_BINS; ++bin)
+    {
+        totalEnergy += histogramEnergy[static_cast<size_t>(bin)];
+        totalCount += histogramCounts[static_cast<size_t>(bin)];
+    }
+
+    if (totalCount == 0)
+        return;
+
+    // Relative gate 10 LU below the absolute-gated loudness
+    const float relativeGate = energyToLufs(totalEnergy / totalCount) - 10.0f;
+    const int firstBin = juce::jlimit(0, HISTOGRAM_BINS - 1,
+                                      static_cast<int>(std::ceil((relativeGate - HISTOGRAM_MIN_LUFS) / HISTOGRAM_BIN_LU)));
+
+    double gatedEnergy = 0.0;
+    int gatedCount = 0;
+
+    for (int bin = firstBin; bin < HISTOGRAM_BINS; ++bin)
+    {
+        gatedEnergy += histogramEnergy[static_cast<size_t>(bin)];
+        gatedCount += histogramCounts[static_cast<size_t>(bin)];
+    }
+
+    if (gatedCount > 0)
+        snapshot.integratedLufs = energyToLufs(gatedEnergy / gatedCount);
+}
+
+float MeterEngine::energyToLufs(double meanSquare)
+{
+    if (meanSquare <= 1.0e-10)
+        return MeterSnapshot::SILENCE_LUFS;
+
+    return juce::jmax(MeterSnapshot::SILENCE_LUFS, static_cast<float>(-0.691 + 10.0 * std::log10(meanSquare)));
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Everything the meters show, computed on the audio thread once per block
+struct MeterSnapshot
+{
+    static constexpr float SILENCE_LUFS = -100.0f;
+
+    // Per-channel linear values (left, right)
+    std::array<float, 2> peak{};     // sample peak of the last block
+    std::array<float, 2> peakHold{}; // held sample peak with a slow decay
+    std::array<float, 2> truePeak{}; // 4x oversampled peak of the last block
+    std::array<float, 2> rms{};      // smoothed RMS level
+
+    // Loudness per ITU-R BS.1770 / EBU R128
+    float momentaryLufs = SILENCE_LUFS;  // 400ms window
+    float shortTermLufs = SILENCE_LUFS;  // 3s window
+    float integratedLufs = SILENCE_LUFS; // gated, since the last reset
+};
+
+// Sample peak, true-peak, RMS and LUFS metering for up to two channels.
+// process() runs on the audio thread with no allocation; prepare() sizes all scratch space.
+class MeterEngine
+{
+public:
+    MeterEngine();
+
+    void prepare(double sampleRate, int maximumBlockSize);
+    void reset();
+
+    // Restart integrated loudness measurement
+    void resetIntegrated();
+
+    // Measure one block of output, of any length
+    void process(const juce::AudioBuffer<float> &buffer, int numSamples);
+
+    // Latest measurements (audio thread, publish through the telemetry channel)
+    const MeterSnapshot &getSnapshot() const { return snapshot; }
+
+    //==============================================================================
+    // SIMD kernels, public so they can be benchmarked against scalar versions
+    static float findPeak(const float *data, int numSamples);
+    static float sumOfSquares(const float *data, int numSamples);
+
+private:
+    using Vec = juce::dsp::SIMDRegister<float>;
+
+    static constexpr int NUM_CHANNELS = 2;
+
+    // True-peak interpolator: 4x oversampling with a 48 tap polyphase FIR
+    static constexpr int OVERSAMPLING = 4;
+    static constexpr int TAPS_PER_PHASE = 12;
+
+    // Loudness gating: 100ms steps, 400ms momentary blocks, 3s short-term window
+    static constexpr int STEPS_PER_MOMENTARY = 4;
+    static constexpr int STEPS_PER_SHORT_TERM = 30;
+
+    // Integrated loudness histogram, 0.1 LU bins from -70 LUFS to +10 LUFS
+    static constexpr float HISTOGRAM_MIN_LUFS = -70.0f;
+    static constexpr float HISTOGRAM_BIN_LU = 0.1f;
+    static constexpr int HISTOGRAM_BINS = 800;
+
+    struct Biquad
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+        double z1 = 0.0, z2 = 0.0;
+
+        void process(const float *input, float *output, int numSamples);
+        void reset() { z1 = z2 = 0.0; }
+    };
+
+    double sampleRate = 44100.0;
+    MeterSnapshot snapshot;
+
+    // Peak hold and RMS ballistics
+    std::array<int, NUM_CHANNELS> peakHoldSamplesLeft{};
+    float peakHoldDecayPerSample = 0.0f;
+    int peakHoldTimeSamples = 0;
+    float rmsSmoothingTimeSeconds = 0.1f;
+    std::array<float, NUM_CHANNELS> rmsState{};
+
+    // True peak
+    alignas(sizeof(Vec)) std::array<float, TAPS_PER_PHASE * Vec::SIMDNumElements> truePeakTable{};
+    juce::AudioBuffer<float> truePeakHistory; // TAPS_PER_PHASE - 1 previous samples + current block
+
+    // K-weighting
+    std::array<Biquad, NUM_CHANNELS> shelfFilters, highPassFilters;
+    juce::AudioBuffer<float> weighted;
+
+    // 100ms gating steps
+    int stepLengthSamples = 4410;
+    int stepSamplesDone = 0;
+    double stepEnergy = 0.0;
+    std::array<double, STEPS_PER_SHORT_TERM> stepHistory{};
+    int stepHistoryIndex = 0;
+    int stepsSeen = 0;
+
+    // Integrated loudness
+    std::array<int, HISTOGRAM_BINS> histogramCounts{};
+    std::array<double, HISTOGRAM_BINS> histogramEnergy{};
+
+    // Up to the prepared block size of the buffer, from startSample
+    void processChunk(const juce::AudioBuffer<float> &buffer, int numChannels, int startSample, int numSamples);
+
+    void designTruePeakFilter();
+    void designKWeighting();
+    float processTruePeak(int channel, const float *data, int numSamples);
+    void finishStep();
+    void updateIntegrated();
+
+    static float energyToLufs(double meanSquare);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MeterEngine)
+};
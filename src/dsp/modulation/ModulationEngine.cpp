@@ -0,0 +1,148 @@
+#include "ModulationEngine.h"
+
+ModulationEngine::ModulationEngine()
+{
+    prepare(sampleRate, 512);
+}
+
+void ModulationEngine::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+
+    for (auto &values : lfoValues)
+        values.assign(static_cast<size_t>(juce::jmax(1, maximumBlockSize) / CONTROL_INTERVAL + 2), 0.0f);
+
+    reset();
+}
+
+void ModulationEngine::reset()
+{
+    phases.fill(0.0);
+    masterBend = 0.0f;
+    lastNote = -1;
+    numControlPoints = 0;
+
+    for (auto &values : lfoValues)
+        std::fill(values.begin(), values.end(), 0.0f);
+}
+
+void ModulationEngine::beginBlock(int numSamples)
+{
+    numControlPoints = numSamples / CONTROL_INTERVAL + 2;
+
+    for (int l = 0; l < ModulationParameters::NUM_LFOS; ++l)
+    {
+        const auto &lfo = parameters.lfos[static_cast<size_t>(l)];
+        auto &values = lfoValues[static_cast<size_t>(l)];
+        auto &phase = phases[static_cast<size_t>(l)];
+
+        // Hosts may send more than they announced; growing here is the rare exception
+        if (static_cast<int>(values.size()) < numControlPoints)
+            values.resize(static_cast<size_t>(numControlPoints));
+
+        const double increment = juce::jlimit(0.0, 100.0, static_cast<double>(lfo.rateHz)) / sampleRate;
+
+        for (int point = 0; point < numControlPoints; ++point)
+        {
+            const double pointPhase = phase + increment * point * CONTROL_INTERVAL;
+            values[static_cast<size_t>(point)] = lfoShape(lfo.shape, pointPhase - std::floor(pointPhase));
+        }
+
+        phase += increment * numSamples;
+        phase -= std::floor(phase);
+    }
+}
+
+void ModulationEngine::startNote(NoteModulation &note, int midiNoteNumber, int channel, int pitchWheelPosition)
+{
+    note.channel = channel;
+    note.bend = (pitchWheelPosition - 8192) / 8192.0f;
+    note.pressure = 0.0f;
+    note.timbre = 0.5f;
+    note.glideSemitones = 0.0f;
+    note.glideRate = 0.0f;
+
+    // Glide from wherever the previous note was played
+    if (parameters.glideMs > 0.0f && lastNote >= 0 && lastNote != midiNoteNumber)
+    {
+        note.glideSemitones = static_cast<float>(lastNote - midiNoteNumber);
+        note.glideRate = std::abs(note.glideSemitones) / static_cast<float>(parameters.glideMs * sampleRate / 1000.0);
+    }
+
+    lastNote = midiNoteNumber;
+}
+
+void ModulationEngine::advance(NoteModulation &note, int numSamples) const
+{
+    if (note.glideSemitones == 0.0f)
+        return;
+
+    const float distance = note.glideRate * numSamples;
+
+    if (std::abs(note.glideSemitones) <= distance)
+        note.glideSemitones = 0.0f;
+    else
+        note.glideSemitones -= std::copysign(distance, note.glideSemitones);
+}
+
+ModulationEngine::Targets ModulationEngine::evaluate(const NoteModulation &note, int controlPoint) const
+{
+    float semitones = note.glideSemitones;
+
+    // In MPE mode the master channel bends everything, and each note's own channel bends just that note
+    if (parameters.mpeEnabled)
+    {
+        semitones += masterBend * parameters.pitchBendRange;
+
+        if (note.channel != 1)
+            semitones += note.bend * parameters.mpeBendRange;
+    }
+    else
+    {
+        semitones += note.bend * parameters.pitchBendRange;
+    }
+
+    float gain = 1.0f - juce::jlimit(0.0f, 1.0f, parameters.pressureToVolume) * (1.0f - note.pressure);
+
+    const int point = juce::jlimit(0, juce::jmax(0, numControlPoints - 1), controlPoint);
+
+    for (int l = 0; l < ModulationParameters::NUM_LFOS; ++l)
+    {
+        const auto &lfo = parameters.lfos[static_cast<size_t>(l)];
+
+        if (lfo.depth == 0.0f || numControlPoints == 0)
+            continue;
+
+        const float value = lfoValues[static_cast<size_t>(l)][static_cast<size_t>(point)];
+
+        if (lfo.target == ModulationParameters::LfoTarget::pitch)
+            semitones += lfo.depth * value;
+        else
+            gain *= 1.0f - juce::jlimit(0.0f, 1.0f, lfo.depth) * 0.5f * (1.0f + value);
+    }
+
+    Targets targets;
+    targets.pitchRatio = std::exp2(semitones / 12.0);
+    targets.gain = gain;
+    return targets;
+}
+
+float ModulationEngine::getCutoffOffset(const NoteModulation &note) const
+{
+    return parameters.timbreToCutoff * (note.timbre - 0.5f) * 2.0f;
+}
+
+float ModulationEngine::lfoShape(ModulationParameters::LfoShape shape, double phase)
+{
+    switch (shape)
+    {
+    case ModulationParameters::LfoShape::triangle:
+        return static_cast<float>(1.0 - 4.0 * std::abs(phase - 0.5));
+    case ModulationParameters::LfoShape::saw:
+        return static_cast<float>(2.0 * phase - 1.0);
+    case ModulationParameters::LfoShape::square:
+        return phase < 0.5 ? 1.0f : -1.0f;
+    default:
+        return static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * phase));
+    }
+}
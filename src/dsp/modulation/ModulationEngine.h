@@ -0,0 +1,107 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Performance controls and LFO settings shared by every voice
+struct ModulationParameters
+{
+    enum class LfoShape
+    {
+        sine,
+        triangle,
+        saw,
+        square
+    };
+
+    enum class LfoTarget
+    {
+        pitch,  // depth in semitones
+        volume  // depth 0..1, tremolo down from full level
+    };
+
+    struct Lfo
+    {
+        float rateHz = 5.0f;
+        float depth = 0.0f;
+        LfoShape shape = LfoShape::sine;
+        LfoTarget target = LfoTarget::pitch;
+    };
+
+    static constexpr int NUM_LFOS = 2;
+
+    float pitchBendRange = 2.0f;    // semitones at full bend (MPE: the master channel)
+    bool mpeEnabled = false;        // channel 1 is the master channel, each note bends on its own channel
+    float mpeBendRange = 48.0f;     // per-note bend range in MPE mode
+    float glideMs = 0.0f;           // portamento from the previous note, 0 for none
+    float pressureToVolume = 0.0f;  // 0..1: how far the level drops with no pressure
+    float timbreToCutoff = 0.0f;    // filter cutoff offset in octaves at full timbre (CC74), centred on 64
+    std::array<Lfo, NUM_LFOS> lfos;
+};
+
+// What one voice has been sent since its note started (audio thread)
+struct NoteModulation
+{
+    int channel = 1;
+    float bend = 0.0f;         // -1..1 on the note's channel
+    float pressure = 0.0f;     // 0..1, channel pressure or polyphonic aftertouch
+    float timbre = 0.5f;       // 0..1, CC74
+    float glideSemitones = 0.0f;
+    float glideRate = 0.0f;    // semitones per sample towards 0
+};
+
+// Turns performance controls and LFOs into pitch and level for each voice, at control rate.
+// LFOs run free and are evaluated once per CONTROL_INTERVAL at the start of each block;
+// voices ramp linearly between those points, so modulation costs almost nothing per sample.
+class ModulationEngine
+{
+public:
+    static constexpr int CONTROL_INTERVAL = 32;
+
+    // Modulation for one voice at one control point
+    struct Targets
+    {
+        double pitchRatio = 1.0;
+        float gain = 1.0f;
+    };
+
+    ModulationEngine();
+
+    void prepare(double sampleRate, int maximumBlockSize);
+    void reset();
+
+    void setParameters(const ModulationParameters &newParameters) { parameters = newParameters; }
+    const ModulationParameters &getParameters() const { return parameters; }
+
+    // Master channel pitch bend in MPE mode, -1..1
+    void setMasterBend(float newBend) { masterBend = newBend; }
+
+    // Evaluate the LFOs for every control point of the coming block (audio thread)
+    void beginBlock(int numSamples);
+
+    // Set up a new note: channel, initial bend and glide from the previous note
+    void startNote(NoteModulation &note, int midiNoteNumber, int channel, int pitchWheelPosition);
+
+    // Move a note's glide on by a number of samples
+    void advance(NoteModulation &note, int numSamples) const;
+
+    // Pitch and level for a note at a control point of the current block
+    Targets evaluate(const NoteModulation &note, int controlPoint) const;
+
+    // Filter cutoff offset in octaves for a note
+    float getCutoffOffset(const NoteModulation &note) const;
+
+private:
+    double sampleRate = 44100.0;
+    ModulationParameters parameters;
+    float masterBend = 0.0f;
+    int lastNote = -1;
+
+    // LFO phases (0..1) and their values at each control point of the current block
+    std::array<double, ModulationParameters::NUM_LFOS> phases{};
+    std::array<std::vector<float>, ModulationParameters::NUM_LFOS> lfoValues;
+    int numControlPoints = 0;
+
+    static float lfoShape(ModulationParameters::LfoShape shape, double phase);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ModulationEngine)
+};
@@ -0,0 +1,329 @@
+#include "ConvolutionReverb.h"
+
+namespace
+{
+    // Resample an impulse response to the processing rate, cap its length and normalise it to unit energy
+    juce::AudioBuffer<float> prepareImpulse(const juce::AudioBuffer<float> &source, double sourceRate, double targetRate)
+    {
+        const int numChannels = juce::jmin(source.getNumChannels(), ConvolutionReverb::NUM_CHANNELS);
+        const double ratio = sourceRate > 0.0 ? sourceRate / targetRate : 1.0;
+        const int length = juce::jmin(static_cast<int>(source.getNumSamples() / ratio),
+                                      static_cast<int>(ConvolutionReverb::MAX_IMPULSE_SECONDS * targetRate));
+
+        juce::AudioBuffer<float> impulse(numChannels, juce::jmax(0, length));
+
+        if (length <= 0)
+            return impulse;
+
+        if (ratio == 1.0)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                impulse.copyFrom(channel, 0, source, channel, 0, length);
+        }
+        else
+        {
+            // Pad the source so the interpolator never reads past its end
+            juce::AudioBuffer<float> padded(numChannels, source.getNumSamples() + 8);
+            padded.clear();
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                padded.copyFrom(channel, 0, source, channel, 0, source.getNumSamples());
+
+                juce::LagrangeInterpolator interpolator;
+                interpolator.process(ratio, padded.getReadPointer(channel), impulse.getWritePointer(channel), length);
+            }
+        }
+
+        double energy = 0.0;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float *data = impulse.getReadPointer(channel);
+
+            for (int i = 0; i < length; ++i)
+                energy += static_cast<double>(data[i]) * data[i];
+        }
+
+        energy /= numChannels;
+
+        if (energy > 0.0)
+            impulse.applyGain(static_cast<float>(1.0 / std::sqrt(energy)));
+
+        return impulse;
+    }
+}
+
+//==============================================================================
+// All the state for one impulse response at one sample rate. Replaced as a whole when either changes.
+class ConvolutionReverb::Engine : private juce::Thread
+{
+public:
+    explicit Engine(const juce::AudioBuffer<float> &impulse)
+        : juce::Thread("Reverb tail")
+    {
+        const int length = impulse.getNumSamples();
+        directLength = juce::jmin(HEAD_BLOCK, length);
+        hasTail = length > TAIL_OFFSET;
+
+        for (int c = 0; c < NUM_CHANNELS; ++c)
+        {
+            auto &channel = channels[static_cast<size_t>(c)];
+            const float *response = impulse.getReadPointer(juce::jmin(c, impulse.getNumChannels() - 1));
+
+            channel.direct.assign(HEAD_BLOCK, 0.0f);
+            std::copy(response, response + directLength, channel.direct.begin());
+            channel.history.assign(HEAD_BLOCK * 2 - 1, 0.0f);
+
+            channel.head.prepare(HEAD_BLOCK, response + directLength, juce::jmin(length, TAIL_OFFSET) - directLength);
+            channel.headOutput.assign(HEAD_BLOCK, 0.0f);
+
+            if (hasTail)
+            {
+                channel.tail.prepare(TAIL_BLOCK, response + TAIL_OFFSET, length - TAIL_OFFSET);
+
+                for (auto &slot : channel.tailInput)
+                    slot.assign(TAIL_BLOCK, 0.0f);
+                for (auto &slot : channel.tailOutput)
+                    slot.assign(TAIL_BLOCK, 0.0f);
+            }
+        }
+
+        if (hasTail)
+            startThread(juce::Thread::Priority::high);
+    }
+
+    ~Engine() override
+    {
+        stopThread(1000);
+    }
+
+    // Convolve the input into the wet buffer; returns true if a tail block arrived late (audio thread)
+    bool process(const juce::AudioBuffer<float> &input, juce::AudioBuffer<float> &wet, int numSamples)
+    {
+        const int numInputChannels = input.getNumChannels();
+        const int numWetChannels = juce::jmin(wet.getNumChannels(), NUM_CHANNELS);
+        bool missed = false;
+
+        // Segments never cross a head block boundary, and tail blocks are whole head blocks
+        for (int done = 0; done < numSamples;)
+        {
+            const int count = juce::jmin(numSamples - done, HEAD_BLOCK - headPosition);
+            const auto tailSlot = static_cast<size_t>(tailBlock % TAIL_SLOTS);
+
+            for (int c = 0; c < NUM_CHANNELS; ++c)
+            {
+                auto &channel = channels[static_cast<size_t>(c)];
+                const float *in = input.getReadPointer(juce::jmin(c, numInputChannels - 1), done);
+
+                float *history = channel.history.data() + HEAD_BLOCK - 1 + headPosition;
+                std::copy(in, in + count, history);
+
+                if (hasTail)
+                    std::copy(in, in + count, channel.tailInput[tailSlot].data() + tailPosition);
+
+                if (c >= numWetChannels)
+                    continue;
+
+                // Direct taps, one vector pass per tap
+                float *out = wet.getWritePointer(c, done);
+                juce::FloatVectorOperations::multiply(out, history, channel.direct[0], count);
+
+                for (int tap = 1; tap < directLength; ++tap)
+                    juce::FloatVectorOperations::addWithMultiply(out, history - tap, channel.direct[static_cast<size_t>(tap)], count);
+
+                juce::FloatVectorOperations::add(out, channel.headOutput.data() + headPosition, count);
+
+                if (tailReady)
+                    juce::FloatVectorOperations::add(out, channel.tailOutput[tailSlot].data() + tailPosition, count);
+            }
+
+            done += count;
+            headPosition += count;
+            tailPosition += count;
+
+            if (headPosition == HEAD_BLOCK)
+            {
+                // The head partitions start one block in, so this block's result plays next block
+                for (auto &channel : channels)
+                {
+                    channel.head.process(channel.history.data() + HEAD_BLOCK - 1, channel.headOutput.data());
+                    std::copy(channel.history.begin() + HEAD_BLOCK, channel.history.end(), channel.history.begin());
+                }
+
+                headPosition = 0;
+            }
+
+            if (tailPosition == TAIL_BLOCK)
+            {
+                if (hasTail)
+                {
+                    tailSubmitted.store(tailBlock, std::memory_order_release);
+                    notify();
+                }
+
+                tailPosition = 0;
+                ++tailBlock;
+
+                // The block about to play was convolved from the input two blocks back
+                const auto source = tailBlock - 2;
+                tailReady = hasTail && source >= 0 && tailCompleted.load(std::memory_order_acquire) >= source;
+                missed = missed || (hasTail && source >= 0 && !tailReady);
+            }
+        }
+
+        return missed;
+    }
+
+private:
+    static constexpr int TAIL_SLOTS = 3;
+
+    struct Channel
+    {
+        std::vector<float> direct;     // the first HEAD_BLOCK taps
+        std::vector<float> history;    // the last HEAD_BLOCK - 1 inputs, then the current head block
+        UniformConvolver head;
+        std::vector<float> headOutput; // head partitions' output for the current head block
+        UniformConvolver tail;
+        std::array<std::vector<float>, TAIL_SLOTS> tailInput, tailOutput;
+    };
+
+    std::array<Channel, NUM_CHANNELS> channels;
+    int directLength = 0;
+    bool hasTail = false;
+
+    // Audio thread position
+    int headPosition = 0;
+    int tailPosition = 0;
+    juce::int64 tailBlock = 0;
+    bool tailReady = false;
+
+    // Hand-over between the audio thread and the tail thread
+    std::atomic<juce::int64> tailSubmitted{-1};
+    std::atomic<juce::int64> tailCompleted{-1};
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            wait(100);
+
+            for (auto next = tailCompleted.load() + 1; next <= tailSubmitted.load(std::memory_order_acquire); ++next)
+            {
+                const auto inputSlot = static_cast<size_t>(next % TAIL_SLOTS);
+                const auto outputSlot = static_cast<size_t>((next + 2) % TAIL_SLOTS);
+
+                for (auto &channel : channels)
+                    channel.tail.process(channel.tailInput[inputSlot].data(), channel.tailOutput[outputSlot].data());
+
+                tailCompleted.store(next, std::memory_order_release);
+            }
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Engine)
+};
+
+//==============================================================================
+ConvolutionReverb::ConvolutionReverb()
+{
+    wetBuffer.setSize(NUM_CHANNELS, 512);
+}
+
+ConvolutionReverb::~ConvolutionReverb()
+{
+}
+
+void ConvolutionReverb::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    wetBuffer.setSize(NUM_CHANNELS, juce::jmax(1, maximumBlockSize), false, true, true);
+    tailMisses = 0;
+
+    rebuildEngine();
+}
+
+void ConvolutionReverb::setImpulseResponse(const juce::AudioBuffer<float> &impulse, double impulseSampleRate, const juce::String &name)
+{
+    {
+        const juce::ScopedLock lock(impulseLock);
+        impulseSource.makeCopyOf(impulse);
+        impulseSourceRate = impulseSampleRate;
+        impulseName = name;
+    }
+
+    rebuildEngine();
+}
+
+void ConvolutionReverb::clearImpulseResponse()
+{
+    {
+        const juce::ScopedLock lock(impulseLock);
+        impulseSource.setSize(0, 0);
+        impulseName.clear();
+    }
+
+    rebuildEngine();
+}
+
+juce::String ConvolutionReverb::getImpulseName() const
+{
+    const juce::ScopedLock lock(impulseLock);
+    return impulseName;
+}
+
+void ConvolutionReverb::rebuildEngine()
+{
+    std::unique_ptr<Engine> newEngine;
+    double newTailSeconds = 0.0;
+
+    {
+        const juce::ScopedLock lock(impulseLock);
+
+        if (impulseSource.getNumChannels() > 0 && impulseSource.getNumSamples() > 0)
+        {
+            auto impulse = prepareImpulse(impulseSource, impulseSourceRate, sampleRate);
+
+            if (impulse.getNumSamples() > 0)
+            {
+                newTailSeconds = impulse.getNumSamples() / sampleRate;
+                newEngine = std::make_unique<Engine>(impulse);
+            }
+        }
+    }
+
+    {
+        const juce::SpinLock::ScopedLockType lock(engineLock);
+        std::swap(engine, newEngine);
+    }
+
+    tailSeconds = newTailSeconds;
+
+    // The old engine and its thread are released here, never on the audio thread
+}
+
+void ConvolutionReverb::process(juce::AudioBuffer<float> &buffer, int numSamples)
+{
+    const juce::SpinLock::ScopedTryLockType lock(engineLock);
+
+    // Nothing loaded, or a new impulse response is being swapped in right now: stay dry
+    if (!lock.isLocked() || engine == nullptr || buffer.getNumChannels() == 0)
+        return;
+
+    // Hosts may send more than they announced; growing here is the rare exception
+    if (wetBuffer.getNumSamples() < numSamples)
+        wetBuffer.setSize(NUM_CHANNELS, numSamples, false, false, true);
+
+    if (engine->process(buffer, wetBuffer, numSamples))
+        ++tailMisses;
+
+    const float targetMix = mix.load();
+
+    for (int channel = 0; channel < juce::jmin(buffer.getNumChannels(), NUM_CHANNELS); ++channel)
+    {
+        buffer.applyGainRamp(channel, 0, numSamples, 1.0f - lastMix, 1.0f - targetMix);
+        buffer.addFromWithRamp(channel, 0, wetBuffer.getReadPointer(channel), numSamples, lastMix, targetMix);
+    }
+
+    lastMix = targetMix;
+}
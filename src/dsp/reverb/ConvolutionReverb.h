@@ -0,0 +1,68 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "UniformConvolver.h"
+
+// Stereo convolution reverb insert with no added latency.
+// The impulse response is split three ways: the first HEAD_BLOCK taps are applied directly,
+// the rest of the early part in HEAD_BLOCK partitions on the audio thread, and everything from
+// TAIL_OFFSET onwards in TAIL_BLOCK partitions on a background thread, which has one whole tail
+// block of time to deliver each result. process() neither allocates nor blocks.
+class ConvolutionReverb
+{
+public:
+    static constexpr int NUM_CHANNELS = 2;
+    static constexpr int HEAD_BLOCK = 128;
+    static constexpr int TAIL_BLOCK = 4096;
+    static constexpr int TAIL_OFFSET = 2 * TAIL_BLOCK;
+    static constexpr double MAX_IMPULSE_SECONDS = 20.0;
+
+    ConvolutionReverb();
+    ~ConvolutionReverb();
+
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    // Build the convolution for an impulse response and swap it in (message thread).
+    // The response is resampled to the processing rate and normalised to unit energy.
+    void setImpulseResponse(const juce::AudioBuffer<float> &impulse, double impulseSampleRate, const juce::String &name);
+    void clearImpulseResponse();
+
+    juce::String getImpulseName() const;
+    bool hasImpulseResponse() const { return tailSeconds.load() > 0.0; }
+
+    // Wet amount, 0 (dry) to 1 (wet only)
+    void setMix(float newMix) { mix = juce::jlimit(0.0f, 1.0f, newMix); }
+    float getMix() const { return mix.load(); }
+
+    // Length of the loaded impulse response
+    double getTailLengthSeconds() const { return tailSeconds.load(); }
+
+    // Mix the reverb into the buffer (audio thread)
+    void process(juce::AudioBuffer<float> &buffer, int numSamples);
+
+    // Tail blocks the background thread did not deliver in time (audio thread)
+    int getNumTailMisses() const { return tailMisses; }
+
+private:
+    class Engine;
+
+    std::unique_ptr<Engine> engine;
+    juce::SpinLock engineLock; // held by the audio thread while processing, and for the swap
+
+    // The impulse response as loaded, kept so a new sample rate can rebuild the engine
+    juce::CriticalSection impulseLock;
+    juce::AudioBuffer<float> impulseSource;
+    double impulseSourceRate = 0.0;
+    juce::String impulseName;
+
+    double sampleRate = 44100.0;
+    juce::AudioBuffer<float> wetBuffer;
+    std::atomic<float> mix{0.25f};
+    float lastMix = 0.25f;
+    std::atomic<double> tailSeconds{0.0};
+    int tailMisses = 0;
+
+    void rebuildEngine();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConvolutionReverb)
+};
@@ -0,0 +1,92 @@
+#include "UniformConvolver.h"
+
+void UniformConvolver::prepare(int newBlockSize, const float *impulse, int impulseLength)
+{
+    jassert(juce::isPowerOfTwo(newBlockSize));
+
+    blockSize = newBlockSize;
+    fftSize = blockSize * 2;
+    spectrumSize = fftSize + 2;
+    numPartitions = impulseLength > 0 ? (impulseLength + blockSize - 1) / blockSize : 0;
+
+    fft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(fftSize)));
+
+    work.assign(static_cast<size_t>(fftSize * 2), 0.0f);
+    accumulator.assign(static_cast<size_t>(spectrumSize), 0.0f);
+    inputWindow.assign(static_cast<size_t>(fftSize), 0.0f);
+    delayLine.assign(static_cast<size_t>(numPartitions * spectrumSize), 0.0f);
+    partitions.assign(static_cast<size_t>(numPartitions * spectrumSize), 0.0f);
+    delayLineHead = 0;
+
+    // Round trip of an impulse gives the scale of forward + inverse, whatever the FFT backend
+    std::fill(work.begin(), work.end(), 0.0f);
+    work[0] = 1.0f;
+    fft->performRealOnlyForwardTransform(work.data(), true);
+    fft->performRealOnlyInverseTransform(work.data());
+    const float scale = work[0] != 0.0f ? 1.0f / work[0] : 1.0f;
+
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        const int offset = p * blockSize;
+        const int length = juce::jmin(blockSize, impulseLength - offset);
+
+        std::fill(work.begin(), work.end(), 0.0f);
+        for (int i = 0; i < length; ++i)
+            work[static_cast<size_t>(i)] = impulse[offset + i] * scale;
+
+        fft->performRealOnlyForwardTransform(work.data(), true);
+        std::copy(work.begin(), work.begin() + spectrumSize, partitions.begin() + p * spectrumSize);
+    }
+}
+
+void UniformConvolver::reset()
+{
+    std::fill(inputWindow.begin(), inputWindow.end(), 0.0f);
+    std::fill(delayLine.begin(), delayLine.end(), 0.0f);
+    delayLineHead = 0;
+}
+
+void UniformConvolver::process(const float *input, float *output)
+{
+    if (numPartitions == 0)
+    {
+        std::fill(output, output + blockSize, 0.0f);
+        return;
+    }
+
+    // Slide the input window along by one block
+    std::copy(inputWindow.begin() + blockSize, inputWindow.end(), inputWindow.begin());
+    std::copy(input, input + blockSize, inputWindow.begin() + blockSize);
+
+    // Transform it into the newest slot of the frequency-domain delay line
+    std::copy(inputWindow.begin(), inputWindow.end(), work.begin());
+    std::fill(work.begin() + fftSize, work.end(), 0.0f);
+    fft->performRealOnlyForwardTransform(work.data(), true);
+
+    delayLineHead = delayLineHead == 0 ? numPartitions - 1 : delayLineHead - 1;
+    std::copy(work.begin(), work.begin() + spectrumSize, delayLine.begin() + delayLineHead * spectrumSize);
+
+    // Multiply-accumulate every partition with the input spectrum it lines up with
+    std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+    float *sum = accumulator.data();
+
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        const int slot = (delayLineHead + p) % numPartitions;
+        const float *x = delayLine.data() + slot * spectrumSize;
+        const float *h = partitions.data() + p * spectrumSize;
+
+        for (int i = 0; i < spectrumSize; i += 2)
+        {
+            sum[i] += x[i] * h[i] - x[i + 1] * h[i + 1];
+            sum[i + 1] += x[i] * h[i + 1] + x[i + 1] * h[i];
+        }
+    }
+
+    // Back to the time domain; overlap-save keeps the second half
+    std::copy(accumulator.begin(), accumulator.end(), work.begin());
+    std::fill(work.begin() + spectrumSize, work.end(), 0.0f);
+    fft->performRealOnlyInverseTransform(work.data());
+
+    std::copy(work.begin() + blockSize, work.begin() + fftSize, output);
+}
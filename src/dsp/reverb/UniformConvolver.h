@@ -0,0 +1,40 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Uniformly partitioned overlap-save convolution of one channel with one impulse response segment.
+// Each call to process() takes exactly one block of input and produces the convolution for the
+// same block; the caller decides how late to play it. prepare() allocates, process() does not.
+class UniformConvolver
+{
+public:
+    UniformConvolver() = default;
+
+    // Split the impulse response into partitions of blockSize (a power of two) and transform them
+    void prepare(int blockSize, const float *impulse, int impulseLength);
+    void reset();
+
+    // One block of input in, one block of output out
+    void process(const float *input, float *output);
+
+    int getBlockSize() const { return blockSize; }
+    int getNumPartitions() const { return numPartitions; }
+
+private:
+    int blockSize = 0;
+    int fftSize = 0;
+    int spectrumSize = 0; // interleaved complex values for bins 0..fftSize/2
+    int numPartitions = 0;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+
+    std::vector<float> partitions;    // numPartitions spectra, scaled for the inverse transform
+    std::vector<float> delayLine;     // numPartitions input spectra, newest at delayLineHead
+    int delayLineHead = 0;
+
+    std::vector<float> inputWindow;   // previous block then current block
+    std::vector<float> work;          // FFT work area, 2 * fftSize
+    std::vector<float> accumulator;   // summed spectrum
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(UniformConvolver)
+};
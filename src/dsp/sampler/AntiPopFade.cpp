@@ -0,0 +1,29 @@
+#include "AntiPopFade.h"
+
+const float *AntiPopFade::getRamp()
+{
+    static const auto ramp = []
+    {
+        std::array<float, FADE_SAMPLES> values{};
+
+        for (int i = 0; i < FADE_SAMPLES; ++i)
+            values[static_cast<size_t>(i)] = static_cast<float>(i) / FADE_SAMPLES;
+
+        return values;
+    }();
+
+    return ramp.data();
+}
+
+void AntiPopFade::apply(float *buffer, const float *previous, int numSamples)
+{
+    const int fadeSamples = juce::jmin(numSamples, FADE_SAMPLES);
+
+    if (fadeSamples <= 0)
+        return;
+
+    // buffer * alpha + previous * (1 - alpha) == previous + alpha * (buffer - previous)
+    juce::FloatVectorOperations::subtract(buffer, previous, fadeSamples);
+    juce::FloatVectorOperations::multiply(buffer, getRamp(), fadeSamples);
+    juce::FloatVectorOperations::add(buffer, previous, fadeSamples);
+}
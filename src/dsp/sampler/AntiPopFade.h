@@ -0,0 +1,18 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Short crossfade from the audio a monophonic voice was playing into the audio of the new note.
+// The fade curve is a fixed table, so applying it is three vector operations per channel.
+class AntiPopFade
+{
+public:
+    // 32 samples is about 0.7ms at 44.1kHz
+    static constexpr int FADE_SAMPLES = 32;
+
+    // Fade buffer in over the first FADE_SAMPLES (or numSamples, if shorter), out of previous
+    static void apply(float *buffer, const float *previous, int numSamples);
+
+private:
+    static const float *getRamp();
+};
@@ -0,0 +1,65 @@
+#include "BlockDecodeCache.h"
+
+BlockDecodeCache::BlockDecodeCache()
+    : storage(2 * NUM_SLOTS, CompressedAudioBuffer::DECODED_BLOCK_FRAMES)
+{
+    storage.clear();
+}
+
+BlockDecodeCache::Block BlockDecodeCache::fetch(const CompressedAudioBuffer &audio, int block)
+{
+    const auto before = numDecoded;
+    const int slot = findOrDecode(audio, block);
+
+    if (numDecoded != before)
+        ++numMisses;
+
+    Block result;
+    result.left = storage.getReadPointer(2 * slot);
+    result.right = audio.getNumChannels() > 1 ? storage.getReadPointer(2 * slot + 1) : result.left;
+    return result;
+}
+
+void BlockDecodeCache::prefetch(const CompressedAudioBuffer &audio, int first, int count)
+{
+    const int end = juce::jmin(first + count, audio.getNumBlocks());
+
+    for (int block = juce::jmax(0, first); block < end; ++block)
+        findOrDecode(audio, block);
+}
+
+void BlockDecodeCache::clear()
+{
+    for (auto &slot : slots)
+        slot = Slot();
+}
+
+int BlockDecodeCache::findOrDecode(const CompressedAudioBuffer &audio, int block)
+{
+    int oldest = 0;
+
+    for (int i = 0; i < NUM_SLOTS; ++i)
+    {
+        auto &slot = slots[static_cast<size_t>(i)];
+
+        if (slot.audio == &audio && slot.block == block)
+        {
+            slot.lastUse = ++useCounter;
+            return i;
+        }
+
+        if (slot.lastUse < slots[static_cast<size_t>(oldest)].lastUse)
+            oldest = i;
+    }
+
+    auto &slot = slots[static_cast<size_t>(oldest)];
+    slot.audio = &audio;
+    slot.block = block;
+    slot.lastUse = ++useCounter;
+
+    for (int channel = 0; channel < juce::jmin(2, audio.getNumChannels()); ++channel)
+        audio.decodeBlock(channel, block, storage.getWritePointer(2 * oldest + channel));
+
+    ++numDecoded;
+    return oldest;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "CompressedAudioBuffer.h"
+
+// A voice's small cache of decoded blocks of compressed audio. The voice prefetches the blocks just
+// ahead of its read position (and the loop start it may jump back to) at the start of each render
+// call, so decoding happens a bounded number of blocks at a time instead of on every read.
+// All storage is allocated up front; fetch() and prefetch() never allocate.
+class BlockDecodeCache
+{
+public:
+    static constexpr int NUM_SLOTS = 4;
+    static constexpr int DECODE_AHEAD = 2; // blocks decoded past the one being read
+
+    BlockDecodeCache();
+
+    // Left and right channel of a decoded block; right is left for mono audio
+    struct Block
+    {
+        const float *left = nullptr;
+        const float *right = nullptr;
+    };
+
+    // A decoded block, decoding it now if it isn't cached
+    Block fetch(const CompressedAudioBuffer &audio, int block);
+
+    // Decode any of blocks [first, first + count) that aren't cached yet
+    void prefetch(const CompressedAudioBuffer &audio, int first, int count);
+
+    // Forget everything, e.g. when a new note may be reading different audio
+    void clear();
+
+    // Totals since construction (audio thread)
+    juce::uint64 getNumDecoded() const { return numDecoded; }
+    juce::uint64 getNumMisses() const { return numMisses; }
+
+private:
+    struct Slot
+    {
+        const CompressedAudioBuffer *audio = nullptr;
+        int block = -1;
+        juce::uint32 lastUse = 0;
+    };
+
+    std::array<Slot, NUM_SLOTS> slots;
+    juce::AudioBuffer<float> storage; // channels 2n and 2n + 1 hold slot n
+    juce::uint32 useCounter = 0;
+    juce::uint64 numDecoded = 0;
+    juce::uint64 numMisses = 0;
+
+    // Slot holding the block, decoding it into the least recently used slot if needed
+    int findOrDecode(const CompressedAudioBuffer &audio, int block);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BlockDecodeCache)
+};
@@ -0,0 +1,432 @@
+#include "CompressedAudioBuffer.h"
+
+namespace
+{
+    // How a block of one channel is stored
+    enum BlockType : juce::uint8
+    {
+        constantBlock, // one value for every frame, typically silence
+        fixedBlock,    // fixed predictor residual, Rice coded
+        floatBlock     // the frames as they are
+    };
+
+    constexpr int MAX_ORDER = 3;
+    constexpr int NUM_PARTITIONS = 4;
+    constexpr int PARTITION_FRAMES = CompressedAudioBuffer::BLOCK_FRAMES / NUM_PARTITIONS;
+    constexpr int RICE_ESCAPE = 31; // partition stored as raw values of a given width
+    constexpr size_t READ_PADDING = 8; // the bit reader may fetch this far past the last block
+
+    // Prediction from the previous frames for orders 0 to 3
+    inline int predict(const int *history, int order)
+    {
+        switch (order)
+        {
+        case 1:
+            return history[-1];
+        case 2:
+            return 2 * history[-1] - history[-2];
+        case 3:
+            return 3 * history[-1] - 3 * history[-2] + history[-3];
+        default:
+            return 0;
+        }
+    }
+
+    inline juce::uint32 zigzag(int value) { return (static_cast<juce::uint32>(value) << 1) ^ static_cast<juce::uint32>(value >> 31); }
+    inline int unzigzag(juce::uint32 value) { return static_cast<int>(value >> 1) ^ -static_cast<int>(value & 1); }
+
+    // Bits needed for value, at least one
+    inline int bitWidth(juce::uint32 value) { return value == 0 ? 1 : juce::findHighestSetBit(value) + 1; }
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<juce::uint8> &destination) : bytes(destination) {}
+
+        void write(juce::uint32 value, int numBits)
+        {
+            jassert(numBits > 0 && numBits <= 32);
+            const juce::uint64 mask = numBits == 32 ? 0xffffffffu : ((1u << numBits) - 1);
+            accumulator = (accumulator << numBits) | (value & mask);
+            count += numBits;
+
+            while (count >= 8)
+            {
+                count -= 8;
+                bytes.push_back(static_cast<juce::uint8>(accumulator >> count));
+            }
+        }
+
+        // q zero bits and a one
+        void writeUnary(juce::uint32 q)
+        {
+            for (; q >= 31; q -= 31)
+                write(0, 31);
+
+            write(1, static_cast<int>(q) + 1);
+        }
+
+        void flush()
+        {
+            if (count > 0)
+                bytes.push_back(static_cast<juce::uint8>(accumulator << (8 - count)));
+
+            count = 0;
+        }
+
+    private:
+        std::vector<juce::uint8> &bytes;
+        juce::uint64 accumulator = 0;
+        int count = 0;
+    };
+
+    class BitReader
+    {
+    public:
+        explicit BitReader(const juce::uint8 *source) : bytes(source) {}
+
+        juce::uint32 read(int numBits)
+        {
+            refill();
+            const auto value = static_cast<juce::uint32>(accumulator >> (64 - numBits));
+            accumulator <<= numBits;
+            count -= numBits;
+            return value;
+        }
+
+        juce::uint32 readUnary()
+        {
+            juce::uint32 q = 0;
+
+            for (;;)
+            {
+                refill();
+
+                if (accumulator != 0)
+                {
+                    const int zeros = countLeadingZeros(accumulator);
+                    q += static_cast<juce::uint32>(zeros);
+                    accumulator <<= zeros + 1;
+                    count -= zeros + 1;
+                    return q;
+                }
+
+                q += static_cast<juce::uint32>(count);
+                count = 0;
+            }
+        }
+
+    private:
+        const juce::uint8 *bytes;
+        juce::uint64 accumulator = 0; // next bits, most significant first
+        int count = 0;
+
+        void refill()
+        {
+            while (count <= 56)
+            {
+                accumulator |= static_cast<juce::uint64>(*bytes++) << (56 - count);
+                count += 8;
+            }
+        }
+
+        static int countLeadingZeros(juce::uint64 value)
+        {
+            const auto high = static_cast<juce::uint32>(value >> 32);
+            return high != 0 ? 31 - juce::findHighestSetBit(high) : 63 - juce::findHighestSetBit(static_cast<juce::uint32>(value));
+        }
+    };
+
+    // Cheapest Rice parameter for a partition, or RICE_ESCAPE with the raw width when that is smaller
+    void chooseRiceParameter(const juce::uint32 *values, int count, int &parameter, int &rawWidth, juce::int64 &bits)
+    {
+        juce::uint64 sum = 0;
+        juce::uint32 largest = 0;
+
+        for (int i = 0; i < count; ++i)
+        {
+            sum += values[i];
+            largest = juce::jmax(largest, values[i]);
+        }
+
+        rawWidth = bitWidth(largest);
+        parameter = RICE_ESCAPE;
+        bits = static_cast<juce::int64>(count) * rawWidth + 5;
+
+        // The best parameter is close to log2 of the mean
+        const auto mean = sum / static_cast<juce::uint64>(juce::jmax(1, count));
+        const int estimate = mean > 0 ? juce::findHighestSetBit(static_cast<juce::uint32>(juce::jmin<juce::uint64>(mean, 0xffffffffu))) : 0;
+
+        for (int k = juce::jmax(0, estimate - 1); k <= juce::jmin(30, estimate + 1); ++k)
+        {
+            juce::int64 riceBits = static_cast<juce::int64>(count) * (k + 1);
+
+            for (int i = 0; i < count; ++i)
+                riceBits += values[i] >> k;
+
+            if (riceBits < bits)
+            {
+                bits = riceBits;
+                parameter = k;
+            }
+        }
+    }
+
+    void encodeBlock(const float *input, int bitsPerSample, bool quantize, std::vector<juce::uint8> &bytes)
+    {
+        constexpr int n = CompressedAudioBuffer::DECODED_BLOCK_FRAMES;
+        const float scale = static_cast<float>(1 << (bitsPerSample - 1));
+        const int lowest = -(1 << (bitsPerSample - 1));
+        const int highest = (1 << (bitsPerSample - 1)) - 1;
+
+        // Integer frames, with room in front for the predictor history
+        std::array<int, n + MAX_ORDER> storage{};
+        int *frames = storage.data() + MAX_ORDER;
+        bool onGrid = true;
+
+        for (int i = 0; i < n; ++i)
+        {
+            const float scaled = input[i] * scale;
+            const float rounded = std::round(scaled);
+            onGrid = onGrid && rounded == scaled && rounded >= lowest && rounded <= highest;
+            frames[i] = juce::jlimit(lowest, highest, static_cast<int>(rounded));
+        }
+
+        if (!onGrid && !quantize)
+        {
+            bytes.push_back(floatBlock);
+            const auto *raw = reinterpret_cast<const juce::uint8 *>(input);
+            bytes.insert(bytes.end(), raw, raw + sizeof(float) * n);
+            return;
+        }
+
+        if (std::all_of(frames, frames + n, [first = frames[0]](int frame) { return frame == first; }))
+        {
+            bytes.push_back(constantBlock);
+            BitWriter writer(bytes);
+            writer.write(zigzag(frames[0]), 32);
+            writer.flush();
+            return;
+        }
+
+        // The fixed predictor with the smallest residual
+        int order = 0;
+        juce::uint64 bestSum = std::numeric_limits<juce::uint64>::max();
+
+        for (int candidate = 0; candidate <= MAX_ORDER; ++candidate)
+        {
+            juce::uint64 sum = 0;
+
+            for (int i = candidate; i < n; ++i)
+                sum += zigzag(frames[i] - predict(frames + i, candidate));
+
+            if (sum < bestSum)
+            {
+                bestSum = sum;
+                order = candidate;
+            }
+        }
+
+        std::array<juce::uint32, n> residual{};
+
+        for (int i = order; i < n; ++i)
+            residual[static_cast<size_t>(i)] = zigzag(frames[i] - predict(frames + i, order));
+
+        bytes.push_back(fixedBlock);
+        bytes.push_back(static_cast<juce::uint8>(order));
+
+        BitWriter writer(bytes);
+
+        for (int i = 0; i < order; ++i)
+            writer.write(zigzag(frames[i]), 32);
+
+        // The last partition also takes the guard frames
+        for (int partition = 0; partition < NUM_PARTITIONS; ++partition)
+        {
+            const int first = juce::jmax(order, partition * PARTITION_FRAMES);
+            const int end = partition == NUM_PARTITIONS - 1 ? n : (partition + 1) * PARTITION_FRAMES;
+            const juce::uint32 *values = residual.data() + first;
+            const int count = end - first;
+
+            int parameter = 0, rawWidth = 0;
+            juce::int64 bits = 0;
+            chooseRiceParameter(values, count, parameter, rawWidth, bits);
+            writer.write(static_cast<juce::uint32>(parameter), 5);
+
+            if (parameter == RICE_ESCAPE)
+            {
+                writer.write(static_cast<juce::uint32>(rawWidth - 1), 5);
+
+                for (int i = 0; i < count; ++i)
+                    writer.write(values[i], rawWidth);
+            }
+            else
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    writer.writeUnary(values[i] >> parameter);
+
+                    if (parameter > 0)
+                        writer.write(values[i], parameter);
+                }
+            }
+        }
+
+        writer.flush();
+    }
+}
+
+std::unique_ptr<CompressedAudioBuffer> CompressedAudioBuffer::compress(const PagedAudioBuffer &source, int bits, bool quantize)
+{
+    jassert(bits >= 8 && bits <= 24);
+
+    std::unique_ptr<CompressedAudioBuffer> result(new CompressedAudioBuffer());
+    result->numChannels = source.getNumChannels();
+    result->numFrames = source.getNumFrames();
+    result->numBlocks = static_cast<int>((result->numFrames + BLOCK_FRAMES - 1) >> BLOCK_BITS);
+    result->bitsPerSample = juce::jlimit(8, 24, bits);
+    result->seekTable.resize(static_cast<size_t>(result->numChannels * result->numBlocks));
+
+    std::vector<juce::uint8> bytes;
+    std::vector<float> frames(static_cast<size_t>(DECODED_BLOCK_FRAMES));
+
+    for (int channel = 0; channel < result->numChannels; ++channel)
+    {
+        for (int block = 0; block < result->numBlocks; ++block)
+        {
+            result->seekTable[static_cast<size_t>(channel * result->numBlocks + block)] = bytes.size();
+
+            // Frames past the end read as zero, which the decoder reproduces
+            source.copyTo(channel, blockStart(block), frames.data(), DECODED_BLOCK_FRAMES);
+            encodeBlock(frames.data(), result->bitsPerSample, quantize, bytes);
+        }
+    }
+
+    result->data.setSize(bytes.size() + READ_PADDING, true);
+    result->data.copyFrom(bytes.data(), 0, bytes.size());
+    return result;
+}
+
+void CompressedAudioBuffer::decodeBlock(int channel, int block, float *destination) const
+{
+    constexpr int n = DECODED_BLOCK_FRAMES;
+    const auto *bytes = static_cast<const juce::uint8 *>(data.getData()) + seekTable[static_cast<size_t>(channel * numBlocks + block)];
+    const float scale = 1.0f / static_cast<float>(1 << (bitsPerSample - 1));
+
+    const auto type = *bytes++;
+
+    if (type == floatBlock)
+    {
+        std::memcpy(destination, bytes, sizeof(float) * n);
+        return;
+    }
+
+    if (type == constantBlock)
+    {
+        BitReader reader(bytes);
+        juce::FloatVectorOperations::fill(destination, static_cast<float>(unzigzag(reader.read(32))) * scale, n);
+        return;
+    }
+
+    const int order = *bytes++;
+    BitReader reader(bytes);
+
+    int storage[n + MAX_ORDER] = {};
+    int *frames = storage + MAX_ORDER;
+
+    for (int i = 0; i < order; ++i)
+        frames[i] = unzigzag(reader.read(32));
+
+    for (int partition = 0; partition < NUM_PARTITIONS; ++partition)
+    {
+        const int first = juce::jmax(order, partition * PARTITION_FRAMES);
+        const int end = partition == NUM_PARTITIONS - 1 ? n : (partition + 1) * PARTITION_FRAMES;
+        const auto parameter = static_cast<int>(reader.read(5));
+
+        if (parameter == RICE_ESCAPE)
+        {
+            const int rawWidth = static_cast<int>(reader.read(5)) + 1;
+
+            for (int i = first; i < end; ++i)
+                frames[i] = unzigzag(reader.read(rawWidth)) + predict(frames + i, order);
+        }
+        else
+        {
+            for (int i = first; i < end; ++i)
+            {
+                juce::uint32 value = reader.readUnary() << parameter;
+
+                if (parameter > 0)
+                    value |= reader.read(parameter);
+
+                frames[i] = unzigzag(value) + predict(frames + i, order);
+            }
+        }
+    }
+
+    for (int i = 0; i < n; ++i)
+        destination[i] = static_cast<float>(frames[i]) * scale;
+}
+
+float CompressedAudioBuffer::getSample(int channel, juce::int64 frame) const
+{
+    if (frame < 0 || frame >= numFrames)
+        return 0.0f;
+
+    float decoded[DECODED_BLOCK_FRAMES];
+    decodeBlock(channel, blockOf(frame), decoded);
+    return decoded[frame & (BLOCK_FRAMES - 1)];
+}
+
+void CompressedAudioBuffer::copyTo(int channel, juce::int64 start, float *destination, int count) const
+{
+    std::vector<float> decoded(static_cast<size_t>(DECODED_BLOCK_FRAMES));
+    int decodedBlock = -1;
+
+    for (int i = 0; i < count; ++i)
+    {
+        const juce::int64 frame = start + i;
+
+        if (frame < 0 || frame >= numFrames)
+        {
+            destination[i] = 0.0f;
+            continue;
+        }
+
+        if (blockOf(frame) != decodedBlock)
+        {
+            decodedBlock = blockOf(frame);
+            decodeBlock(channel, decodedBlock, decoded.data());
+        }
+
+        destination[i] = decoded[static_cast<size_t>(frame & (BLOCK_FRAMES - 1))];
+    }
+}
+
+juce::AudioBuffer<float> CompressedAudioBuffer::toAudioBuffer(juce::int64 start, int count) const
+{
+    juce::AudioBuffer<float> result(numChannels, juce::jmax(0, count));
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        copyTo(channel, start, result.getWritePointer(channel), result.getNumSamples());
+
+    return result;
+}
+
+std::unique_ptr<PagedAudioBuffer> CompressedAudioBuffer::decompress() const
+{
+    auto result = std::make_unique<PagedAudioBuffer>(numChannels, numFrames);
+    std::vector<float> decoded(static_cast<size_t>(DECODED_BLOCK_FRAMES));
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            decodeBlock(channel, block, decoded.data());
+            const int count = static_cast<int>(juce::jmin<juce::int64>(BLOCK_FRAMES, numFrames - blockStart(block)));
+            result->copyFrom(channel, blockStart(block), decoded.data(), count);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PagedAudioBuffer.h"
+
+// Audio kept losslessly compressed in memory, in independent blocks in the style of FLAC frames:
+// each block of each channel is stored as a constant, as a fixed-order linear prediction residual
+// Rice coded in partitions, or (when it isn't on the integer grid) as plain floats. A seek table
+// holds the offset of every block, so any block decodes on its own in bounded time.
+// Like pages, each block also encodes the first GUARD_FRAMES of the next one, so a decoded
+// block can be read by the interpolating voice kernel without looking further.
+class CompressedAudioBuffer
+{
+public:
+    static constexpr int BLOCK_BITS = 10;
+    static constexpr int BLOCK_FRAMES = 1 << BLOCK_BITS; // 1024 frames per block
+    static constexpr int GUARD_FRAMES = PagedAudioBuffer::GUARD_FRAMES;
+    static constexpr int DECODED_BLOCK_FRAMES = BLOCK_FRAMES + GUARD_FRAMES;
+
+    // Compress audio decoded from bitsPerSample integer PCM (up to 24 bits). Blocks that aren't
+    // exactly on that grid are kept as floats unless quantize is set, which rounds them onto it
+    // (for derived audio such as mipmap octaves).
+    static std::unique_ptr<CompressedAudioBuffer> compress(const PagedAudioBuffer &source, int bitsPerSample, bool quantize);
+
+    int getNumChannels() const { return numChannels; }
+    juce::int64 getNumFrames() const { return numFrames; }
+    int getNumBlocks() const { return numBlocks; }
+    int getBitsPerSample() const { return bitsPerSample; }
+
+    static int blockOf(juce::int64 frame) { return static_cast<int>(frame >> BLOCK_BITS); }
+    static juce::int64 blockStart(int block) { return static_cast<juce::int64>(block) << BLOCK_BITS; }
+
+    // Frames of real audio in a decoded block, including the guard frames from the next block
+    int getBlockLength(int block) const
+    {
+        return static_cast<int>(juce::jmin<juce::int64>(DECODED_BLOCK_FRAMES, numFrames - blockStart(block)));
+    }
+
+    // Compressed data plus the seek table
+    size_t getSizeInBytes() const { return data.getSize() + seekTable.size() * sizeof(seekTable[0]); }
+
+    // Decode one block of one channel into DECODED_BLOCK_FRAMES floats. Doesn't allocate, so
+    // voices can call it on the audio thread.
+    void decodeBlock(int channel, int block, float *destination) const;
+
+    // Random access for the message thread; these decode whole blocks, so keep them occasional
+    float getSample(int channel, juce::int64 frame) const;
+    void copyTo(int channel, juce::int64 start, float *destination, int count) const;
+    juce::AudioBuffer<float> toAudioBuffer(juce::int64 start, int count) const;
+
+    // Everything decoded back into float pages
+    std::unique_ptr<PagedAudioBuffer> decompress() const;
+
+private:
+    int numChannels = 0;
+    juce::int64 numFrames = 0;
+    int numBlocks = 0;
+    int bitsPerSample = 0;
+
+    juce::MemoryBlock data;
+    std::vector<juce::uint64> seekTable; // byte offset of each block: channel * numBlocks + block
+
+    CompressedAudioBuffer() = default;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CompressedAudioBuffer)
+};
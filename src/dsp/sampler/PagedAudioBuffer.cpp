@@ -0,0 +1,162 @@
+#include "PagedAudioBuffer.h"
+
+PagedAudioBuffer::PagedAudioBuffer(int channels, juce::int64 frames)
+    : numChannels(juce::jmax(0, channels)),
+      numFrames(juce::jmax<juce::int64>(0, frames)),
+      numPages(static_cast<int>((numFrames + PAGE_FRAMES - 1) >> PAGE_BITS))
+{
+    pages.resize(static_cast<size_t>(numChannels * numPages));
+
+    // Short samples would otherwise pay for a whole page each
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int page = 0; page < numPages; ++page)
+            pages[static_cast<size_t>(channel * numPages + page)].calloc(getAllocatedFrames(page));
+}
+
+size_t PagedAudioBuffer::getSizeInBytes() const
+{
+    size_t frames = 0;
+
+    for (int page = 0; page < numPages; ++page)
+        frames += getAllocatedFrames(page);
+
+    return frames * sizeof(float) * static_cast<size_t>(numChannels);
+}
+
+std::unique_ptr<PagedAudioBuffer> PagedAudioBuffer::fromReader(juce::AudioFormatReader &reader)
+{
+    const auto channels = static_cast<int>(reader.numChannels);
+
+    if (channels == 0 || reader.lengthInSamples <= 0)
+        return nullptr;
+
+    auto result = std::make_unique<PagedAudioBuffer>(channels, reader.lengthInSamples);
+    std::vector<float *> destinations(static_cast<size_t>(channels));
+
+    for (int page = 0; page < result->numPages; ++page)
+    {
+        for (int channel = 0; channel < channels; ++channel)
+            destinations[static_cast<size_t>(channel)] = result->getWritePage(channel, page);
+
+        const int count = static_cast<int>(juce::jmin<juce::int64>(PAGE_FRAMES, result->numFrames - pageStart(page)));
+
+        if (!reader.read(destinations.data(), channels, pageStart(page), count))
+            return nullptr;
+    }
+
+    for (int channel = 0; channel < channels; ++channel)
+        result->updateGuards(channel, 1, result->numPages - 1);
+
+    return result;
+}
+
+std::unique_ptr<PagedAudioBuffer> PagedAudioBuffer::fromBuffer(const juce::AudioBuffer<float> &buffer)
+{
+    auto result = std::make_unique<PagedAudioBuffer>(buffer.getNumChannels(), buffer.getNumSamples());
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        result->copyFrom(channel, 0, buffer.getReadPointer(channel), buffer.getNumSamples());
+
+    return result;
+}
+
+std::unique_ptr<PagedAudioBuffer> PagedAudioBuffer::fromPages(int channels, juce::int64 frames, std::vector<juce::HeapBlock<float>> filledPages)
+{
+    auto result = std::make_unique<PagedAudioBuffer>();
+    result->numChannels = juce::jmax(0, channels);
+    result->numFrames = juce::jmax<juce::int64>(0, frames);
+    result->numPages = static_cast<int>((result->numFrames + PAGE_FRAMES - 1) >> PAGE_BITS);
+
+    if (filledPages.size() != static_cast<size_t>(result->numChannels * result->numPages))
+    {
+        jassertfalse;
+        return nullptr;
+    }
+
+    result->pages = std::move(filledPages);
+
+    for (int channel = 0; channel < result->numChannels; ++channel)
+    {
+        // Trim the last page to what the constructor would have allocated
+        if (result->numPages > 0)
+            result->pages[static_cast<size_t>(channel * result->numPages + result->numPages - 1)].realloc(result->getAllocatedFrames(result->numPages - 1));
+
+        result->updateGuards(channel, 1, result->numPages - 1);
+    }
+
+    return result;
+}
+
+float PagedAudioBuffer::getSample(int channel, juce::int64 frame) const
+{
+    if (frame < 0 || frame >= numFrames)
+        return 0.0f;
+
+    return getPage(channel, pageOf(frame))[frame & (PAGE_FRAMES - 1)];
+}
+
+void PagedAudioBuffer::copyTo(int channel, juce::int64 start, float *destination, int count) const
+{
+    // Leading and trailing frames outside the audio are silent
+    while (count > 0 && start < 0)
+    {
+        *destination++ = 0.0f;
+        ++start;
+        --count;
+    }
+
+    while (count > 0 && start < numFrames)
+    {
+        const int page = pageOf(start);
+        const auto offset = static_cast<int>(start - pageStart(page));
+        const int chunk = static_cast<int>(juce::jmin<juce::int64>(count, PAGE_FRAMES - offset, numFrames - start));
+
+        juce::FloatVectorOperations::copy(destination, getPage(channel, page) + offset, chunk);
+        destination += chunk;
+        start += chunk;
+        count -= chunk;
+    }
+
+    if (count > 0)
+        juce::FloatVectorOperations::clear(destination, count);
+}
+
+juce::AudioBuffer<float> PagedAudioBuffer::toAudioBuffer(juce::int64 start, int count) const
+{
+    juce::AudioBuffer<float> result(numChannels, juce::jmax(0, count));
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        copyTo(channel, start, result.getWritePointer(channel), result.getNumSamples());
+
+    return result;
+}
+
+void PagedAudioBuffer::copyFrom(int channel, juce::int64 start, const float *source, int count)
+{
+    jassert(start >= 0 && start + count <= numFrames);
+
+    if (count <= 0)
+        return;
+
+    const int firstPage = pageOf(start);
+
+    while (count > 0)
+    {
+        const int page = pageOf(start);
+        const auto offset = static_cast<int>(start - pageStart(page));
+        const int chunk = juce::jmin(count, PAGE_FRAMES - offset);
+
+        juce::FloatVectorOperations::copy(getWritePage(channel, page) + offset, source, chunk);
+        source += chunk;
+        start += chunk;
+        count -= chunk;
+    }
+
+    updateGuards(channel, juce::jmax(1, firstPage), pageOf(start - 1));
+}
+
+void PagedAudioBuffer::updateGuards(int channel, int firstPage, int lastPage)
+{
+    for (int page = firstPage; page <= lastPage; ++page)
+        juce::FloatVectorOperations::copy(getWritePage(channel, page - 1) + PAGE_FRAMES, getPage(channel, page), GUARD_FRAMES);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Multichannel audio stored as fixed-size pages instead of one contiguous block, so samples
+// of any length (64-bit frame counts) load without needing a huge single allocation.
+// Each page is followed by GUARD_FRAMES copies of the next page's first frames (zeros after
+// the last page), so an interpolating read that starts inside a page never has to look at
+// the next one. Readers take a page pointer and work in page-relative positions.
+class PagedAudioBuffer
+{
+public:
+    static constexpr int PAGE_BITS = 16;
+    static constexpr int PAGE_FRAMES = 1 << PAGE_BITS; // 64k frames per page
+    static constexpr int GUARD_FRAMES = 4;
+
+    PagedAudioBuffer() = default;
+
+    // Silent buffer of the given size
+    PagedAudioBuffer(int numChannels, juce::int64 numFrames);
+
+    PagedAudioBuffer(PagedAudioBuffer &&) noexcept = default;
+    PagedAudioBuffer &operator=(PagedAudioBuffer &&) noexcept = default;
+
+    // Decode a whole reader straight into pages; null if the reader is empty or fails
+    static std::unique_ptr<PagedAudioBuffer> fromReader(juce::AudioFormatReader &reader);
+
+    // Copy of a contiguous buffer
+    static std::unique_ptr<PagedAudioBuffer> fromBuffer(const juce::AudioBuffer<float> &buffer);
+
+    // Take over pages filled elsewhere, channel-major as getPage() lays them out. Each must hold
+    // PAGE_FRAMES + GUARD_FRAMES frames and be zero past numFrames; the guard frames are filled in here.
+    static std::unique_ptr<PagedAudioBuffer> fromPages(int numChannels, juce::int64 numFrames, std::vector<juce::HeapBlock<float>> pages);
+
+    int getNumChannels() const { return numChannels; }
+    juce::int64 getNumFrames() const { return numFrames; }
+    int getNumPages() const { return numPages; }
+
+    // Memory held by the pages
+    size_t getSizeInBytes() const;
+
+    static int pageOf(juce::int64 frame) { return static_cast<int>(frame >> PAGE_BITS); }
+    static juce::int64 pageStart(int page) { return static_cast<juce::int64>(page) << PAGE_BITS; }
+
+    // Frames of real audio readable from getPage(), including the guard frames taken from the next page
+    int getPageLength(int page) const
+    {
+        return static_cast<int>(juce::jmin<juce::int64>(PAGE_FRAMES + GUARD_FRAMES, numFrames - pageStart(page)));
+    }
+
+    // One page of one channel: PAGE_FRAMES + GUARD_FRAMES frames, zero past the end of the audio.
+    // The last page is only allocated up to the end of the audio plus its guard frames.
+    const float *getPage(int channel, int page) const { return pages[static_cast<size_t>(channel * numPages + page)].get(); }
+
+    // Single frame, or zero outside the audio
+    float getSample(int channel, juce::int64 frame) const;
+
+    // Contiguous copies across page boundaries; frames outside the audio read as zero
+    void copyTo(int channel, juce::int64 start, float *destination, int count) const;
+    juce::AudioBuffer<float> toAudioBuffer(juce::int64 start, int count) const;
+
+    // Write frames, keeping the guard frames of the page before in step
+    void copyFrom(int channel, juce::int64 start, const float *source, int count);
+
+private:
+    int numChannels = 0;
+    juce::int64 numFrames = 0;
+    int numPages = 0;
+    std::vector<juce::HeapBlock<float>> pages; // channel-major: channel * numPages + page
+
+    size_t getAllocatedFrames(int page) const
+    {
+        return static_cast<size_t>(juce::jmin<juce::int64>(PAGE_FRAMES, numFrames - pageStart(page)) + GUARD_FRAMES);
+    }
+
+    float *getWritePage(int channel, int page) { return pages[static_cast<size_t>(channel * numPages + page)].get(); }
+
+    // Copy the head of each page into the guard frames of the one before it
+    void updateGuards(int channel, int firstPage, int lastPage);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PagedAudioBuffer)
+};
@@ -0,0 +1,241 @@
+#include "PitchedNoteCache.h"
+#include "Trace.h"
+
+namespace
+{
+    // Windowed-sinc resampling kernel: ZERO_CROSSINGS lobes either side of the centre, Blackman windowed
+    constexpr int ZERO_CROSSINGS = 32;
+
+    // Cutoff as a fraction of the lower of the two Nyquist frequencies, leaving room for the transition band
+    constexpr double PASSBAND = 0.95;
+
+    // Output frames rendered per source read
+    constexpr int CHUNK_FRAMES = 4096;
+
+    // One side of the kernel, tabulated at STEPS points per zero crossing and read with linear interpolation
+    struct SincTable
+    {
+        static constexpr int STEPS = 256;
+
+        std::vector<float> values;
+
+        SincTable()
+            : values(static_cast<size_t>(ZERO_CROSSINGS * STEPS + 2), 0.0f)
+        {
+            for (int i = 0; i <= ZERO_CROSSINGS * STEPS; ++i)
+            {
+                const double x = juce::MathConstants<double>::pi * i / STEPS;
+                const double sinc = i == 0 ? 1.0 : std::sin(x) / x;
+
+                // Blackman window, reaching zero at the last zero crossing
+                const double phase = x / ZERO_CROSSINGS;
+                const double window = 0.42 + 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+
+                values[static_cast<size_t>(i)] = static_cast<float>(sinc * window);
+            }
+        }
+
+        // Kernel at a distance in table steps, of either sign; zero past the last zero crossing
+        float at(double distance) const
+        {
+            const double index = std::abs(distance);
+            const auto i = static_cast<size_t>(index);
+
+            if (i >= values.size() - 1)
+                return 0.0f;
+
+            const auto fraction = static_cast<float>(index - static_cast<double>(i));
+            return values[i] + fraction * (values[i + 1] - values[i]);
+        }
+    };
+}
+
+//==============================================================================
+PitchedNoteCache::PitchedNoteCache(const SampleData &sample, const ProxySamplerSound::PlaybackRegion &playbackRegion, double root,
+                                   size_t budget)
+    : sourceAudio(sample.buffer),
+      sourceCompressed(sample.compressed),
+      numFrames(sample.getNumFrames()),
+      numChannels(sample.buffer != nullptr ? sample.buffer->getNumChannels() : sample.compressed != nullptr ? sample.compressed->getNumChannels() : 0),
+      region(playbackRegion),
+      rootNote(root),
+      budgetBytes(budget)
+{
+}
+
+const ProxySamplerSound::PlaybackLevel *PitchedNoteCache::find(int midiNote) const
+{
+    if (!juce::isPositiveAndBelow(midiNote, NUM_NOTES) || getPitchRatio(midiNote) == 1.0)
+        return nullptr;
+
+    const auto &note = notes[static_cast<size_t>(midiNote)];
+
+    if (note.ready.load(std::memory_order_acquire))
+        return &note.level;
+
+    note.requested.store(true, std::memory_order_relaxed);
+    return nullptr;
+}
+
+int PitchedNoteCache::getNumReady() const
+{
+    int numReady = 0;
+
+    for (const auto &note : notes)
+        if (note.ready.load())
+            ++numReady;
+
+    return numReady;
+}
+
+bool PitchedNoteCache::buildNext(const std::function<bool()> &shouldStop)
+{
+    if (numFrames == 0 || numChannels == 0)
+        return false;
+
+    for (int midiNote = 0; midiNote < NUM_NOTES; ++midiNote)
+    {
+        auto &note = notes[static_cast<size_t>(midiNote)];
+
+        if (!note.requested.load(std::memory_order_relaxed) || note.ready.load() || note.skipped)
+            continue;
+
+        const double pitchRatio = getPitchRatio(midiNote);
+        const auto length = getRenderLength(pitchRatio);
+        const auto bytes = static_cast<size_t>(length) * static_cast<size_t>(numChannels) * sizeof(float);
+
+        // Rendered notes are kept, so the budget goes to the notes played first
+        if (usedBytes.load() + bytes > budgetBytes)
+        {
+            note.skipped = true;
+            continue;
+        }
+
+        PROXY_TRACE_SCOPE("render pitched note");
+
+        auto audio = render(pitchRatio, shouldStop);
+
+        if (audio == nullptr)
+            return false;
+
+        note.level = ProxySamplerSound::makeLevel(*audio, region, pitchRatio);
+        usedBytes += audio->getSizeInBytes();
+        note.audio = std::move(audio);
+        note.ready.store(true, std::memory_order_release);
+        return true;
+    }
+
+    return false;
+}
+
+void PitchedNoteCache::readSource(int channel, juce::int64 start, float *destination, int count) const
+{
+    if (sourceAudio != nullptr)
+        sourceAudio->copyTo(channel, start, destination, count);
+    else
+        sourceCompressed->copyTo(channel, start, destination, count);
+}
+
+juce::int64 PitchedNoteCache::getRenderLength(double pitchRatio) const
+{
+    // The last frame voices read, plus the one interpolation reads after it
+    const auto end = juce::jlimit<juce::int64>(1, numFrames, region.end + 1);
+    return static_cast<juce::int64>(std::ceil(static_cast<double>(end) / pitchRatio));
+}
+
+std::unique_ptr<PagedAudioBuffer> PitchedNoteCache::render(double pitchRatio, const std::function<bool()> &shouldStop) const
+{
+    static const SincTable table;
+
+    // Pitching up also has to remove what would fold back over the lower Nyquist frequency,
+    // which stretches the kernel over more source frames
+    const double cutoff = juce::jmin(1.0, 1.0 / pitchRatio) * PASSBAND;
+    const double tableScale = cutoff * SincTable::STEPS;
+    const int reach = static_cast<int>(std::ceil(ZERO_CROSSINGS / cutoff));
+    const auto length = getRenderLength(pitchRatio);
+
+    auto audio = std::make_unique<PagedAudioBuffer>(numChannels, length);
+    std::vector<float> input;
+    std::vector<float> output(static_cast<size_t>(CHUNK_FRAMES));
+
+    for (juce::int64 first = 0; first < length; first += CHUNK_FRAMES)
+    {
+        if (shouldStop())
+            return nullptr;
+
+        const auto count = static_cast<int>(juce::jmin<juce::int64>(CHUNK_FRAMES, length - first));
+
+        // Every source frame the chunk's kernels touch; reads outside the sample are silence
+        const auto inputStart = static_cast<juce::int64>(std::floor(static_cast<double>(first) * pitchRatio)) - reach + 1;
+        const auto inputEnd = static_cast<juce::int64>(std::floor(static_cast<double>(first + count - 1) * pitchRatio)) + reach + 1;
+        input.resize(static_cast<size_t>(inputEnd - inputStart));
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            readSource(channel, inputStart, input.data(), static_cast<int>(input.size()));
+
+            for (int i = 0; i < count; ++i)
+            {
+                const double position = static_cast<double>(first + i) * pitchRatio;
+                const auto centre = static_cast<juce::int64>(std::floor(position));
+                const double fraction = position - static_cast<double>(centre);
+                const float *x = input.data() + (centre - inputStart);
+                double sum = 0.0;
+
+                for (int k = 1 - reach; k <= reach; ++k)
+                    sum += x[k] * table.at((fraction - k) * tableScale);
+
+                output[static_cast<size_t>(i)] = static_cast<float>(sum * cutoff);
+            }
+
+            audio->copyFrom(channel, first, output.data(), count);
+        }
+    }
+
+    return audio;
+}
+
+//==============================================================================
+NoteCacheBuilder::NoteCacheBuilder()
+    : juce::Thread("Proxy note cache")
+{
+}
+
+NoteCacheBuilder::~NoteCacheBuilder()
+{
+    stopThread(10000);
+}
+
+void NoteCacheBuilder::setCache(std::shared_ptr<PitchedNoteCache> newCache)
+{
+    const bool hasCache = newCache != nullptr;
+
+    {
+        const juce::ScopedLock sl(lock);
+        cache = std::move(newCache);
+    }
+
+    if (hasCache && !isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+}
+
+std::shared_ptr<PitchedNoteCache> NoteCacheBuilder::getCache() const
+{
+    const juce::ScopedLock sl(lock);
+    return cache;
+}
+
+void NoteCacheBuilder::run()
+{
+    while (!threadShouldExit())
+    {
+        const auto current = getCache();
+
+        // A note that has been rendered is followed straight away by the next one waiting
+        const bool built = current != nullptr && current->buildNext([this, &current]
+                                                                    { return threadShouldExit() || getCache() != current; });
+
+        if (!built)
+            wait(POLL_INTERVAL_MS);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SamplerVoice.h"
+
+// Copies of one sound's sample pre-rendered at the pitch of each MIDI note, so a voice playing a
+// cached note reads one frame per output sample: a plain copy with envelope and gain, no
+// interpolation, and the quality of an offline windowed-sinc resampler rather than realtime
+// linear interpolation. A note is queued the first time it is played and rendered in the
+// background by a NoteCacheBuilder; until then, and for notes that no longer fit the memory
+// budget, voices read the source as before. Rendered notes are kept for the life of the cache,
+// which belongs to one sound and so to one set of loop points, root note and play range; each
+// note is only rendered up to the end of the range.
+class PitchedNoteCache
+{
+public:
+    static constexpr int NUM_NOTES = 128;
+
+    PitchedNoteCache(const SampleData &sample, const ProxySamplerSound::PlaybackRegion &region, double rootNote, size_t budgetBytes);
+
+    // Playback ratio of a note relative to the root, as the voices compute it; a note at the root
+    // plays the source at its own pitch, so is never rendered
+    double getPitchRatio(int midiNote) const { return std::pow(2.0, (midiNote - rootNote) / 12.0); }
+
+    // The note's pre-rendered level, or null if it isn't ready; a note that isn't is queued for
+    // the builder. Lock-free, for the audio thread.
+    const ProxySamplerSound::PlaybackLevel *find(int midiNote) const;
+
+    // Render the next queued note that fits the budget (builder thread). shouldStop is polled between
+    // chunks, so a cache that has been replaced stops early. Returns false when nothing is waiting.
+    bool buildNext(const std::function<bool()> &shouldStop);
+
+    size_t getBudgetBytes() const { return budgetBytes; }
+    size_t getSizeInBytes() const { return usedBytes.load(); }
+    int getNumReady() const;
+
+private:
+    struct Note
+    {
+        mutable std::atomic<bool> requested{false};
+        std::atomic<bool> ready{false};
+        bool skipped = false; // over budget or abandoned; played from the source
+        std::unique_ptr<PagedAudioBuffer> audio;
+        ProxySamplerSound::PlaybackLevel level;
+    };
+
+    std::shared_ptr<const PagedAudioBuffer> sourceAudio;
+    std::shared_ptr<const CompressedAudioBuffer> sourceCompressed;
+    juce::int64 numFrames = 0;
+    int numChannels = 0;
+    ProxySamplerSound::PlaybackRegion region;
+    double rootNote = SampleAnalysis::DEFAULT_ROOT_NOTE;
+    size_t budgetBytes = 0;
+    std::atomic<size_t> usedBytes{0};
+    std::array<Note, NUM_NOTES> notes;
+
+    void readSource(int channel, juce::int64 start, float *destination, int count) const;
+
+    // Frames of a note rendered at this ratio: enough to reach the end of the play range
+    juce::int64 getRenderLength(double pitchRatio) const;
+
+    // Resample the source to the note's pitch; null if shouldStop cut it short
+    std::unique_ptr<PagedAudioBuffer> render(double pitchRatio, const std::function<bool()> &shouldStop) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PitchedNoteCache)
+};
+
+// Background thread that renders the notes voices ask the current cache for. Voices only set a
+// flag, so the thread looks for new requests every POLL_INTERVAL_MS rather than being woken.
+class NoteCacheBuilder : private juce::Thread
+{
+public:
+    static constexpr int POLL_INTERVAL_MS = 20;
+
+    NoteCacheBuilder();
+    ~NoteCacheBuilder() override;
+
+    // The cache to fill, or null for none; a note of the previous one stops part way (message thread)
+    void setCache(std::shared_ptr<PitchedNoteCache> newCache);
+
+private:
+    juce::CriticalSection lock;
+    std::shared_ptr<PitchedNoteCache> cache;
+
+    std::shared_ptr<PitchedNoteCache> getCache() const;
+    void run() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NoteCacheBuilder)
+};
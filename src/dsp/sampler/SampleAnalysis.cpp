@@ -0,0 +1,434 @@
+#include "SampleAnalysis.h"
+#include "MeterEngine.h"
+#include "Trace.h"
+
+static_assert(SampleAnalysis::SILENCE_LUFS == MeterSnapshot::SILENCE_LUFS, "Unmeasured loudness should read as the meters' silence");
+
+namespace
+{
+    // Frames read per pass over the sample; channels past the second are left out, as in the meters
+    constexpr int CHUNK_FRAMES = 1 << 15;
+    constexpr int MAX_CHANNELS = 2;
+
+    // Integrated loudness is measured over the start of very long samples only
+    constexpr double MAX_LOUDNESS_SECONDS = 600.0;
+
+    // Trim points: the first frame above ONSET_DB and the last above TAIL_DB, both relative to the
+    // peak and found HOP_FRAMES at a time, then moved to the nearest zero crossing within reach
+    constexpr float ONSET_DB = -50.0f;
+    constexpr float TAIL_DB = -60.0f;
+    constexpr int HOP_FRAMES = 64;
+    constexpr double ONSET_BACK_OFF_SECONDS = 0.005;
+    constexpr double TAIL_SEARCH_SECONDS = 0.01;
+
+    // Pitch: McLeod's normalised square difference over windows of PITCH_WINDOW frames taken
+    // after the attack, with the autocorrelation computed by an FFT twice the window's size
+    constexpr int PITCH_FFT_ORDER = 13;
+    constexpr int PITCH_WINDOW = 1 << (PITCH_FFT_ORDER - 1);
+    constexpr int MAX_PITCH_WINDOWS = 8;
+    constexpr double PITCH_SKIP_SECONDS = 0.05;
+    constexpr float PITCH_WINDOW_DB = -40.0f; // quieter windows are left out
+    constexpr double MIN_PITCH_HZ = 40.0;
+    constexpr double MAX_PITCH_HZ = 2000.0;
+    constexpr float MIN_CLARITY = 0.8f;
+    constexpr float KEY_MAXIMUM_RATIO = 0.9f; // first peak this close to the highest is the period
+
+    template <typename Audio>
+    void readChunk(const Audio &audio, int numChannels, juce::int64 start, int count, juce::AudioBuffer<float> &chunk)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            audio.copyTo(channel, start, chunk.getWritePointer(channel), count);
+    }
+
+    // Channels summed into one, for the zero crossings and the pitch
+    template <typename Audio>
+    void readMix(const Audio &audio, int numChannels, juce::int64 start, int count, std::vector<float> &mix, std::vector<float> &scratch)
+    {
+        mix.assign(static_cast<size_t>(count), 0.0f);
+        scratch.resize(static_cast<size_t>(count));
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            audio.copyTo(channel, start, scratch.data(), count);
+            juce::FloatVectorOperations::add(mix.data(), scratch.data(), count);
+        }
+    }
+
+    float findPeak(const juce::AudioBuffer<float> &chunk, int numChannels, int start, int count)
+    {
+        float peak = 0.0f;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            peak = juce::jmax(peak, MeterEngine::findPeak(chunk.getReadPointer(channel, start), count));
+
+        return peak;
+    }
+
+    bool isAbove(const juce::AudioBuffer<float> &chunk, int numChannels, int frame, float threshold)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            if (std::abs(chunk.getSample(channel, frame)) >= threshold)
+                return true;
+
+        return false;
+    }
+
+    // First frame at or above the threshold in any channel, or -1
+    template <typename Audio>
+    juce::int64 findFirstAbove(const Audio &audio, int numChannels, float threshold, juce::AudioBuffer<float> &chunk)
+    {
+        const auto numFrames = audio.getNumFrames();
+
+        for (juce::int64 first = 0; first < numFrames; first += CHUNK_FRAMES)
+        {
+            const auto count = static_cast<int>(juce::jmin<juce::int64>(CHUNK_FRAMES, numFrames - first));
+            readChunk(audio, numChannels, first, count, chunk);
+
+            for (int hop = 0; hop < count; hop += HOP_FRAMES)
+            {
+                const int hopEnd = juce::jmin(count, hop + HOP_FRAMES);
+
+                if (findPeak(chunk, numChannels, hop, hopEnd - hop) < threshold)
+                    continue;
+
+                for (int i = hop; i < hopEnd; ++i)
+                    if (isAbove(chunk, numChannels, i, threshold))
+                        return first + i;
+            }
+        }
+
+        return -1;
+    }
+
+    // Last frame at or above the threshold in any channel, or -1
+    template <typename Audio>
+    juce::int64 findLastAbove(const Audio &audio, int numChannels, float threshold, juce::AudioBuffer<float> &chunk)
+    {
+        for (juce::int64 end = audio.getNumFrames(); end > 0; end -= CHUNK_FRAMES)
+        {
+            const auto first = juce::jmax<juce::int64>(0, end - CHUNK_FRAMES);
+            const auto count = static_cast<int>(end - first);
+            readChunk(audio, numChannels, first, count, chunk);
+
+            for (int hopEnd = count; hopEnd > 0; hopEnd -= HOP_FRAMES)
+            {
+                const int hop = juce::jmax(0, hopEnd - HOP_FRAMES);
+
+                if (findPeak(chunk, numChannels, hop, hopEnd - hop) < threshold)
+                    continue;
+
+                for (int i = hopEnd - 1; i >= hop; --i)
+                    if (isAbove(chunk, numChannels, i, threshold))
+                        return first + i;
+            }
+        }
+
+        return -1;
+    }
+
+    bool crossesZero(float a, float b)
+    {
+        return (a <= 0.0f && b >= 0.0f) || (a >= 0.0f && b <= 0.0f);
+    }
+
+    //==============================================================================
+    class PitchDetector
+    {
+    public:
+        PitchDetector()
+            : fft(PITCH_FFT_ORDER),
+              window(static_cast<size_t>(PITCH_WINDOW)),
+              work(static_cast<size_t>(2 << PITCH_FFT_ORDER)),
+              nsdf(static_cast<size_t>(PITCH_WINDOW / 2 + 2))
+        {
+        }
+
+        // Frequency and clarity (0..1) of the window's pitch; false if it has none clear enough
+        bool detect(const float *input, double sampleRate, double &frequency, float &clarity)
+        {
+            const int maxLag = juce::jmin(PITCH_WINDOW / 2, static_cast<int>(sampleRate / MIN_PITCH_HZ) + 1);
+            const int minLag = juce::jmax(2, static_cast<int>(sampleRate / MAX_PITCH_HZ));
+
+            // Without its DC offset, which would otherwise correlate at every lag
+            double mean = 0.0;
+
+            for (int i = 0; i < PITCH_WINDOW; ++i)
+                mean += input[i];
+
+            mean /= PITCH_WINDOW;
+
+            for (int i = 0; i < PITCH_WINDOW; ++i)
+                window[static_cast<size_t>(i)] = input[i] - static_cast<float>(mean);
+
+            const double energy = MeterEngine::sumOfSquares(window.data(), PITCH_WINDOW);
+
+            if (energy <= 1.0e-9)
+                return false;
+
+            // Autocorrelation as the inverse transform of the power spectrum; the window is padded
+            // to twice its length so lags don't wrap around
+            std::fill(work.begin(), work.end(), 0.0f);
+            std::copy(window.begin(), window.end(), work.begin());
+            fft.performRealOnlyForwardTransform(work.data(), true);
+
+            const int numBins = fft.getSize() / 2 + 1;
+
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                const float re = work[static_cast<size_t>(2 * bin)];
+                const float im = work[static_cast<size_t>(2 * bin + 1)];
+                work[static_cast<size_t>(2 * bin)] = re * re + im * im;
+                work[static_cast<size_t>(2 * bin + 1)] = 0.0f;
+            }
+
+            std::fill(work.begin() + 2 * numBins, work.end(), 0.0f);
+            fft.performRealOnlyInverseTransform(work.data());
+
+            if (work[0] <= 0.0f)
+                return false;
+
+            // Lag 0 is the energy, which gives the scale of this FFT backend's round trip
+            const double scale = energy / work[0];
+
+            // n(t) = 2 r(t) / m(t), where m(t) sums the squares of both overlapping parts
+            double m = 2.0 * energy;
+
+            for (int lag = 0; lag <= maxLag + 1; ++lag)
+            {
+                if (lag > 0)
+                {
+                    const float head = window[static_cast<size_t>(lag - 1)];
+                    const float tail = window[static_cast<size_t>(PITCH_WINDOW - lag)];
+                    m -= static_cast<double>(head) * head + static_cast<double>(tail) * tail;
+                }
+
+                nsdf[static_cast<size_t>(lag)] = m > 1.0e-12 ? static_cast<float>(2.0 * work[static_cast<size_t>(lag)] * scale / m) : 0.0f;
+            }
+
+            // Highest point of each positive lobe after the one around lag 0
+            std::array<int, 64> keyMaxima{};
+            int numKeyMaxima = 0;
+            float highest = 0.0f;
+            int lag = 1;
+
+            while (lag < maxLag && nsdf[static_cast<size_t>(lag)] > 0.0f)
+                ++lag;
+
+            while (lag < maxLag && numKeyMaxima < static_cast<int>(keyMaxima.size()))
+            {
+                while (lag < maxLag && nsdf[static_cast<size_t>(lag)] <= 0.0f)
+                    ++lag;
+
+                int best = -1;
+
+                for (; lag < maxLag && nsdf[static_cast<size_t>(lag)] > 0.0f; ++lag)
+                    if (lag >= minLag && (best < 0 || nsdf[static_cast<size_t>(lag)] > nsdf[static_cast<size_t>(best)]))
+                        best = lag;
+
+                if (best > 0)
+                {
+                    keyMaxima[static_cast<size_t>(numKeyMaxima++)] = best;
+                    highest = juce::jmax(highest, nsdf[static_cast<size_t>(best)]);
+                }
+            }
+
+            // The first key maximum nearly as high as the highest, so a strong harmonic isn't
+            // mistaken for the period, refined by fitting a parabola through its neighbours
+            for (int k = 0; k < numKeyMaxima; ++k)
+            {
+                const int peak = keyMaxima[static_cast<size_t>(k)];
+                const float b = nsdf[static_cast<size_t>(peak)];
+
+                if (b < KEY_MAXIMUM_RATIO * highest)
+                    continue;
+
+                const float a = nsdf[static_cast<size_t>(peak - 1)];
+                const float c = nsdf[static_cast<size_t>(peak + 1)];
+                const float curvature = a - 2.0f * b + c;
+                const float offset = curvature < 0.0f ? 0.5f * (a - c) / curvature : 0.0f;
+
+                frequency = sampleRate / (peak + offset);
+                clarity = juce::jmin(1.0f, b - 0.25f * (a - c) * offset);
+                return clarity >= MIN_CLARITY;
+            }
+
+            return false;
+        }
+
+    private:
+        juce::dsp::FFT fft;
+        std::vector<float> window, work, nsdf;
+    };
+
+    //==============================================================================
+    template <typename Audio>
+    SampleAnalysis analyseAudio(const Audio &audio, double sampleRate)
+    {
+        PROXY_TRACE_SCOPE("analyse sample");
+
+        SampleAnalysis result;
+        const auto numFrames = audio.getNumFrames();
+        const int numChannels = juce::jmin(MAX_CHANNELS, audio.getNumChannels());
+
+        if (numFrames <= 0 || numChannels <= 0 || sampleRate <= 0.0)
+            return result;
+
+        result.analysed = true;
+        result.endFrame = numFrames;
+
+        juce::AudioBuffer<float> chunk(numChannels, CHUNK_FRAMES);
+        std::vector<float> mix, scratch;
+
+        // Peak over the whole sample and BS.1770 loudness over up to MAX_LOUDNESS_SECONDS of it
+        {
+            MeterEngine meter;
+            meter.prepare(sampleRate, CHUNK_FRAMES);
+
+            const auto loudnessFrames = static_cast<juce::int64>(MAX_LOUDNESS_SECONDS * sampleRate);
+
+            for (juce::int64 first = 0; first < numFrames; first += CHUNK_FRAMES)
+            {
+                const auto count = static_cast<int>(juce::jmin<juce::int64>(CHUNK_FRAMES, numFrames - first));
+                readChunk(audio, numChannels, first, count, chunk);
+
+                result.peak = juce::jmax(result.peak, findPeak(chunk, numChannels, 0, count));
+
+                if (first < loudnessFrames)
+                    meter.process(chunk, count);
+            }
+
+            result.loudnessLufs = meter.getSnapshot().integratedLufs;
+        }
+
+        if (result.peak <= 0.0f)
+            return result;
+
+        // Start at the first transient, backed off to the zero crossing just before it
+        const auto onset = findFirstAbove(audio, numChannels, result.peak * juce::Decibels::decibelsToGain(ONSET_DB), chunk);
+
+        if (onset > 0)
+        {
+            const auto backOff = static_cast<int>(juce::jmin<juce::int64>(onset, static_cast<juce::int64>(ONSET_BACK_OFF_SECONDS * sampleRate)));
+            readMix(audio, numChannels, onset - backOff, backOff + 1, mix, scratch);
+            result.startFrame = onset - backOff;
+
+            for (int i = backOff; i > 0; --i)
+            {
+                if (crossesZero(mix[static_cast<size_t>(i - 1)], mix[static_cast<size_t>(i)]))
+                {
+                    const bool before = std::abs(mix[static_cast<size_t>(i - 1)]) < std::abs(mix[static_cast<size_t>(i)]);
+                    result.startFrame = onset - backOff + i - (before ? 1 : 0);
+                    break;
+                }
+            }
+        }
+
+        // End once the tail has faded out, carried on to the next zero crossing
+        const auto last = findLastAbove(audio, numChannels, result.peak * juce::Decibels::decibelsToGain(TAIL_DB), chunk);
+
+        if (last >= 0 && last + 1 < numFrames)
+        {
+            const auto reach = static_cast<int>(juce::jmin<juce::int64>(numFrames - last - 1, static_cast<juce::int64>(TAIL_SEARCH_SECONDS * sampleRate)));
+            readMix(audio, numChannels, last, reach + 1, mix, scratch);
+            result.endFrame = last + reach + 1;
+
+            for (int i = 1; i <= reach; ++i)
+            {
+                if (crossesZero(mix[static_cast<size_t>(i - 1)], mix[static_cast<size_t>(i)]))
+                {
+                    result.endFrame = last + i + 1;
+                    break;
+                }
+            }
+        }
+
+        result.endFrame = juce::jmax(result.endFrame, result.startFrame + 1);
+
+        // Sounds too short for a gated loudness block are measured unweighted over their audible part
+        if (result.loudnessLufs <= SampleAnalysis::SILENCE_LUFS)
+        {
+            double sum = 0.0;
+
+            for (auto first = result.startFrame; first < result.endFrame; first += CHUNK_FRAMES)
+            {
+                const auto count = static_cast<int>(juce::jmin<juce::int64>(CHUNK_FRAMES, result.endFrame - first));
+                readChunk(audio, numChannels, first, count, chunk);
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    sum += MeterEngine::sumOfSquares(chunk.getReadPointer(channel), count);
+            }
+
+            const double meanSquare = sum / static_cast<double>(result.endFrame - result.startFrame);
+
+            if (meanSquare > 1.0e-10)
+                result.loudnessLufs = juce::jmax(SampleAnalysis::SILENCE_LUFS, static_cast<float>(-0.691 + 10.0 * std::log10(meanSquare)));
+        }
+
+        // Root pitch: the median over the windows loud enough to judge, if most of them agree there is one
+        {
+            PitchDetector detector;
+            const auto audible = result.endFrame - result.startFrame;
+            const auto skip = juce::jlimit<juce::int64>(0, juce::jmax<juce::int64>(0, (audible - PITCH_WINDOW) / 2),
+                                                        static_cast<juce::int64>(PITCH_SKIP_SECONDS * sampleRate));
+            const auto firstWindow = result.startFrame + skip;
+            const auto numWindows = static_cast<int>(juce::jlimit<juce::int64>(1, MAX_PITCH_WINDOWS, (result.endFrame - firstWindow) / PITCH_WINDOW));
+            const float quietest = result.peak * juce::Decibels::decibelsToGain(PITCH_WINDOW_DB);
+
+            std::vector<double> notes;
+            int numJudged = 0;
+            float totalClarity = 0.0f;
+
+            for (int w = 0; w < numWindows; ++w)
+            {
+                readMix(audio, numChannels, firstWindow + static_cast<juce::int64>(w) * PITCH_WINDOW, PITCH_WINDOW, mix, scratch);
+                juce::FloatVectorOperations::multiply(mix.data(), 1.0f / static_cast<float>(numChannels), PITCH_WINDOW);
+
+                if (std::sqrt(MeterEngine::sumOfSquares(mix.data(), PITCH_WINDOW) / PITCH_WINDOW) < quietest)
+                    continue;
+
+                ++numJudged;
+
+                double frequency = 0.0;
+                float clarity = 0.0f;
+
+                if (detector.detect(mix.data(), sampleRate, frequency, clarity))
+                {
+                    notes.push_back(69.0 + 12.0 * std::log2(frequency / 440.0));
+                    totalClarity += clarity;
+                }
+            }
+
+            if (!notes.empty() && static_cast<int>(notes.size()) * 2 >= numJudged)
+            {
+                std::sort(notes.begin(), notes.end());
+                const size_t middle = notes.size() / 2;
+
+                result.pitched = true;
+                result.rootNote = notes.size() % 2 == 1 ? notes[middle] : 0.5 * (notes[middle - 1] + notes[middle]);
+                result.pitchConfidence = totalClarity / static_cast<float>(numJudged);
+            }
+        }
+
+        return result;
+    }
+}
+
+//==============================================================================
+float SampleAnalysis::getNormalisationGain() const
+{
+    if (!analysed || loudnessLufs <= SILENCE_LUFS || peak <= 0.0f)
+        return 1.0f;
+
+    const float gain = juce::Decibels::decibelsToGain(juce::jlimit(-MAX_GAIN_DB, MAX_GAIN_DB, TARGET_LUFS - loudnessLufs));
+    return juce::jmin(gain, PEAK_CEILING / peak);
+}
+
+SampleAnalysis SampleAnalysis::analyse(const PagedAudioBuffer &audio, double sampleRate)
+{
+    return analyseAudio(audio, sampleRate);
+}
+
+SampleAnalysis SampleAnalysis::analyse(const CompressedAudioBuffer &audio, double sampleRate)
+{
+    return analyseAudio(audio, sampleRate);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PagedAudioBuffer.h"
+#include "CompressedAudioBuffer.h"
+
+// What the background analysis found out about a sample: its root pitch, loudness and peak, and
+// where the sound really starts and ends. Samples are analysed on the loading thread when their
+// file is indexed, and the results are kept in the SampleIndex, so an unchanged file is only
+// analysed once. A sound made from an analysed sample is tuned to its root, normalised to
+// TARGET_LUFS and played from its first transient to where it has faded out.
+struct SampleAnalysis
+{
+    // Bump whenever the results would change, so the index doesn't hand back stale ones
+    static constexpr int VERSION = 1;
+
+    static constexpr double DEFAULT_ROOT_NOTE = 60.0;
+    static constexpr float SILENCE_LUFS = -100.0f; // as MeterSnapshot
+    static constexpr float TARGET_LUFS = -18.0f;
+    static constexpr float PEAK_CEILING = 0.891f; // -1 dBFS
+    static constexpr float MAX_GAIN_DB = 24.0f;
+
+    bool analysed = false;
+
+    // MIDI note of the steady pitch, cents included; only meaningful if pitched
+    bool pitched = false;
+    double rootNote = DEFAULT_ROOT_NOTE;
+    float pitchConfidence = 0.0f; // 0..1
+
+    // Integrated loudness (unweighted for sounds shorter than one loudness block) and sample peak
+    float loudnessLufs = SILENCE_LUFS;
+    float peak = 0.0f;
+
+    // Frames from the first transient, backed off to a zero crossing, to the end of the audible
+    // part, carried on to the next zero crossing; end is exclusive
+    juce::int64 startFrame = 0;
+    juce::int64 endFrame = 0;
+
+    double getRootNote() const { return pitched ? rootNote : DEFAULT_ROOT_NOTE; }
+
+    // Gain that brings the loudness to TARGET_LUFS without pushing the peak over PEAK_CEILING
+    float getNormalisationGain() const;
+
+    // Analyse decoded or compressed audio (any thread but the audio thread)
+    static SampleAnalysis analyse(const PagedAudioBuffer &audio, double sampleRate);
+    static SampleAnalysis analyse(const CompressedAudioBuffer &audio, double sampleRate);
+};
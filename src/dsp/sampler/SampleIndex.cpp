@@ -0,0 +1,217 @@
+#include "SampleIndex.h"
+#include "Trace.h"
+
+SampleIndex::SampleIndex(const juce::File &file)
+    : indexFile(file)
+{
+}
+
+void SampleIndex::ensureLoaded()
+{
+    if (loaded)
+        return;
+
+    loaded = true;
+
+    if (auto xml = juce::parseXML(indexFile))
+    {
+        for (auto *element : xml->getChildWithTagNameIterator("File"))
+        {
+            Entry entry;
+            entry.size = element->getStringAttribute("size").getLargeIntValue();
+            entry.modified = element->getStringAttribute("modified").getLargeIntValue();
+            entry.hash = element->getStringAttribute("hash");
+
+            // Results of an older analysis are left for the file to be analysed again
+            if (element->getIntAttribute("analysis") == SampleAnalysis::VERSION)
+            {
+                auto &analysis = entry.analysis;
+                analysis.analysed = true;
+                analysis.pitched = element->getBoolAttribute("pitched");
+                analysis.rootNote = element->getDoubleAttribute("root", SampleAnalysis::DEFAULT_ROOT_NOTE);
+                analysis.pitchConfidence = static_cast<float>(element->getDoubleAttribute("confidence"));
+                analysis.loudnessLufs = static_cast<float>(element->getDoubleAttribute("lufs", SampleAnalysis::SILENCE_LUFS));
+                analysis.peak = static_cast<float>(element->getDoubleAttribute("peak"));
+                analysis.startFrame = element->getStringAttribute("start").getLargeIntValue();
+                analysis.endFrame = element->getStringAttribute("end").getLargeIntValue();
+            }
+
+            if (entry.hash.isNotEmpty())
+                entries[element->getStringAttribute("path")] = entry;
+        }
+    }
+}
+
+juce::String SampleIndex::getHash(const juce::File &file)
+{
+    const juce::String path = file.getFullPathName();
+    const juce::int64 size = file.getSize();
+    const juce::int64 modified = file.getLastModificationTime().toMilliseconds();
+
+    {
+        const juce::ScopedLock sl(lock);
+        ensureLoaded();
+
+        auto it = entries.find(path);
+
+        if (it != entries.end() && it->second.size == size && it->second.modified == modified)
+            return it->second.hash;
+    }
+
+    // Hashed without the lock, so other threads can look files up meanwhile
+    const juce::String hash = computeHash(file);
+
+    if (hash.isNotEmpty())
+    {
+        const juce::ScopedLock sl(lock);
+        entries[path] = {size, modified, hash};
+        changed = true;
+    }
+
+    return hash;
+}
+
+SampleIndex::Entry *SampleIndex::findCurrent(const juce::File &file)
+{
+    ensureLoaded();
+
+    auto it = entries.find(file.getFullPathName());
+
+    if (it == entries.end() || it->second.size != file.getSize() || it->second.modified != file.getLastModificationTime().toMilliseconds())
+        return nullptr;
+
+    return &it->second;
+}
+
+bool SampleIndex::getAnalysis(const juce::File &file, SampleAnalysis &analysis)
+{
+    const juce::ScopedLock sl(lock);
+    auto *entry = findCurrent(file);
+
+    if (entry == nullptr || !entry->analysis.analysed)
+        return false;
+
+    analysis = entry->analysis;
+    return true;
+}
+
+void SampleIndex::setAnalysis(const juce::File &file, const SampleAnalysis &analysis)
+{
+    const juce::ScopedLock sl(lock);
+
+    if (auto *entry = findCurrent(file))
+    {
+        entry->analysis = analysis;
+        changed = true;
+    }
+}
+
+juce::File SampleIndex::findFile(const juce::String &hash)
+{
+    if (hash.isEmpty())
+        return {};
+
+    juce::StringArray candidates;
+
+    {
+        const juce::ScopedLock sl(lock);
+        ensureLoaded();
+
+        for (const auto &pair : entries)
+            if (pair.second.hash == hash)
+                candidates.add(pair.first);
+    }
+
+    // The file may have changed since it was indexed
+    for (const auto &path : candidates)
+    {
+        const juce::File file(path);
+
+        if (file.existsAsFile() && getHash(file) == hash)
+            return file;
+    }
+
+    return {};
+}
+
+void SampleIndex::save()
+{
+    const juce::ScopedLock sl(lock);
+
+    if (!changed)
+        return;
+
+    juce::XmlElement xml("SampleIndex");
+    xml.setAttribute("version", 2);
+
+    for (const auto &pair : entries)
+    {
+        if (!juce::File(pair.first).existsAsFile())
+            continue;
+
+        auto *element = xml.createNewChildElement("File");
+        element->setAttribute("path", pair.first);
+        element->setAttribute("size", juce::String(pair.second.size));
+        element->setAttribute("modified", juce::String(pair.second.modified));
+        element->setAttribute("hash", pair.second.hash);
+
+        const auto &analysis = pair.second.analysis;
+
+        if (analysis.analysed)
+        {
+            element->setAttribute("analysis", SampleAnalysis::VERSION);
+            element->setAttribute("pitched", analysis.pitched);
+            element->setAttribute("root", analysis.rootNote);
+            element->setAttribute("confidence", analysis.pitchConfidence);
+            element->setAttribute("lufs", analysis.loudnessLufs);
+            element->setAttribute("peak", analysis.peak);
+            element->setAttribute("start", juce::String(analysis.startFrame));
+            element->setAttribute("end", juce::String(analysis.endFrame));
+        }
+    }
+
+    indexFile.getParentDirectory().createDirectory();
+
+    if (xml.writeTo(indexFile))
+        changed = false;
+}
+
+juce::String SampleIndex::computeHash(const juce::File &file)
+{
+    PROXY_TRACE_SCOPE("hash file");
+
+    juce::FileInputStream stream(file);
+
+    if (!stream.openedOk())
+        return {};
+
+    // 64-bit FNV-1a over 8-byte words, seeded with the length; not cryptographic, just a
+    // fingerprint cheap enough to run over whole files
+    constexpr juce::uint64 prime = 0x100000001b3ull;
+    juce::uint64 hash = 0xcbf29ce484222325ull ^ static_cast<juce::uint64>(stream.getTotalLength());
+
+    juce::HeapBlock<char> chunk(1 << 16);
+
+    for (;;)
+    {
+        const int bytesRead = stream.read(chunk.get(), 1 << 16);
+
+        if (bytesRead <= 0)
+            break;
+
+        int i = 0;
+
+        for (; i + 8 <= bytesRead; i += 8)
+        {
+            juce::uint64 word;
+            std::memcpy(&word, chunk.get() + i, sizeof(word));
+            hash = (hash ^ word) * prime;
+            hash ^= hash >> 29;
+        }
+
+        for (; i < bytesRead; ++i)
+            hash = (hash ^ static_cast<juce::uint8>(chunk[i])) * prime;
+    }
+
+    return juce::String::toHexString(static_cast<juce::int64>(hash)).paddedLeft('0', 16);
+}
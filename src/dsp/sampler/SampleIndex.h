@@ -0,0 +1,58 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <unordered_map>
+#include "SampleAnalysis.h"
+
+// Persistent record of the sample files that have been loaded: a content hash and analysis for
+// each file, kept with its size and modification time so they are only recomputed when the file changes.
+// A saved project names its sample by hash, so the file can be found again from here
+// (even after it was renamed or moved) without decoding the library first.
+// All methods are thread-safe; background loaders use the index as well as the message thread.
+class SampleIndex
+{
+public:
+    // The index lives in indexFile; it is read on first use and written by save()
+    explicit SampleIndex(const juce::File &indexFile);
+
+    // Content hash of a file, or an empty string if it can't be read
+    juce::String getHash(const juce::File &file);
+
+    // The analysis stored for a file, if it is indexed, unchanged since and was analysed
+    bool getAnalysis(const juce::File &file, SampleAnalysis &analysis);
+
+    // Store a file's analysis with its hash; files that haven't been hashed are left out
+    void setAnalysis(const juce::File &file, const SampleAnalysis &analysis);
+
+    // An indexed file with this content that still exists, or File() if there is none
+    juce::File findFile(const juce::String &hash);
+
+    // Write the index if anything changed, dropping files that no longer exist
+    void save();
+
+    // 64-bit hash of a file's bytes as 16 hex digits
+    static juce::String computeHash(const juce::File &file);
+
+private:
+    struct Entry
+    {
+        juce::int64 size = 0;
+        juce::int64 modified = 0; // milliseconds since the epoch
+        juce::String hash;
+        SampleAnalysis analysis; // not analysed until setAnalysis()
+    };
+
+    const juce::File indexFile;
+    std::unordered_map<juce::String, Entry> entries; // by full path
+    bool loaded = false;
+    bool changed = false;
+    juce::CriticalSection lock;
+
+    // Read the index file the first time it is needed; called with the lock held
+    void ensureLoaded();
+
+    // The entry for a file if it is indexed and unchanged, or null; called with the lock held
+    Entry *findCurrent(const juce::File &file);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleIndex)
+};
@@ -1,4 +1,6 @@
 #include "SampleLibrary.h"
+#include "Trace.h"
+#include <set>
 
 SampleLibrary::SampleLibrary()
 {
@@ -7,36 +9,26 @@ SampleLibrary::SampleLibrary()
 
 SampleLibrary::~SampleLibrary()
 {
+    // Loading jobs use the format manager and index, so they must finish first;
+    // their results are posted through a weak reference and are dropped once we're gone
+    loadingJobs.removeAllJobs(true, 10000);
+
+    // Pending mipmap jobs own everything they use, so they can simply be dropped
+    backgroundJobs.removeAllJobs(true, 2000);
     clear();
 }
 
-bool SampleLibrary::loadFromFile(const juce::String &name, const juce::File &file, const juce::String &category)
+void SampleLibrary::storeSample(SampleData newSample)
 {
-    if (!file.existsAsFile())
-        return false;
-
-    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
-
-    if (reader == nullptr)
-        return false;
-
-    auto numChannels = static_cast<int>(reader->numChannels);
-    auto lengthInSamples = static_cast<int>(reader->lengthInSamples);
-
-    if (numChannels == 0 || lengthInSamples == 0)
-        return false;
+    const juce::String name = newSample.name;
+    const juce::String category = newSample.category;
 
-    SampleData newSample;
-    newSample.buffer = std::make_unique<juce::AudioBuffer<float>>(numChannels, lengthInSamples);
-    newSample.sampleRate = reader->sampleRate;
-    newSample.maxLength = lengthInSamples;
-    newSample.name = name;
-    newSample.category = category;
-
-    reader->read(newSample.buffer.get(), 0, lengthInSamples, 0, true, true);
+    applyStorageMode(newSample);
+    watchMipmap(newSample);
 
     // Store the sample in the main samples map
     samples[name] = std::move(newSample);
+    ++revision;
 
     // Add to category list
     if (category.isNotEmpty())
@@ -48,12 +40,383 @@ bool SampleLibrary::loadFromFile(const juce::String &name, const juce::File &fil
         // Use "Uncategorized" for samples without a category
         categories["Uncategorized"].addIfNotAlreadyThere(name);
     }
+}
+
+void SampleLibrary::applyStorageMode(SampleData &sample)
+{
+    const bool shouldCompress = compressedStorage && sample.bitsPerSample > 0;
+    const bool isCompressed = sample.compressed != nullptr;
+
+    if (sample.mipmap != nullptr && shouldCompress == isCompressed)
+        return;
+
+    // Another instance may already have converted it and built the mipmap
+    if (poolSharing && pool->findStorage(sample.contentHash, shouldCompress, sample))
+        return;
+
+    // Float audio to build the mipmap from; a compressed sample only keeps it until the build is done
+    std::shared_ptr<const PagedAudioBuffer> source = sample.buffer;
+
+    if (isCompressed)
+        source = sample.compressed->decompress();
+
+    if (source == nullptr)
+        return;
+
+    if (shouldCompress && !isCompressed)
+    {
+        PROXY_TRACE_SCOPE("compress sample");
+        sample.compressed = CompressedAudioBuffer::compress(*source, sample.bitsPerSample, false);
+        sample.buffer = nullptr;
+    }
+    else if (!shouldCompress && isCompressed)
+    {
+        sample.buffer = source;
+        sample.compressed = nullptr;
+    }
+
+    // Pitched-up playback reads from pre-filtered octaves, built off the loading thread
+    auto mipmap = std::make_shared<SampleMipmap>();
+    sample.mipmap = mipmap;
+
+    backgroundJobs.addJob([mipmap, source, compressionBits = shouldCompress ? sample.bitsPerSample : 0]
+                          {
+                              PROXY_TRACE_SCOPE("build mipmap");
+                              mipmap->build(*source, compressionBits);
+                          });
+
+    if (poolSharing)
+        pool->share(sample);
+}
+
+void SampleLibrary::watchMipmap(const SampleData &sample)
+{
+    if (sample.mipmap == nullptr || sample.mipmap->isReady())
+        return;
+
+    juce::WeakReference<SampleLibrary> weakThis(this);
+    const auto *mipmap = sample.mipmap.get();
+
+    sample.mipmap->whenReady([weakThis, mipmap]
+                             {
+                                 auto *library = weakThis.get();
+
+                                 if (library == nullptr || !library->onMipmapReady)
+                                     return;
+
+                                 // Every sample still holding it; one converted meanwhile has a new mipmap
+                                 juce::StringArray names;
+
+                                 for (const auto &pair : library->samples)
+                                     if (pair.second.mipmap.get() == mipmap)
+                                         names.add(pair.first);
+
+                                 for (const auto &name : names)
+                                     library->onMipmapReady(name);
+                             });
+}
+
+void SampleLibrary::setCompressedStorage(bool shouldCompress, std::function<void(const juce::String &)> onConverted)
+{
+    if (compressedStorage == shouldCompress)
+        return;
+
+    compressedStorage = shouldCompress;
+
+    juce::WeakReference<SampleLibrary> weakThis(this);
+
+    // Each sample is converted on the loading thread from a copy sharing its audio, then swapped in
+    for (const auto &pair : samples)
+    {
+        const juce::String name = pair.first;
+        auto sample = std::make_shared<SampleData>(getSampleAudioBuffer(name));
+        const auto *original = sample->buffer != nullptr ? static_cast<const void *>(sample->buffer.get())
+                                                         : static_cast<const void *>(sample->compressed.get());
+
+        loadingJobs.addJob([this, weakThis, name, sample, original, onConverted]
+                           {
+                               PROXY_TRACE_SCOPE("convert sample storage");
+
+                               applyStorageMode(*sample);
+
+                               juce::MessageManager::callAsync([weakThis, name, sample, original, onConverted]
+                                                               {
+                                                                   auto *library = weakThis.get();
+
+                                                                   if (library == nullptr)
+                                                                       return;
+
+                                                                   // Dropped if the sample was removed or reloaded meanwhile
+                                                                   auto it = library->samples.find(name);
+
+                                                                   if (it == library->samples.end())
+                                                                       return;
+
+                                                                   auto &stored = it->second;
+
+                                                                   if (stored.buffer.get() != original && stored.compressed.get() != original)
+                                                                       return;
+
+                                                                   // Only the storage; loops edited meanwhile are kept
+                                                                   stored.buffer = sample->buffer;
+                                                                   stored.compressed = sample->compressed;
+                                                                   stored.mipmap = sample->mipmap;
+                                                                   library->watchMipmap(stored);
+
+                                                                   if (onConverted)
+                                                                       onConverted(name);
+                                                               });
+                           });
+    }
+}
+
+size_t SampleLibrary::getResidentBytes() const
+{
+    size_t bytes = 0;
+
+    for (const auto &pair : samples)
+    {
+        const auto &sample = pair.second;
+
+        if (sample.buffer != nullptr)
+            bytes += sample.buffer->getSizeInBytes();
+
+        if (sample.compressed != nullptr)
+            bytes += sample.compressed->getSizeInBytes();
+
+        if (sample.mipmap != nullptr)
+            bytes += sample.mipmap->getSizeInBytes();
+    }
+
+    return bytes;
+}
+
+bool SampleLibrary::loadFromFile(const juce::String &name, const juce::File &file, const juce::String &category)
+{
+    auto newSample = decodeFile(name, file, category);
+
+    if (newSample.getNumFrames() == 0)
+        return false;
+
+    storeSample(std::move(newSample));
 
     return true;
 }
 
+SampleData SampleLibrary::decodeFile(const juce::String &name, const juce::File &file, const juce::String &category)
+{
+    if (!file.existsAsFile())
+        return {};
+
+    // Another instance may already hold this content, in which case nothing is decoded
+    const auto contentHash = pool->getIndex().getHash(file);
+    auto read = [this, &file] { return readAudioFile(file); };
+
+    SampleData newSample = poolSharing ? pool->acquire(contentHash, compressedStorage, read) : read();
+
+    if (newSample.getNumFrames() == 0)
+        return newSample;
+
+    newSample.name = name;
+    newSample.category = category;
+    newSample.file = file;
+    newSample.contentHash = contentHash;
+    newSample.analysis = analyse(newSample);
+
+    return newSample;
+}
+
+SampleAnalysis SampleLibrary::analyse(const SampleData &sample)
+{
+    SampleAnalysis analysis;
+
+    // Only once per version of the file
+    if (sample.file.existsAsFile() && pool->getIndex().getAnalysis(sample.file, analysis))
+        return analysis;
+
+    if (sample.buffer != nullptr)
+        analysis = SampleAnalysis::analyse(*sample.buffer, sample.sampleRate);
+    else if (sample.compressed != nullptr)
+        analysis = SampleAnalysis::analyse(*sample.compressed, sample.sampleRate);
+
+    if (sample.file.existsAsFile())
+        pool->getIndex().setAnalysis(sample.file, analysis);
+
+    return analysis;
+}
+
+SampleData SampleLibrary::readAudioFile(const juce::File &file)
+{
+    PROXY_TRACE_SCOPE("decode file");
+
+    SampleData newSample;
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if (reader == nullptr)
+        return newSample;
+
+    // Decoded a page at a time, so the length is never limited to an int
+    std::shared_ptr<const PagedAudioBuffer> audio = PagedAudioBuffer::fromReader(*reader);
+
+    if (audio == nullptr)
+        return newSample;
+
+    newSample.buffer = std::move(audio);
+    newSample.sampleRate = reader->sampleRate;
+    newSample.maxLength = newSample.buffer->getNumFrames();
+    newSample.bitsPerSample = reader->usesFloatingPointData || reader->bitsPerSample < 8 || reader->bitsPerSample > 24 ? 0 : static_cast<int>(reader->bitsPerSample);
+
+    readLoopPoints(reader->metadataValues, newSample);
+
+    return newSample;
+}
+
+juce::File SampleLibrary::resolveReference(const SampleReference &reference)
+{
+    // Same content wherever it is now, then the file it was saved from
+    auto file = pool->getIndex().findFile(reference.contentHash);
+
+    if (file.existsAsFile())
+        return file;
+
+    if (reference.file.existsAsFile())
+        return reference.file;
+
+    // Older projects only have the name; look for it in the samples folder
+    if (reference.name.isNotEmpty())
+    {
+        for (const auto &candidate : getSamplesFolder().findChildFiles(juce::File::findFiles, true, "*.wav;*.aif;*.aiff;*.mp3"))
+            if (candidate.getFileNameWithoutExtension() == reference.name)
+                return candidate;
+    }
+
+    return {};
+}
+
+void SampleLibrary::loadInBackground(const SampleReference &reference, std::function<void(const juce::String &)> onLoaded)
+{
+    juce::WeakReference<SampleLibrary> weakThis(this);
+
+    loadingJobs.addJob([this, weakThis, reference, onLoaded]
+                       {
+                           PROXY_TRACE_SCOPE("load sample in background");
+
+                           const auto file = resolveReference(reference);
+                           auto sample = std::make_shared<SampleData>();
+
+                           if (file != juce::File())
+                           {
+                               // Filed under its folder, as the folder scan would
+                               const auto folder = file.getParentDirectory();
+                               *sample = decodeFile(file.getFileNameWithoutExtension(), file, folder.getFileName());
+                               pool->getIndex().save();
+                           }
+
+                           juce::MessageManager::callAsync([weakThis, sample, onLoaded]
+                                                           {
+                                                               auto *library = weakThis.get();
+
+                                                               if (library == nullptr)
+                                                                   return;
+
+                                                               const juce::String name = sample->name;
+
+                                                               if (sample->getNumFrames() > 0)
+                                                                   library->storeSample(std::move(*sample));
+
+                                                               onLoaded(library->containsSample(name) ? name : juce::String());
+                                                           });
+                       });
+}
+
+void SampleLibrary::addRecording(SampleData recording, std::function<void(const juce::String &)> onAdded)
+{
+    juce::WeakReference<SampleLibrary> weakThis(this);
+    auto sample = std::make_shared<SampleData>(std::move(recording));
+
+    loadingJobs.addJob([this, weakThis, sample, onAdded]
+                       {
+                           PROXY_TRACE_SCOPE("index recording");
+
+                           sample->contentHash = pool->getIndex().getHash(sample->file);
+                           sample->analysis = analyse(*sample);
+                           pool->getIndex().save();
+
+                           juce::MessageManager::callAsync([weakThis, sample, onAdded]
+                                                           {
+                                                               auto *library = weakThis.get();
+
+                                                               if (library == nullptr)
+                                                                   return;
+
+                                                               const juce::String name = sample->name;
+                                                               library->storeSample(std::move(*sample));
+                                                               onAdded(name);
+                                                           });
+                       });
+}
+
+void SampleLibrary::scanUserSamplesFolderInBackground(std::function<void()> onFinished, bool replaceLoaded)
+{
+    juce::WeakReference<SampleLibrary> weakThis(this);
+
+    loadingJobs.addJob([this, weakThis, onFinished, replaceLoaded]
+                       {
+                           PROXY_TRACE_SCOPE("scan samples folder in background");
+
+                           // Same layout as scanFolderAndSubfoldersForSamples(): the root and each subfolder
+                           const auto root = getSamplesFolder();
+                           juce::Array<juce::File> folders{root};
+                           folders.addArray(root.findChildFiles(juce::File::findDirectories, false));
+
+                           auto decoded = std::make_shared<std::vector<SampleData>>();
+                           std::set<juce::String> names;
+
+                           for (const auto &folder : folders)
+                           {
+                               for (const auto &file : findAudioFiles(folder))
+                               {
+                                   const auto name = file.getFileNameWithoutExtension();
+
+                                   if (!names.insert(name).second)
+                                       continue;
+
+                                   auto sample = decodeFile(name, file, folder.getFileName());
+
+                                   if (sample.getNumFrames() > 0)
+                                       decoded->push_back(std::move(sample));
+                               }
+                           }
+
+                           pool->getIndex().save();
+
+                           juce::MessageManager::callAsync([weakThis, decoded, onFinished, replaceLoaded]
+                                                           {
+                                                               auto *library = weakThis.get();
+
+                                                               if (library == nullptr)
+                                                                   return;
+
+                                                               // A refresh drops samples whose files have gone, in one step
+                                                               if (replaceLoaded)
+                                                                   library->clear();
+
+                                                               // Samples already loaded meanwhile (a restore, say) are kept
+                                                               for (auto &sample : *decoded)
+                                                                   if (!library->containsSample(sample.name))
+                                                                       library->storeSample(std::move(sample));
+
+                                                               if (onFinished)
+                                                                   onFinished();
+                                                           });
+                       });
+}
+
 bool SampleLibrary::loadFromStream(const juce::String &name, juce::InputStream &stream, const juce::String &category)
 {
+    PROXY_TRACE_SCOPE("decode stream");
+
     // Read the data from the stream into a MemoryBlock
     juce::MemoryBlock memoryBlock;
     stream.readIntoMemoryBlock(memoryBlock);
@@ -67,34 +430,23 @@ bool SampleLibrary::loadFromStream(const juce::String &name, juce::InputStream &
     if (reader == nullptr)
         return false;
 
-    auto numChannels = static_cast<int>(reader->numChannels);
-    auto lengthInSamples = static_cast<int>(reader->lengthInSamples);
+    // Decoded a page at a time, so the length is never limited to an int
+    std::shared_ptr<const PagedAudioBuffer> audio = PagedAudioBuffer::fromReader(*reader);
 
-    if (numChannels == 0 || lengthInSamples == 0)
+    if (audio == nullptr)
         return false;
 
     SampleData newSample;
-    newSample.buffer = std::make_unique<juce::AudioBuffer<float>>(numChannels, lengthInSamples);
+    newSample.buffer = std::move(audio);
     newSample.sampleRate = reader->sampleRate;
-    newSample.maxLength = lengthInSamples;
+    newSample.maxLength = newSample.buffer->getNumFrames();
+    newSample.bitsPerSample = reader->usesFloatingPointData || reader->bitsPerSample < 8 || reader->bitsPerSample > 24 ? 0 : static_cast<int>(reader->bitsPerSample);
     newSample.name = name;
     newSample.category = category;
 
-    reader->read(newSample.buffer.get(), 0, lengthInSamples, 0, true, true);
-
-    // Store the sample in the main samples map
-    samples[name] = std::move(newSample);
+    readLoopPoints(reader->metadataValues, newSample);
 
-    // Add to category list
-    if (category.isNotEmpty())
-    {
-        categories[category].addIfNotAlreadyThere(name);
-    }
-    else
-    {
-        // Use "Uncategorized" for samples without a category
-        categories["Uncategorized"].addIfNotAlreadyThere(name);
-    }
+    storeSample(std::move(newSample));
 
     return true;
 }
@@ -105,26 +457,13 @@ bool SampleLibrary::loadFromBuffer(const juce::String &name, const juce::AudioBu
         return false;
 
     SampleData newSample;
-    newSample.buffer = std::make_unique<juce::AudioBuffer<float>>(buffer.getNumChannels(), buffer.getNumSamples());
-    newSample.buffer->makeCopyOf(buffer);
+    newSample.buffer = PagedAudioBuffer::fromBuffer(buffer);
     newSample.sampleRate = sampleRate;
     newSample.maxLength = buffer.getNumSamples();
     newSample.name = name;
     newSample.category = category;
 
-    // Store the sample in the main samples map
-    samples[name] = std::move(newSample);
-
-    // Add to category list
-    if (category.isNotEmpty())
-    {
-        categories[category].addIfNotAlreadyThere(name);
-    }
-    else
-    {
-        // Use "Uncategorized" for samples without a category
-        categories["Uncategorized"].addIfNotAlreadyThere(name);
-    }
+    storeSample(std::move(newSample));
 
     return true;
 }
@@ -138,20 +477,20 @@ SampleData SampleLibrary::getSampleAudioBuffer(const juce::String &name) const
         // Create a new SampleData object and return it
         SampleData result;
 
-        // Deep copy the audio buffer if it exists
-        if (it->second.buffer)
-        {
-            result.buffer = std::make_unique<juce::AudioBuffer<float>>(
-                it->second.buffer->getNumChannels(),
-                it->second.buffer->getNumSamples());
-            result.buffer->makeCopyOf(*(it->second.buffer));
-        }
-
-        // Copy other properties
+        // The audio is never written after loading, so it is shared rather than copied
+        result.buffer = it->second.buffer;
+        result.compressed = it->second.compressed;
+        result.mipmap = it->second.mipmap;
         result.sampleRate = it->second.sampleRate;
         result.maxLength = it->second.maxLength;
+        result.bitsPerSample = it->second.bitsPerSample;
         result.name = it->second.name;
         result.category = it->second.category;
+        result.file = it->second.file;
+        result.contentHash = it->second.contentHash;
+        result.sustainLoop = it->second.sustainLoop;
+        result.releaseLoop = it->second.releaseLoop;
+        result.analysis = it->second.analysis;
 
         return result;
     }
@@ -207,6 +546,91 @@ juce::String SampleLibrary::getSampleCategory(const juce::String &name) const
     return ""; // Return empty string if sample not found
 }
 
+juce::String SampleLibrary::findSampleByHash(const juce::String &contentHash) const
+{
+    if (contentHash.isEmpty())
+        return {};
+
+    for (const auto &pair : samples)
+        if (pair.second.contentHash == contentHash)
+            return pair.first;
+
+    return {};
+}
+
+bool SampleLibrary::setSampleLoops(const juce::String &name, const SampleLoop &sustainLoop, const SampleLoop &releaseLoop)
+{
+    auto it = samples.find(name);
+    if (it == samples.end())
+        return false;
+
+    // Keep the loops inside the sample
+    auto clampLoop = [length = it->second.maxLength](SampleLoop loop)
+    {
+        loop.start = juce::jlimit<juce::int64>(0, length, loop.start);
+        loop.end = juce::jlimit<juce::int64>(0, length, loop.end);
+        return loop.isEnabled() ? loop : SampleLoop();
+    };
+
+    it->second.sustainLoop = clampLoop(sustainLoop);
+    it->second.releaseLoop = clampLoop(releaseLoop);
+    return true;
+}
+
+void SampleLibrary::readLoopPoints(const juce::StringPairArray &metadata, SampleData &sample)
+{
+    auto makeLoop = [&sample](juce::int64 start, juce::int64 endExclusive)
+    {
+        SampleLoop loop(juce::jlimit<juce::int64>(0, sample.maxLength, start), juce::jlimit<juce::int64>(0, sample.maxLength, endExclusive));
+        return loop.isEnabled() ? loop : SampleLoop();
+    };
+
+    // WAV smpl chunk: the first loop sustains, a second one plays after release. Ends are inclusive.
+    const int numSampleLoops = metadata.getValue("NumSampleLoops", "0").getIntValue();
+
+    if (numSampleLoops > 0)
+    {
+        sample.sustainLoop = makeLoop(metadata.getValue("Loop0Start", "0").getLargeIntValue(),
+                                      metadata.getValue("Loop0End", "0").getLargeIntValue() + 1);
+
+        if (numSampleLoops > 1)
+            sample.releaseLoop = makeLoop(metadata.getValue("Loop1Start", "0").getLargeIntValue(),
+                                          metadata.getValue("Loop1End", "0").getLargeIntValue() + 1);
+        return;
+    }
+
+    // AIFF INST chunk: sustain and release loops refer to MARK chunk markers by identifier
+    auto markerOffset = [&metadata](const juce::String &identifier)
+    {
+        const int numCues = metadata.getValue("NumCuePoints", "0").getIntValue();
+
+        for (int i = 0; i < numCues; ++i)
+            if (metadata.getValue("Cue" + juce::String(i) + "Identifier", {}) == identifier)
+                return metadata.getValue("Cue" + juce::String(i) + "Offset", "0").getLargeIntValue();
+
+        return static_cast<juce::int64>(-1);
+    };
+
+    auto readAiffLoop = [&](int index)
+    {
+        const juce::String prefix = "Loop" + juce::String(index);
+
+        // Play mode 0 means the loop is off
+        if (metadata.getValue(prefix + "Type", "0").getIntValue() == 0)
+            return SampleLoop();
+
+        const juce::int64 start = markerOffset(metadata.getValue(prefix + "StartIdentifier", {}));
+        const juce::int64 end = markerOffset(metadata.getValue(prefix + "EndIdentifier", {}));
+        return start >= 0 && end >= 0 ? makeLoop(start, end) : SampleLoop();
+    };
+
+    if (metadata.containsKey("Loop0StartIdentifier"))
+    {
+        sample.sustainLoop = readAiffLoop(0);
+        sample.releaseLoop = readAiffLoop(1);
+    }
+}
+
 bool SampleLibrary::containsSample(const juce::String &name) const
 {
     return samples.find(name) != samples.end();
@@ -233,20 +657,12 @@ juce::File SampleLibrary::getSamplesFolder() const
 
 bool SampleLibrary::scanFolderForSamples(const juce::File &folder, const juce::String &category)
 {
+    PROXY_TRACE_SCOPE("scan folder");
+
     if (!folder.exists() || !folder.isDirectory())
         return false;
 
-    // Get all audio files in the directory
-    juce::Array<juce::File> audioFiles;
-    const int maxFilesToScan = 200; // Reasonable limit to prevent excessive scanning
-
-    // Use a more complete wildcard pattern and explicitly set recursive flag to false
-    folder.findChildFiles(audioFiles, juce::File::findFiles, false, "*.wav;*.aif;*.aiff;*.mp3");
-
-    // Limit the number of files for performance
-    if (audioFiles.size() > maxFilesToScan)
-        audioFiles.resize(maxFilesToScan);
-
+    const auto audioFiles = findAudioFiles(folder);
     int filesLoaded = 0;
 
     // Use the folder name as category if no category provided
@@ -269,6 +685,22 @@ bool SampleLibrary::scanFolderForSamples(const juce::File &folder, const juce::S
     return filesLoaded > 0;
 }
 
+juce::Array<juce::File> SampleLibrary::findAudioFiles(const juce::File &folder)
+{
+    // Get all audio files in the directory
+    juce::Array<juce::File> audioFiles;
+    const int maxFilesToScan = 200; // Reasonable limit to prevent excessive scanning
+
+    // Use a more complete wildcard pattern and explicitly set recursive flag to false
+    folder.findChildFiles(audioFiles, juce::File::findFiles, false, "*.wav;*.aif;*.aiff;*.mp3");
+
+    // Limit the number of files for performance
+    if (audioFiles.size() > maxFilesToScan)
+        audioFiles.resize(maxFilesToScan);
+
+    return audioFiles;
+}
+
 bool SampleLibrary::scanFolderAndSubfoldersForSamples(const juce::File &rootFolder)
 {
     if (!rootFolder.exists() || !rootFolder.isDirectory())
@@ -294,6 +726,8 @@ bool SampleLibrary::scanFolderAndSubfoldersForSamples(const juce::File &rootFold
 
 juce::StringArray SampleLibrary::scanUserSamplesFolder()
 {
+    PROXY_TRACE_SCOPE("scan samples folder");
+
     // Clear existing samples
     clear();
 
@@ -302,6 +736,7 @@ juce::StringArray SampleLibrary::scanUserSamplesFolder()
 
     // Scan the folder and its subfolders for samples
     scanFolderAndSubfoldersForSamples(samplesFolder);
+    pool->getIndex().save();
 
     // Return the list of available samples
     return getAvailableSamples();
@@ -311,6 +746,7 @@ void SampleLibrary::clear()
 {
     samples.clear();
     categories.clear();
+    ++revision;
 }
 
 bool SampleLibrary::removeSample(const juce::String &name)
@@ -332,6 +768,7 @@ bool SampleLibrary::removeSample(const juce::String &name)
 
         // Remove from samples map
         samples.erase(it);
+        ++revision;
         return true;
     }
 
@@ -2,25 +2,74 @@
 
 #include <JuceHeader.h>
 #include <unordered_map>
+#include "PagedAudioBuffer.h"
+#include "CompressedAudioBuffer.h"
+#include "SampleMipmap.h"
+#include "SamplePool.h"
+#include "SampleAnalysis.h"
+
+// A loop region in frames of the original sample; end is exclusive
+struct SampleLoop
+{
+    juce::int64 start = 0;
+    juce::int64 end = 0;
+
+    SampleLoop() = default;
+    SampleLoop(juce::int64 loopStart, juce::int64 loopEnd) : start(loopStart), end(loopEnd) {}
+
+    bool isEnabled() const { return end > start; }
+    bool operator==(const SampleLoop &other) const { return start == other.start && end == other.end; }
+    bool operator!=(const SampleLoop &other) const { return !(*this == other); }
+};
+
+// How a project refers to its sample: by content first, so it is found even if renamed or moved
+struct SampleReference
+{
+    juce::String name;
+    juce::String contentHash; // empty for samples that didn't come from a file
+    juce::File file;          // where it was loaded from when the project was saved
+};
 
 // Structure to store sample data and its properties
 struct SampleData
 {
-    std::unique_ptr<juce::AudioBuffer<float>> buffer;
+    // The audio is held either as float pages or compressed, never both.
+    // Both are immutable once loaded, so copies share them.
+    std::shared_ptr<const PagedAudioBuffer> buffer;
+    std::shared_ptr<const CompressedAudioBuffer> compressed;
+    std::shared_ptr<const SampleMipmap> mipmap; // octave levels, built in the background
     double sampleRate;
-    int maxLength;
+    juce::int64 maxLength;
+    int bitsPerSample = 0; // integer PCM depth of the file, 0 for float or lossy sources
     juce::String name;
     juce::String category; // Add category field to store folder name
+    juce::File file;       // source file, if it was loaded from one
+    juce::String contentHash;
+
+    // Loop points from the file's smpl/INST chunks, or set by the user
+    SampleLoop sustainLoop;
+    SampleLoop releaseLoop;
+
+    // Root pitch, loudness and trim points, found when the file was indexed
+    SampleAnalysis analysis;
 
     SampleData() : buffer(nullptr), sampleRate(0.0), maxLength(0) {}
 
     // Add move constructor
     SampleData(SampleData &&other) noexcept
         : buffer(std::move(other.buffer)),
+          compressed(std::move(other.compressed)),
+          mipmap(std::move(other.mipmap)),
           sampleRate(other.sampleRate),
           maxLength(other.maxLength),
+          bitsPerSample(other.bitsPerSample),
           name(std::move(other.name)),
-          category(std::move(other.category))
+          category(std::move(other.category)),
+          file(std::move(other.file)),
+          contentHash(std::move(other.contentHash)),
+          sustainLoop(other.sustainLoop),
+          releaseLoop(other.releaseLoop),
+          analysis(other.analysis)
     {
     }
 
@@ -28,13 +77,25 @@ struct SampleData
     SampleData &operator=(SampleData &&other) noexcept
     {
         buffer = std::move(other.buffer);
+        compressed = std::move(other.compressed);
+        mipmap = std::move(other.mipmap);
         sampleRate = other.sampleRate;
         maxLength = other.maxLength;
+        bitsPerSample = other.bitsPerSample;
         name = std::move(other.name);
         category = std::move(other.category);
+        file = std::move(other.file);
+        contentHash = std::move(other.contentHash);
+        sustainLoop = other.sustainLoop;
+        releaseLoop = other.releaseLoop;
+        analysis = other.analysis;
         return *this;
     }
 
+    // Size of the audio, however it is stored
+    juce::int64 getNumFrames() const { return buffer != nullptr ? buffer->getNumFrames() : compressed != nullptr ? compressed->getNumFrames() : 0; }
+    int getNumChannels() const { return buffer != nullptr ? buffer->getNumChannels() : compressed != nullptr ? compressed->getNumChannels() : 0; }
+
     // Delete copy constructor and assignment operator explicitly
     SampleData(const SampleData &) = delete;
     SampleData &operator=(const SampleData &) = delete;
@@ -58,6 +119,21 @@ public:
     bool loadFromStream(const juce::String &name, juce::InputStream &stream, const juce::String &category = "");
     bool loadFromBuffer(const juce::String &name, const juce::AudioBuffer<float> &buffer, double sampleRate, const juce::String &category = "");
 
+    // Find a sample by content hash, then by file path, then by name in the samples folder, and decode
+    // it on a background thread. onLoaded is called on the message thread with the name the sample was
+    // stored under, or an empty string if it couldn't be found.
+    void loadInBackground(const SampleReference &reference, std::function<void(const juce::String &)> onLoaded);
+
+    // Add a sample whose audio is already in memory, such as a recording that was just written to its
+    // file. Only the file's content hash is worked out (in the background), so a project using it can
+    // find it again; onAdded is called on the message thread with the name it was stored under.
+    void addRecording(SampleData recording, std::function<void(const juce::String &)> onAdded);
+
+    // Decode the user samples folder on a background thread, adding samples as the scan finishes.
+    // Samples already loaded are kept, unless replaceLoaded is set (a refresh), in which case the
+    // library is replaced by what the scan found. onFinished is called on the message thread.
+    void scanUserSamplesFolderInBackground(std::function<void()> onFinished, bool replaceLoaded = false);
+
     // Access samples
     SampleData getSampleAudioBuffer(const juce::String &name) const;
     juce::StringArray getAvailableSamples() const;
@@ -66,6 +142,32 @@ public:
     bool containsSample(const juce::String &name) const;
     juce::String getSampleCategory(const juce::String &name) const;
 
+    // Name of a loaded sample with this content, or an empty string
+    juce::String findSampleByHash(const juce::String &contentHash) const;
+
+    // Changes whenever samples are added or removed, so views know to refresh their lists
+    int getRevision() const { return revision; }
+
+    // Keep integer PCM samples losslessly compressed in memory; float and lossy sources always stay
+    // as float. Changing it converts the samples already loaded on the loading thread, swapping each
+    // in on the message thread and then calling onConverted with its name.
+    void setCompressedStorage(bool shouldCompress, std::function<void(const juce::String &)> onConverted = nullptr);
+    bool isCompressedStorage() const { return compressedStorage; }
+
+    // Memory held by all sample audio and mipmaps, including audio shared with other instances
+    size_t getResidentBytes() const;
+
+    // Share decoded audio with other instances through the process-wide pool (on by default).
+    // Off, every file is decoded again, which benchmarks of decoding need.
+    void setPoolSharing(bool shouldShare) { poolSharing = shouldShare; }
+
+    // Called on the message thread with the name of a sample whose mipmap has finished building after
+    // it was stored, so a sound made from it before then can be made again with its octaves
+    std::function<void(const juce::String &)> onMipmapReady;
+
+    // Loop points
+    bool setSampleLoops(const juce::String &name, const SampleLoop &sustainLoop, const SampleLoop &releaseLoop);
+
     // Folder scanning and management
     bool scanFolderForSamples(const juce::File &folder, const juce::String &category = "");
     bool scanFolderAndSubfoldersForSamples(const juce::File &rootFolder);
@@ -77,9 +179,51 @@ public:
     bool removeSample(const juce::String &name);
 
 private:
+    // Store a decoded sample and start building its mipmap in the background
+    void storeSample(SampleData newSample);
+
+    // Decode a file, or share it from the pool, without touching the library, so it can run on any
+    // thread; empty on failure
+    SampleData decodeFile(const juce::String &name, const juce::File &file, const juce::String &category);
+
+    // The decoding itself: audio, format details and loop points
+    SampleData readAudioFile(const juce::File &file);
+
+    // The sample's analysis from the index, or worked out and indexed if its file has changed
+    SampleAnalysis analyse(const SampleData &sample);
+
+    // File a reference points at, or File() if it can't be found (any thread)
+    juce::File resolveReference(const SampleReference &reference);
+
+    // The audio files directly inside a folder, up to the scan limit
+    static juce::Array<juce::File> findAudioFiles(const juce::File &folder);
+
+    // Compress or decompress a sample to match the storage setting, rebuilding its mipmap to match
+    void applyStorageMode(SampleData &sample);
+
+    // Have onMipmapReady called for a stored sample whose mipmap is still being built
+    void watchMipmap(const SampleData &sample);
+
+    // Read sustain and release loops from WAV smpl or AIFF INST/MARK metadata
+    static void readLoopPoints(const juce::StringPairArray &metadata, SampleData &sample);
+
     std::unordered_map<juce::String, SampleData> samples;
     std::unordered_map<juce::String, juce::StringArray> categories; // Category name -> sample names
     juce::AudioFormatManager formatManager;
 
+    juce::SharedResourcePointer<SamplePool> pool;
+
+    // Set on the message thread, read by loading jobs
+    std::atomic<bool> compressedStorage{false};
+    std::atomic<bool> poolSharing{true};
+    int revision = 0;
+
+    // Background work that must not block loading (mipmap builds)
+    juce::ThreadPool backgroundJobs{1};
+
+    // Background decoding: the folder scan and restored samples, so a restore never waits for the scan
+    juce::ThreadPool loadingJobs{2};
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(SampleLibrary)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleLibrary)
 };
\ No newline at end of file
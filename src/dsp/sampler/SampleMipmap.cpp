@@ -0,0 +1,167 @@
+#include "SampleMipmap.h"
+
+namespace
+{
+    // Half-band low-pass: every other tap apart from the centre is zero, so only odd offsets are stored
+    constexpr int HALF_BAND_SIDE_TAPS = 12; // odd offsets 1, 3, ..., 23 → 47 tap filter
+
+    struct HalfBandCoefficients
+    {
+        std::array<float, HALF_BAND_SIDE_TAPS> taps{};
+
+        HalfBandCoefficients()
+        {
+            const int length = HALF_BAND_SIDE_TAPS * 4 - 1;
+            const double centre = (length - 1) * 0.5;
+            double sum = 0.5;
+
+            for (int i = 0; i < HALF_BAND_SIDE_TAPS; ++i)
+            {
+                const int offset = 2 * i + 1;
+                const double x = juce::MathConstants<double>::pi * offset;
+                const double sinc = std::sin(x * 0.5) / x;
+
+                // Blackman window
+                const double n = centre + offset;
+                const double phase = juce::MathConstants<double>::twoPi * n / (length - 1);
+                const double window = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+
+                taps[static_cast<size_t>(i)] = static_cast<float>(sinc * window);
+                sum += 2.0 * sinc * window;
+            }
+
+            // Unity gain at DC
+            for (auto &tap : taps)
+                tap = static_cast<float>(tap / sum);
+            centreTap = static_cast<float>(0.5 / sum);
+        }
+
+        float centreTap = 0.5f;
+    };
+}
+
+void SampleMipmap::build(const PagedAudioBuffer &source, int compressionBits)
+{
+    jassert(!isReady());
+
+    // Reserve up front: each level is built from the one before it
+    levels.reserve(MAX_OCTAVES);
+    const PagedAudioBuffer *previous = &source;
+
+    for (int octave = 1; octave <= MAX_OCTAVES; ++octave)
+    {
+        // Stop once a level would be too short to be useful
+        if (previous->getNumFrames() < 4)
+            break;
+
+        levels.push_back(decimate(*previous));
+        previous = &levels.back();
+    }
+
+    numOctaves = static_cast<int>(levels.size());
+
+    if (compressionBits > 0)
+    {
+        for (const auto &level : levels)
+            compressedLevels.push_back(CompressedAudioBuffer::compress(level, compressionBits, true));
+
+        levels.clear();
+        levels.shrink_to_fit();
+    }
+
+    std::vector<std::function<void()>> waiting;
+
+    {
+        const juce::ScopedLock sl(readyLock);
+        ready.store(true, std::memory_order_release);
+        waiting.swap(readyCallbacks);
+    }
+
+    for (auto &callback : waiting)
+        juce::MessageManager::callAsync(std::move(callback));
+}
+
+void SampleMipmap::whenReady(std::function<void()> callback) const
+{
+    const juce::ScopedLock sl(readyLock);
+
+    if (!isReady())
+        readyCallbacks.push_back(std::move(callback));
+}
+
+PagedAudioBuffer SampleMipmap::decimate(const PagedAudioBuffer &source)
+{
+    static const HalfBandCoefficients coefficients;
+
+    const juce::int64 sourceLength = source.getNumFrames();
+    const juce::int64 length = (sourceLength + 1) / 2;
+    const int reach = HALF_BAND_SIDE_TAPS * 2 - 1;
+
+    PagedAudioBuffer destination(source.getNumChannels(), length);
+
+    // Output is produced a destination page at a time
+    std::vector<float> output(static_cast<size_t>(PagedAudioBuffer::PAGE_FRAMES));
+
+    for (int channel = 0; channel < source.getNumChannels(); ++channel)
+    {
+        for (juce::int64 first = 0; first < length; first += PagedAudioBuffer::PAGE_FRAMES)
+        {
+            const int count = static_cast<int>(juce::jmin<juce::int64>(PagedAudioBuffer::PAGE_FRAMES, length - first));
+
+            for (int i = 0; i < count; ++i)
+            {
+                const juce::int64 centre = 2 * (first + i);
+                const int page = PagedAudioBuffer::pageOf(centre);
+                const auto offsetInPage = static_cast<int>(centre - PagedAudioBuffer::pageStart(page));
+                float sum;
+
+                if (offsetInPage >= reach && offsetInPage + reach < source.getPageLength(page))
+                {
+                    // Interior of a page: no bounds checks
+                    const float *input = source.getPage(channel, page) + offsetInPage;
+                    sum = coefficients.centreTap * input[0];
+
+                    for (int t = 0; t < HALF_BAND_SIDE_TAPS; ++t)
+                    {
+                        const int offset = 2 * t + 1;
+                        sum += coefficients.taps[static_cast<size_t>(t)] * (input[-offset] + input[offset]);
+                    }
+                }
+                else
+                {
+                    // Near a page boundary or either end of the sample
+                    sum = coefficients.centreTap * source.getSample(channel, centre);
+
+                    for (int t = 0; t < HALF_BAND_SIDE_TAPS; ++t)
+                    {
+                        const int offset = 2 * t + 1;
+                        sum += coefficients.taps[static_cast<size_t>(t)]
+                               * (source.getSample(channel, centre - offset) + source.getSample(channel, centre + offset));
+                    }
+                }
+
+                output[static_cast<size_t>(i)] = sum;
+            }
+
+            destination.copyFrom(channel, first, output.data(), count);
+        }
+    }
+
+    return destination;
+}
+
+size_t SampleMipmap::getSizeInBytes() const
+{
+    if (!isReady())
+        return 0;
+
+    size_t bytes = 0;
+
+    for (const auto &level : levels)
+        bytes += level.getSizeInBytes();
+
+    for (const auto &level : compressedLevels)
+        bytes += level->getSizeInBytes();
+
+    return bytes;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PagedAudioBuffer.h"
+#include "CompressedAudioBuffer.h"
+
+// Pre-filtered, decimated copies of a sample, one per octave.
+// Level n is the source low-passed and decimated by 2^n with a half-band filter, so a voice
+// transposing upwards can read the level that keeps its step at or below one source frame
+// per output sample and stay alias-free with plain linear interpolation.
+// Levels are paged like the source, so a mipmap of a multi-hour sample needs no large block either.
+// For a sample kept compressed the levels are compressed too, rounded to the source's bit depth.
+// build() runs on a background thread; voices must check isReady() before using any level.
+class SampleMipmap
+{
+public:
+    // Up to four octaves above the root note
+    static constexpr int MAX_OCTAVES = 4;
+
+    SampleMipmap() = default;
+
+    // Build all levels from the source (background thread); compressionBits > 0 stores them compressed
+    void build(const PagedAudioBuffer &source, int compressionBits = 0);
+
+    bool isReady() const { return ready.load(std::memory_order_acquire); }
+
+    // Message thread: call back on the message thread once build() has finished. Nothing is called
+    // if it already has, so check isReady() first. Shared mipmaps take callbacks from every holder.
+    void whenReady(std::function<void()> callback) const;
+
+    // Number of octave levels available (not counting the source itself)
+    int getNumOctaves() const { return isReady() ? numOctaves : 0; }
+
+    // Whether the levels are stored compressed, and so read through getCompressedOctave()
+    bool isCompressed() const { return !compressedLevels.empty(); }
+
+    // Level for the given octave, 1..getNumOctaves()
+    const PagedAudioBuffer &getOctave(int octave) const { return levels[static_cast<size_t>(octave - 1)]; }
+    const CompressedAudioBuffer &getCompressedOctave(int octave) const { return *compressedLevels[static_cast<size_t>(octave - 1)]; }
+
+    // Memory held by the levels
+    size_t getSizeInBytes() const;
+
+private:
+    std::vector<PagedAudioBuffer> levels;
+    std::vector<std::unique_ptr<CompressedAudioBuffer>> compressedLevels;
+    int numOctaves = 0;
+    std::atomic<bool> ready{false};
+
+    // Waiting for build() to finish; not part of the levels, so const holders can add to them
+    mutable juce::CriticalSection readyLock;
+    mutable std::vector<std::function<void()>> readyCallbacks;
+
+    static PagedAudioBuffer decimate(const PagedAudioBuffer &source);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleMipmap)
+};
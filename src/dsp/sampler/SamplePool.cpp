@@ -0,0 +1,161 @@
+#include "SamplePool.h"
+#include "SampleLibrary.h"
+
+struct SamplePool::Slot
+{
+    juce::CriticalSection lock; // held while decoding, so a second request waits for the first
+    std::weak_ptr<const PagedAudioBuffer> buffer;
+    std::weak_ptr<const CompressedAudioBuffer> compressed;
+    std::weak_ptr<const SampleMipmap> mipmap, compressedMipmap;
+
+    // As read from the file; loops edited in one instance stay in that instance
+    double sampleRate = 0.0;
+    juce::int64 maxLength = 0;
+    int bitsPerSample = 0;
+    SampleLoop sustainLoop, releaseLoop;
+};
+
+SamplePool::SamplePool()
+    : index(juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("Proxy/SampleIndex.xml"))
+{
+}
+
+std::shared_ptr<SamplePool::Slot> SamplePool::getSlot(const juce::String &contentHash)
+{
+    const juce::ScopedLock sl(slotsLock);
+
+    auto it = slots.find(contentHash);
+
+    if (it != slots.end())
+        return it->second;
+
+    // Before adding a slot, drop those whose audio every instance has released. Slots are only handed
+    // out under this lock, so one nobody else holds can't be in use.
+    for (auto stale = slots.begin(); stale != slots.end();)
+    {
+        const auto &slot = *stale->second;
+
+        if (stale->second.use_count() == 1 && slot.buffer.expired() && slot.compressed.expired()
+            && slot.mipmap.expired() && slot.compressedMipmap.expired())
+            stale = slots.erase(stale);
+        else
+            ++stale;
+    }
+
+    auto slot = std::make_shared<Slot>();
+    slots.emplace(contentHash, slot);
+    return slot;
+}
+
+SampleData SamplePool::acquire(const juce::String &contentHash, bool preferCompressed, const std::function<SampleData()> &decode)
+{
+    if (contentHash.isEmpty())
+        return decode();
+
+    auto slot = getSlot(contentHash);
+    const juce::ScopedLock sl(slot->lock);
+
+    SampleData result;
+    auto buffer = slot->buffer.lock();
+    auto compressed = slot->compressed.lock();
+
+    if (buffer == nullptr && compressed == nullptr)
+    {
+        // Nobody holds it any more (or ever did)
+        result = decode();
+
+        if (result.getNumFrames() > 0)
+        {
+            // Shared straight away, so an instance loading the same file meanwhile takes this copy
+            result.contentHash = contentHash;
+            slot->sampleRate = result.sampleRate;
+            slot->maxLength = result.maxLength;
+            slot->bitsPerSample = result.bitsPerSample;
+            slot->sustainLoop = result.sustainLoop;
+            slot->releaseLoop = result.releaseLoop;
+            share(result);
+        }
+
+        return result;
+    }
+
+    if (compressed != nullptr && (preferCompressed || buffer == nullptr))
+    {
+        result.compressed = std::move(compressed);
+        result.mipmap = slot->compressedMipmap.lock();
+    }
+    else
+    {
+        result.buffer = std::move(buffer);
+        result.mipmap = slot->mipmap.lock();
+    }
+
+    result.sampleRate = slot->sampleRate;
+    result.maxLength = slot->maxLength;
+    result.bitsPerSample = slot->bitsPerSample;
+    result.sustainLoop = slot->sustainLoop;
+    result.releaseLoop = slot->releaseLoop;
+    result.contentHash = contentHash;
+    return result;
+}
+
+bool SamplePool::findStorage(const juce::String &contentHash, bool compressed, SampleData &sample)
+{
+    if (contentHash.isEmpty())
+        return false;
+
+    auto slot = getSlot(contentHash);
+    const juce::ScopedLock sl(slot->lock);
+
+    if (compressed)
+    {
+        auto audio = slot->compressed.lock();
+        auto mipmap = slot->compressedMipmap.lock();
+
+        if (audio == nullptr || mipmap == nullptr)
+            return false;
+
+        sample.compressed = std::move(audio);
+        sample.buffer = nullptr;
+        sample.mipmap = std::move(mipmap);
+    }
+    else
+    {
+        auto audio = slot->buffer.lock();
+        auto mipmap = slot->mipmap.lock();
+
+        if (audio == nullptr || mipmap == nullptr)
+            return false;
+
+        sample.buffer = std::move(audio);
+        sample.compressed = nullptr;
+        sample.mipmap = std::move(mipmap);
+    }
+
+    return true;
+}
+
+void SamplePool::share(const SampleData &sample)
+{
+    if (sample.contentHash.isEmpty() || sample.getNumFrames() == 0)
+        return;
+
+    auto slot = getSlot(sample.contentHash);
+    const juce::ScopedLock sl(slot->lock);
+
+    if (sample.buffer != nullptr)
+    {
+        slot->buffer = sample.buffer;
+
+        if (sample.mipmap != nullptr)
+            slot->mipmap = sample.mipmap;
+    }
+
+    if (sample.compressed != nullptr)
+    {
+        slot->compressed = sample.compressed;
+
+        if (sample.mipmap != nullptr)
+            slot->compressedMipmap = sample.mipmap;
+    }
+}
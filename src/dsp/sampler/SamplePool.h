@@ -0,0 +1,44 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <unordered_map>
+#include "SampleIndex.h"
+
+struct SampleData;
+
+// Decoded sample audio shared by every plugin instance in the process, keyed by content hash.
+// Libraries hold it through a juce::SharedResourcePointer, so there is one pool while any
+// instance exists. The pool only keeps weak references: audio and mipmaps live as long as some
+// library or voice still uses them, and twenty instances of the same kit hold one copy.
+// Thread-safe; libraries decode on background threads.
+class SamplePool
+{
+public:
+    SamplePool();
+
+    // The file -> content hash index, shared so only one writer touches the index file
+    SampleIndex &getIndex() { return index; }
+
+    // Audio and mipmap for this content if any instance holds them, preferring the given storage;
+    // otherwise decode() is called to produce it. Callers asking for the same content at the same
+    // time wait for a single decode. The result still needs sharing with share() once stored.
+    SampleData acquire(const juce::String &contentHash, bool preferCompressed, const std::function<SampleData()> &decode);
+
+    // Fill in the audio and a mipmap in the given storage if an instance holds both
+    bool findStorage(const juce::String &contentHash, bool compressed, SampleData &sample);
+
+    // Offer a sample's audio and mipmap to other instances; samples without a content hash aren't shared
+    void share(const SampleData &sample);
+
+private:
+    struct Slot; // what the pool knows about one content hash
+
+    SampleIndex index;
+    std::unordered_map<juce::String, std::shared_ptr<Slot>> slots;
+    juce::CriticalSection slotsLock;
+
+    // The slot for a hash, made if needed; making one first drops slots nothing uses any more
+    std::shared_ptr<Slot> getSlot(const juce::String &contentHash);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplePool)
+};
@@ -0,0 +1,230 @@
+#include "SampleRecorder.h"
+#include "Trace.h"
+
+SampleRecorder::SampleRecorder()
+    : juce::Thread("Proxy recorder")
+{
+}
+
+SampleRecorder::~SampleRecorder()
+{
+    // The writer still closes the file; the recording is dropped with us
+    stop();
+    stopThread(10000);
+}
+
+void SampleRecorder::prepare(double newSampleRate)
+{
+    if (state.load() != State::idle)
+        stop();
+
+    waitForThreadToExit(10000);
+
+    sampleRate = newSampleRate;
+
+    const int ringFrames = juce::nextPowerOfTwo(juce::roundToInt(newSampleRate * RING_SECONDS));
+    ring.setSize(NUM_CHANNELS, ringFrames, false, true, true);
+    fifo.setTotalSize(ringFrames);
+}
+
+bool SampleRecorder::start(Source newSource, const juce::File &folder)
+{
+    if (state.load() != State::idle || ring.getNumSamples() == 0 || sampleRate <= 0.0)
+        return false;
+
+    // The writer sets idle as its last step, so this is at most a moment; a writer that is still
+    // running would keep startThread() below from starting the new one
+    if (!waitForThreadToExit(1000))
+        return false;
+
+    folder.createDirectory();
+    file = folder.getNonexistentChildFile("Recording " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S"), ".wav");
+
+    // 32-bit float, so nothing above full scale is clipped
+    juce::WavAudioFormat wav;
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+
+    if (stream->openedOk())
+        writer.reset(wav.createWriterFor(stream.get(), sampleRate, NUM_CHANNELS, 32, {}, 0));
+
+    if (writer == nullptr)
+    {
+        stream.reset();
+        file.deleteFile();
+        return false;
+    }
+
+    stream.release(); // the writer owns it now
+
+    fifo.reset();
+    droppedFrames = 0;
+    recordedFrames = 0;
+    source = newSource;
+    state = State::recording;
+
+    // WeakReferences are only made on the message thread; the writer hands the recording back through this one
+    messageThreadReference = this;
+
+    startThread();
+    return true;
+}
+
+void SampleRecorder::stop()
+{
+    auto expected = State::recording;
+
+    if (state.compare_exchange_strong(expected, State::finishing))
+        notify();
+}
+
+void SampleRecorder::capture(Source from, const juce::AudioBuffer<float> &buffer, int numSamples)
+{
+    // Flagged before the state is read, so the writer can wait out a block that was already on its way
+    capturing = true;
+
+    if (state.load() != State::recording || from != source || buffer.getNumChannels() == 0 || numSamples <= 0)
+    {
+        capturing = false;
+        return;
+    }
+
+    const auto scope = fifo.write(numSamples);
+
+    auto copy = [&](int ringStart, int count, int bufferStart)
+    {
+        if (count <= 0)
+            return;
+
+        for (int channel = 0; channel < NUM_CHANNELS; ++channel)
+            ring.copyFrom(channel, ringStart, buffer, juce::jmin(channel, buffer.getNumChannels() - 1), bufferStart, count);
+    };
+
+    copy(scope.startIndex1, scope.blockSize1, 0);
+    copy(scope.startIndex2, scope.blockSize2, scope.blockSize1);
+
+    // The writer fell behind (a stalled disk): the gap is counted rather than waited for
+    const int written = scope.blockSize1 + scope.blockSize2;
+
+    if (written < numSamples)
+        droppedFrames += numSamples - written;
+
+    capturing = false;
+}
+
+void SampleRecorder::run()
+{
+    while (!threadShouldExit())
+    {
+        const bool finishing = state.load() == State::finishing;
+
+        // A block the audio thread started copying before the stop still belongs in the recording
+        if (finishing)
+            while (capturing.load())
+                juce::Thread::yield();
+
+        drain();
+
+        if (finishing)
+            break;
+
+        wait(WRITE_INTERVAL_MS);
+    }
+
+    finish();
+}
+
+void SampleRecorder::drain()
+{
+    const int numReady = fifo.getNumReady();
+
+    if (numReady == 0)
+        return;
+
+    PROXY_TRACE_SCOPE("write recording");
+
+    const auto scope = fifo.read(numReady);
+    append(scope.startIndex1, scope.blockSize1);
+    append(scope.startIndex2, scope.blockSize2);
+}
+
+void SampleRecorder::append(int ringStart, int count)
+{
+    if (count <= 0)
+        return;
+
+    if (writer != nullptr)
+        writer->writeFromAudioSampleBuffer(ring, ringStart, count);
+
+    // Kept as pages for the library; a long recording only ever adds pages, never copies them
+    juce::int64 frames = recordedFrames.load();
+    int done = 0;
+
+    while (done < count)
+    {
+        const int offset = static_cast<int>(frames & (PagedAudioBuffer::PAGE_FRAMES - 1));
+
+        if (offset == 0)
+        {
+            for (auto &channelPages : pages)
+            {
+                channelPages.emplace_back();
+                channelPages.back().calloc(PagedAudioBuffer::PAGE_FRAMES + PagedAudioBuffer::GUARD_FRAMES);
+            }
+        }
+
+        const int length = juce::jmin(count - done, PagedAudioBuffer::PAGE_FRAMES - offset);
+
+        for (int channel = 0; channel < NUM_CHANNELS; ++channel)
+            juce::FloatVectorOperations::copy(pages[channel].back() + offset, ring.getReadPointer(channel, ringStart + done), length);
+
+        done += length;
+        frames += length;
+    }
+
+    recordedFrames = frames;
+}
+
+void SampleRecorder::finish()
+{
+    // Flushes the header and closes the file
+    writer.reset();
+
+    const juce::int64 numFrames = recordedFrames.load();
+    auto recording = std::make_shared<SampleData>();
+
+    if (numFrames > 0)
+    {
+        std::vector<juce::HeapBlock<float>> channelMajor;
+
+        for (auto &channelPages : pages)
+            for (auto &page : channelPages)
+                channelMajor.push_back(std::move(page));
+
+        recording->buffer = PagedAudioBuffer::fromPages(NUM_CHANNELS, numFrames, std::move(channelMajor));
+        recording->sampleRate = sampleRate;
+        recording->maxLength = numFrames;
+        recording->name = file.getFileNameWithoutExtension();
+        recording->category = file.getParentDirectory().getFileName();
+        recording->file = file;
+    }
+    else
+    {
+        file.deleteFile();
+    }
+
+    for (auto &channelPages : pages)
+        channelPages.clear();
+
+    state = State::idle;
+
+    if (recording->buffer == nullptr)
+        return;
+
+    juce::MessageManager::callAsync([weakThis = messageThreadReference, recording]
+                                    {
+                                        auto *recorder = weakThis.get();
+
+                                        if (recorder != nullptr && recorder->onFinished)
+                                            recorder->onFinished(std::move(*recording));
+                                    });
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleLibrary.h"
+
+// Records audio from the audio thread into a new sample. The audio thread copies each block into a
+// ring allocated in prepare(); a writer thread streams the ring to a WAV file and keeps the frames in
+// pages as it goes, so the finished recording plays straight away without reading the file back.
+class SampleRecorder : private juce::Thread
+{
+public:
+    enum class Source
+    {
+        output,   // what the plugin plays
+        sidechain // the sidechain input bus
+    };
+
+    static constexpr int NUM_CHANNELS = 2;
+
+    SampleRecorder();
+    ~SampleRecorder() override;
+
+    // Size the ring for a sample rate; finishes any recording first. Not while audio is running.
+    void prepare(double sampleRate);
+
+    // Message thread: start recording into a new file in folder. Fails if the file can't be created,
+    // prepare() hasn't been called or the last recording is still being written.
+    bool start(Source source, const juce::File &folder);
+
+    // Message thread: stop recording; onFinished gets the recording once the writer has caught up
+    void stop();
+
+    bool isRecording() const { return state.load() == State::recording; }
+    Source getSource() const { return source; }
+
+    // Length so far, and frames lost because the writer fell behind
+    juce::int64 getRecordedFrames() const { return recordedFrames.load(); }
+    double getRecordedSeconds() const { return sampleRate > 0.0 ? static_cast<double>(recordedFrames.load()) / sampleRate : 0.0; }
+    int getDroppedFrames() const { return droppedFrames.load(); }
+
+    // Audio thread: copy a block in if this source is being recorded. Mono input fills both channels.
+    // Never allocates or waits; if the ring is full the rest of the block is dropped and counted.
+    void capture(Source from, const juce::AudioBuffer<float> &buffer, int numSamples);
+
+    // Called on the message thread with each finished recording: its audio, format and file
+    std::function<void(SampleData)> onFinished;
+
+private:
+    enum class State
+    {
+        idle,
+        recording,
+        finishing
+    };
+
+    static constexpr double RING_SECONDS = 4.0;
+    static constexpr int WRITE_INTERVAL_MS = 20;
+
+    std::atomic<State> state{State::idle};
+    std::atomic<bool> capturing{false}; // the audio thread is inside capture()
+    Source source = Source::output;
+    double sampleRate = 0.0;
+
+    // Audio thread -> writer thread
+    juce::AudioBuffer<float> ring;
+    juce::AbstractFifo fifo{1};
+    std::atomic<int> droppedFrames{0};
+
+    // Writer thread
+    juce::File file;
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    std::vector<juce::HeapBlock<float>> pages[NUM_CHANNELS]; // PagedAudioBuffer pages, filled in order
+    std::atomic<juce::int64> recordedFrames{0};
+
+    // Made by start() on the message thread, copied by the writer when it finishes
+    juce::WeakReference<SampleRecorder> messageThreadReference;
+
+    void run() override;
+
+    // Write out everything waiting in the ring
+    void drain();
+    void append(int ringStart, int count);
+
+    // Close the file and hand the recording to the message thread
+    void finish();
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(SampleRecorder)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleRecorder)
+};
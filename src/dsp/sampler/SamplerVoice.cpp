@@ -0,0 +1,656 @@
+#include "SamplerVoice.h"
+#include "PitchedNoteCache.h"
+#include "Trace.h"
+
+//==============================================================================
+ProxySamplerSound::ProxySamplerSound(const juce::String &soundName, const SampleData &sample, float loopCrossfadeMs, bool needsFloatAudio,
+                                     size_t noteCacheBytes)
+    : audioData(sample.buffer),
+      compressedData(sample.compressed),
+      numFrames(sample.getNumFrames()),
+      numChannels(sample.buffer != nullptr ? sample.buffer->getNumChannels() : sample.compressed != nullptr ? sample.compressed->getNumChannels() : 0),
+      name(soundName),
+      mipmap(sample.mipmap)
+{
+    if (audioData == nullptr && compressedData != nullptr && needsFloatAudio)
+        audioData = compressedData->decompress();
+
+    region.sustainLoop = sample.sustainLoop;
+    region.releaseLoop = sample.releaseLoop;
+    region.crossfadeFrames = sample.sampleRate > 0.0 ? juce::roundToInt(sample.sampleRate * loopCrossfadeMs / 1000.0) : 0;
+    region.end = numFrames;
+
+    // Notes play from the first transient to where the sample has faded out, though never
+    // cut into a loop, tuned to the sample's root and brought to a common loudness
+    const auto &analysis = sample.analysis;
+
+    if (analysis.analysed && numFrames > 0)
+    {
+        region.start = analysis.startFrame;
+        region.end = analysis.endFrame;
+
+        for (const auto *loop : {&sample.sustainLoop, &sample.releaseLoop})
+        {
+            if (loop->isEnabled())
+            {
+                region.start = juce::jmin(region.start, loop->start);
+                region.end = juce::jmax(region.end, loop->end);
+            }
+        }
+
+        region.start = juce::jlimit<juce::int64>(0, numFrames - 1, region.start);
+        region.end = juce::jlimit<juce::int64>(region.start + 1, numFrames, region.end);
+
+        rootNote = analysis.getRootNote();
+        normalisationGain = analysis.getNormalisationGain();
+    }
+
+    // Level 0 is the source, then the mipmap octaves if they are built yet. If not, the library's
+    // onMipmapReady has the processor make the sound again once they are.
+    const int numOctaves = mipmap != nullptr ? mipmap->getNumOctaves() : 0;
+
+    for (int octave = 0; octave <= numOctaves; ++octave)
+    {
+        PlaybackLevel level;
+        const auto scale = static_cast<double>(1 << octave);
+
+        if (octave == 0)
+        {
+            level.audio = audioData.get();
+            level.compressed = audioData == nullptr ? compressedData.get() : nullptr;
+        }
+        else if (!mipmap->isCompressed())
+        {
+            level.audio = &mipmap->getOctave(octave);
+        }
+        else if (needsFloatAudio)
+        {
+            decodedOctaves.push_back(mipmap->getCompressedOctave(octave).decompress());
+            level.audio = decodedOctaves.back().get();
+        }
+        else
+        {
+            level.compressed = &mipmap->getCompressedOctave(octave);
+        }
+
+        if (level.audio != nullptr)
+            prepareLevel(level, *level.audio, region, scale);
+        else
+            prepareLevel(level, *level.compressed, region, scale);
+
+        levels.push_back(std::move(level));
+    }
+
+    // Notes are rendered by a NoteCacheBuilder as voices ask for them
+    if (noteCacheBytes > 0 && numFrames > 0)
+        noteCache = std::make_shared<PitchedNoteCache>(sample, region, rootNote, noteCacheBytes);
+}
+
+ProxySamplerSound::PlaybackLevel ProxySamplerSound::makeLevel(const PagedAudioBuffer &audio, const PlaybackRegion &playbackRegion, double scale)
+{
+    PlaybackLevel level;
+    level.audio = &audio;
+    prepareLevel(level, audio, playbackRegion, scale);
+    return level;
+}
+
+template <typename Audio>
+void ProxySamplerSound::prepareLevel(PlaybackLevel &level, const Audio &audio, const PlaybackRegion &playbackRegion, double scale)
+{
+    level.sustain = buildSeam(audio, playbackRegion.sustainLoop, playbackRegion.crossfadeFrames, scale);
+    level.release = buildSeam(audio, playbackRegion.releaseLoop, playbackRegion.crossfadeFrames, scale);
+
+    // The start rounded down and the end up, so the level covers at least the source's range
+    const juce::int64 length = audio.getNumFrames();
+    level.playStart = juce::jlimit<juce::int64>(0, juce::jmax<juce::int64>(0, length - 1),
+                                                static_cast<juce::int64>(static_cast<double>(playbackRegion.start) / scale));
+    level.playEnd = juce::jlimit<juce::int64>(juce::jmin(length, level.playStart + 1), length,
+                                              static_cast<juce::int64>(std::ceil(static_cast<double>(playbackRegion.end) / scale)));
+}
+
+const ProxySamplerSound::PlaybackLevel *ProxySamplerSound::findPitchedNote(int midiNote) const
+{
+    return noteCache != nullptr ? noteCache->find(midiNote) : nullptr;
+}
+
+template <typename Audio>
+ProxySamplerSound::LoopSeam ProxySamplerSound::buildSeam(const Audio &audio, const SampleLoop &loop,
+                                                         int crossfadeFrames, double scale)
+{
+    LoopSeam result;
+
+    if (!loop.isEnabled())
+        return result;
+
+    // Loop points in frames of this level, rounded down
+    auto toLevel = [scale](juce::int64 frames)
+    { return static_cast<juce::int64>(static_cast<double>(frames) / scale); };
+
+    const juce::int64 length = audio.getNumFrames();
+    const juce::int64 start = juce::jlimit<juce::int64>(0, length - 1, toLevel(loop.start));
+    const juce::int64 end = juce::jlimit<juce::int64>(0, length, toLevel(loop.end));
+
+    if (end - start < 2)
+        return result;
+
+    // The crossfade blends in material from just before the loop start, so it can't be longer than that.
+    // At least one frame is always rendered so the source read stops short of the loop end.
+    const auto crossfade = static_cast<int>(juce::jmax<juce::int64>(1, juce::jmin<juce::int64>(toLevel(crossfadeFrames), start, (end - start) / 2)));
+
+    result.enabled = true;
+    result.start = start;
+    result.seamStart = end - crossfade;
+    result.crossfade = crossfade;
+    result.seam.setSize(audio.getNumChannels(), crossfade + GUARD_FRAMES);
+
+    // The loop end and start can be pages apart, so both sides are copied out first
+    std::vector<float> fadeOut(static_cast<size_t>(crossfade));
+    std::vector<float> fadeIn(static_cast<size_t>(crossfade));
+
+    for (int channel = 0; channel < audio.getNumChannels(); ++channel)
+    {
+        float *output = result.seam.getWritePointer(channel);
+
+        audio.copyTo(channel, result.seamStart, fadeOut.data(), crossfade);
+        audio.copyTo(channel, start - crossfade, fadeIn.data(), crossfade);
+
+        // Linear crossfade from the loop end into the frames leading up to the loop start
+        for (int i = 0; i < crossfade; ++i)
+        {
+            const float amount = static_cast<float>(i) / static_cast<float>(crossfade);
+            output[i] = fadeOut[static_cast<size_t>(i)] * (1.0f - amount) + fadeIn[static_cast<size_t>(i)] * amount;
+        }
+
+        // Then continue with the loop start itself
+        audio.copyTo(channel, start, output + crossfade, GUARD_FRAMES);
+    }
+
+    return result;
+}
+
+int ProxySamplerSound::chooseOctave(double pitchRatio) const
+{
+    if (pitchRatio <= 1.0 || levels.size() < 2)
+        return 0;
+
+    // Smallest octave that brings the step down to one frame per sample or less
+    const int octave = static_cast<int>(std::ceil(std::log2(pitchRatio) - 1.0e-9));
+    return juce::jlimit(0, getNumLevels() - 1, octave);
+}
+
+//==============================================================================
+ProxySamplerVoice::ProxySamplerVoice()
+    : pitchRatio(0.0),
+      lgain(0.0f),
+      rgain(0.0f),
+      attackSamples(0.0),
+      releaseSamples(0.0),
+      attackRate(0.0),
+      releaseRate(0.0),
+      attackPhase(false),
+      releasePhase(false),
+      envelopeLevel(0.0),
+      currentMidiNote(-1),
+      sampleRate(44100.0), // Default sample rate
+      shouldKill(false)
+{
+}
+
+bool ProxySamplerVoice::canPlaySound(juce::SynthesiserSound *sound)
+{
+    // Check if this is our custom sound class
+    return dynamic_cast<ProxySamplerSound *>(sound) != nullptr;
+}
+
+void ProxySamplerVoice::startNote(int midiNoteNumber, float velocity,
+                                  juce::SynthesiserSound *s, int currentPitchWheelPosition)
+{
+    if (auto *sound = dynamic_cast<ProxySamplerSound *>(s))
+    {
+        // Calculate pitch ratio based on the difference between the played MIDI note and the sample's root
+        pitchRatio = std::pow(2.0, (midiNoteNumber - sound->getRootNote()) / 12.0);
+
+        // Store the MIDI note number
+        currentMidiNote = midiNoteNumber;
+        beginNote(midiNoteNumber, velocity, currentPitchWheelPosition);
+
+        // Start from the modulated pitch, including any bend or glide already in place
+        ModulationEngine::Targets targets;
+
+        if (auto *engine = getModulationEngine())
+            targets = engine->evaluate(getNoteModulation(), 0);
+
+        // An unbent note that has been pre-rendered at its pitch is read one frame per sample.
+        // Otherwise upward transpositions read from the matching pre-filtered octave, which keeps
+        // the step at or below one frame per sample so linear interpolation can't alias.
+        // The level is fixed for the note; later bends move the step within it.
+        const auto *pitchedNote = targets.pitchRatio == 1.0 ? sound->findPitchedNote(midiNoteNumber) : nullptr;
+
+        if (pitchedNote != nullptr)
+        {
+            playbackLevel = pitchedNote;
+            levelScale = pitchRatio;
+        }
+        else
+        {
+            const int octave = sound->chooseOctave(pitchRatio * targets.pitchRatio);
+            playbackLevel = &sound->getLevel(octave);
+            levelScale = static_cast<double>(1 << octave);
+        }
+
+        levelStep = pitchRatio * targets.pitchRatio / levelScale;
+        stepDelta = 0.0;
+        modulationGain = targets.gain;
+        modulationGainDelta = 0.0f;
+        rampFramesLeft = 0;
+
+        // Reset sample position for the new note, skipping any silence before the first transient;
+        // the cache may hold blocks of a previous sound
+        region = ReadRegion::source;
+        readPosition = static_cast<double>(playbackLevel->playStart);
+        decodeCache.clear();
+
+        // The sound's channel count is fixed, so the kernels are picked here; the block only chooses
+        // between output layouts and read modes, which the host and the governor can change mid-note
+        for (int outputChannels = 1; outputChannels <= 2; ++outputChannels)
+            for (int interpolate = 0; interpolate < 2; ++interpolate)
+                kernels[outputChannels - 1][interpolate] = chooseKernel(sound->getNumChannels(), outputChannels, interpolate != 0);
+
+        // Apply velocity scaling on top of the sound's normalisation
+        lgain = velocity * sound->getNormalisationGain();
+        rgain = lgain;
+
+        // Reset envelope
+        envelopeLevel = 0.0;
+
+        attackPhase = true;
+        releasePhase = false;
+        shouldKill = false;
+    }
+    else
+    {
+        stopNote(0.0f, false);
+    }
+}
+
+void ProxySamplerVoice::stopNote(float /*velocity*/, bool allowTailOff)
+{
+    if (allowTailOff)
+    {
+        releasePhase = true;
+        attackPhase = false;
+    }
+    else
+    {
+        shouldKill = true;
+    }
+}
+
+void ProxySamplerVoice::setAttackRate(double newSampleRate, double attackTimeMs)
+{
+    sampleRate = newSampleRate;
+    attackSamples = sampleRate * (attackTimeMs / 1000.0);
+    attackRate = attackSamples > 0 ? 1.0 / attackSamples : 1.0;
+}
+
+void ProxySamplerVoice::setReleaseRate(double newSampleRate, double releaseTimeMs)
+{
+    sampleRate = newSampleRate;
+    releaseSamples = sampleRate * (releaseTimeMs / 1000.0);
+    releaseRate = releaseSamples > 0 ? 1.0 / releaseSamples : 1.0;
+}
+
+//==============================================================================
+ProxySamplerVoice::ReadWindow ProxySamplerVoice::selectReadRegion(const ProxySamplerSound::PlaybackLevel &level)
+{
+    ReadWindow window;
+
+    if (region == ReadRegion::source)
+    {
+        // Held notes loop the sustain loop, released ones the release loop, if there is one ahead of us
+        const auto &loop = releasePhase ? level.release : level.sustain;
+
+        if (loop.enabled && readPosition < loop.seamStart)
+            window.limit = static_cast<double>(loop.seamStart);
+        else
+            window.limit = static_cast<double>(level.playEnd - 1); // interpolation reads one frame ahead
+
+        // Reads stay within the page or block holding the read position; its guard frames cover the interpolation
+        juce::int64 windowStart = 0;
+        int windowLength = 0;
+
+        if (level.audio != nullptr)
+        {
+            const auto &audio = *level.audio;
+            const int page = juce::jlimit(0, audio.getNumPages() - 1, PagedAudioBuffer::pageOf(static_cast<juce::int64>(readPosition)));
+
+            windowStart = PagedAudioBuffer::pageStart(page);
+            windowLength = audio.getPageLength(page);
+            window.inL = audio.getPage(0, page);
+            window.inR = audio.getNumChannels() > 1 ? audio.getPage(1, page) : window.inL;
+        }
+        else
+        {
+            const auto &audio = *level.compressed;
+            const int block = juce::jlimit(0, audio.getNumBlocks() - 1, CompressedAudioBuffer::blockOf(static_cast<juce::int64>(readPosition)));
+            const auto decoded = decodeCache.fetch(audio, block);
+
+            windowStart = CompressedAudioBuffer::blockStart(block);
+            windowLength = audio.getBlockLength(block);
+            window.inL = decoded.left;
+            window.inR = decoded.right;
+        }
+
+        const double windowLimit = static_cast<double>(windowStart + windowLength - 1);
+
+        window.base = static_cast<double>(windowStart);
+        window.endsRegion = window.limit <= windowLimit;
+        window.limit = juce::jmin(window.limit, windowLimit);
+    }
+    else
+    {
+        const auto &loop = region == ReadRegion::sustainSeam ? level.sustain : level.release;
+        window.limit = loop.crossfade;
+        window.inL = loop.seam.getReadPointer(0);
+        window.inR = loop.seam.getNumChannels() > 1 ? loop.seam.getReadPointer(1) : window.inL;
+    }
+
+    return window;
+}
+
+void ProxySamplerVoice::prefetchBlocks(const ProxySamplerSound::PlaybackLevel &level, int numSamples)
+{
+    if (level.compressed == nullptr)
+        return;
+
+    const auto &audio = *level.compressed;
+    const auto &loop = releasePhase ? level.release : level.sustain;
+
+    // Reading carries on from the read position, or from just after the loop start once a seam is done
+    double position = readPosition;
+
+    if (region != ReadRegion::source)
+    {
+        const auto &seamLoop = region == ReadRegion::sustainSeam ? level.sustain : level.release;
+        position = static_cast<double>(seamLoop.start) + juce::jmax(0.0, readPosition - seamLoop.crossfade);
+    }
+
+    decodeCache.prefetch(audio, CompressedAudioBuffer::blockOf(static_cast<juce::int64>(position)), 1 + BlockDecodeCache::DECODE_AHEAD);
+
+    // The block a jump lands in: the loop start after its seam, or the top of the sample if this call
+    // reaches the end. Prefetched last, so the blocks ahead don't push it out of the cache.
+    const double reach = readPosition + levelStep * numSamples + 1.0;
+
+    if (loop.enabled)
+        decodeCache.prefetch(audio, CompressedAudioBuffer::blockOf(loop.start), 1);
+    else if (region == ReadRegion::source && reach >= static_cast<double>(level.playEnd - 1))
+        decodeCache.prefetch(audio, CompressedAudioBuffer::blockOf(level.playStart), 1);
+}
+
+bool ProxySamplerVoice::advanceRegion(const ProxySamplerSound::PlaybackLevel &level, const ReadWindow &window)
+{
+    // The end of a page or block: the next selectReadRegion() picks up the following one
+    if (!window.endsRegion)
+        return true;
+
+    if (region == ReadRegion::source)
+    {
+        const auto &loop = releasePhase ? level.release : level.sustain;
+
+        // Reached the end of the sample: start over from the top and release the note
+        if (!loop.enabled || window.limit != static_cast<double>(loop.seamStart))
+        {
+            if (window.limit <= static_cast<double>(level.playStart))
+                return false;
+
+            readPosition = static_cast<double>(level.playStart);
+            releasePhase = true;
+            attackPhase = false;
+            return true;
+        }
+
+        // Into the pre-rendered crossfade
+        region = releasePhase ? ReadRegion::releaseSeam : ReadRegion::sustainSeam;
+        readPosition -= static_cast<double>(loop.seamStart);
+    }
+    else
+    {
+        // Out of the crossfade and back to just after the loop start
+        const auto &loop = region == ReadRegion::sustainSeam ? level.sustain : level.release;
+        region = ReadRegion::source;
+        readPosition = static_cast<double>(loop.start) + (readPosition - loop.crossfade);
+    }
+
+    return true;
+}
+
+namespace
+{
+    // The inner loop for one channel layout and read mode. Everything that depends on the configuration
+    // is resolved at compile time, so each instantiation is a single straight loop.
+    template <int SourceChannels, int OutputChannels, bool Interpolate>
+    void renderKernel(const float *inL, const float *inR, float *outL, float *outR, int count,
+                      double &position, double &step, double stepDelta,
+                      double &envelope, double envelopeDelta,
+                      float &modulation, float modulationDelta,
+                      float gainL, float gainR, float &peak)
+    {
+        double localPosition = position;
+        double localStep = step;
+        double localEnvelope = envelope;
+        float localModulation = modulation;
+        float localPeak = peak;
+
+        for (int i = 0; i < count; ++i)
+        {
+            const int index = static_cast<int>(localPosition);
+            const float alpha = Interpolate ? static_cast<float>(localPosition - index) : 0.0f;
+            const float level = static_cast<float>(localEnvelope) * localModulation;
+
+            // Nearest-sample reads skip the neighbour fetch and the blend
+            auto read = [&](const float *in)
+            {
+                if constexpr (Interpolate)
+                    return in[index] + alpha * (in[index + 1] - in[index]);
+                else
+                    return in[index];
+            };
+
+            const float left = read(inL) * level;
+
+            if constexpr (OutputChannels == 1)
+            {
+                // A mono output takes the left channel
+                const float l = left * gainL;
+
+                outL[i] += l;
+                localPeak = juce::jmax(localPeak, std::abs(l));
+            }
+            else
+            {
+                // A mono source is read once for both sides
+                float right = left;
+
+                if constexpr (SourceChannels > 1)
+                    right = read(inR) * level;
+
+                const float l = left * gainL;
+                const float r = right * gainR;
+
+                outL[i] += l;
+                outR[i] += r;
+                localPeak = juce::jmax(localPeak, std::abs(l), std::abs(r));
+            }
+
+            localPosition += localStep;
+            localStep += stepDelta;
+            localEnvelope += envelopeDelta;
+            localModulation += modulationDelta;
+        }
+
+        position = localPosition;
+        step = localStep;
+        envelope = localEnvelope;
+        modulation = localModulation;
+        peak = localPeak;
+    }
+}
+
+ProxySamplerVoice::SegmentKernel ProxySamplerVoice::chooseKernel(int sourceChannels, int outputChannels, bool interpolate)
+{
+    // [stereo source][stereo output][interpolate]
+    static constexpr SegmentKernel kernels[2][2][2] = {
+        {{renderKernel<1, 1, false>, renderKernel<1, 1, true>}, {renderKernel<1, 2, false>, renderKernel<1, 2, true>}},
+        {{renderKernel<2, 1, false>, renderKernel<2, 1, true>}, {renderKernel<2, 2, false>, renderKernel<2, 2, true>}}};
+
+    return kernels[sourceChannels > 1 ? 1 : 0][outputChannels > 1 ? 1 : 0][interpolate ? 1 : 0];
+}
+
+void ProxySamplerVoice::beginControlInterval(int offsetInBlock)
+{
+    // Ramp from the current pitch and level to the modulation at the next control point
+    const int point = offsetInBlock / ModulationEngine::CONTROL_INTERVAL + 1;
+    rampFramesLeft = point * ModulationEngine::CONTROL_INTERVAL - offsetInBlock;
+
+    auto *engine = getModulationEngine();
+
+    if (engine == nullptr)
+    {
+        stepDelta = 0.0;
+        modulationGainDelta = 0.0f;
+        return;
+    }
+
+    engine->advance(getNoteModulationState(), rampFramesLeft);
+    const auto targets = engine->evaluate(getNoteModulation(), point);
+
+    stepDelta = (pitchRatio * targets.pitchRatio / levelScale - levelStep) / rampFramesLeft;
+    modulationGainDelta = (targets.gain - modulationGain) / static_cast<float>(rampFramesLeft);
+}
+
+void ProxySamplerVoice::renderNextBlock(juce::AudioBuffer<float> &outputBuffer, int startSample, int numSamples)
+{
+    PROXY_TRACE_SCOPE("voice render");
+
+    if (shouldKill)
+    {
+        clearCurrentNote();
+        return;
+    }
+
+    // The sound owns the level, and stays alive while this voice plays it
+    if (getCurrentlyPlayingSound() == nullptr || playbackLevel == nullptr)
+        return;
+
+    const auto &level = *playbackLevel;
+    prefetchBlocks(level, numSamples);
+
+    auto &destination = getRenderBuffer(outputBuffer);
+    float *outL = destination.getWritePointer(0, startSample);
+    float *outR = destination.getNumChannels() > 1 ? destination.getWritePointer(1, startSample) : nullptr;
+    const auto &layoutKernels = kernels[outR != nullptr ? 1 : 0];
+
+    // Frames needed to cover a distance at a given rate, rounded up
+    auto framesToCover = [](double distance, double rate)
+    {
+        return distance > 0.0 ? static_cast<int>(std::ceil(distance / rate)) : 0;
+    };
+
+    int done = 0;
+
+    // A new host block starts a new control grid
+    if (startSample == 0)
+        rampFramesLeft = 0;
+
+    // Render in segments that end wherever a control interval, the envelope stage or the contiguous
+    // read region ends, so the per-sample loop itself never has to check for any of them
+    while (done < numSamples)
+    {
+        if (rampFramesLeft == 0)
+            beginControlInterval(startSample + done);
+
+        int envelopeFrames = juce::jmin(numSamples - done, rampFramesLeft);
+        double envelopeDelta = 0.0;
+
+        if (attackPhase)
+        {
+            envelopeDelta = attackRate;
+            envelopeFrames = juce::jmin(envelopeFrames, framesToCover(1.0 - envelopeLevel, attackRate));
+        }
+        else if (releasePhase)
+        {
+            envelopeDelta = -releaseRate;
+            envelopeFrames = juce::jmin(envelopeFrames, framesToCover(envelopeLevel, releaseRate));
+        }
+
+        const auto window = selectReadRegion(level);
+
+        // A steady step of exactly one frame, as a pre-rendered note or the unbent root plays, is a plain copy
+        const bool interpolate = isInterpolationEnabled() && (levelStep != 1.0 || stepDelta != 0.0);
+        const SegmentKernel kernel = layoutKernels[interpolate ? 1 : 0];
+
+        // The step may be ramping, so size the read by the larger end of the ramp
+        const double maxStep = juce::jmax(levelStep, levelStep + stepDelta * rampFramesLeft);
+        const int count = juce::jmin(envelopeFrames, framesToCover(window.limit - readPosition, maxStep));
+
+        if (count > 0)
+        {
+            // The kernel works in positions relative to the window, which keeps page offsets small
+            double position = readPosition - window.base;
+            kernel(window.inL, window.inR, outL + done, outR != nullptr ? outR + done : nullptr, count,
+                   position, levelStep, stepDelta, envelopeLevel, envelopeDelta,
+                   modulationGain, modulationGainDelta, lgain, rgain, blockPeak);
+            readPosition = window.base + position;
+            done += count;
+            rampFramesLeft -= count;
+        }
+
+        // Envelope stage transitions
+        if (attackPhase && envelopeLevel >= 1.0)
+        {
+            envelopeLevel = 1.0;
+            attackPhase = false;
+        }
+        else if (releasePhase && envelopeLevel <= 0.0)
+        {
+            clearCurrentNote();
+            return;
+        }
+
+        // Read region transitions
+        if (readPosition >= window.limit && !advanceRegion(level, window))
+        {
+            clearCurrentNote();
+            return;
+        }
+    }
+}
+
+bool ProxySamplerVoice::isVoiceActive() const
+{
+    return getCurrentlyPlayingSound() != nullptr && !releasePhase && !shouldKill;
+}
+
+double ProxySamplerVoice::getCurrentSamplePosition() const
+{
+    if (getCurrentlyPlayingSound() == nullptr || playbackLevel == nullptr)
+        return 0.0;
+
+    // Positions inside a seam map back onto the loop end they replace
+    double position = readPosition;
+
+    if (region != ReadRegion::source)
+    {
+        const auto &level = *playbackLevel;
+        position += static_cast<double>(region == ReadRegion::sustainSeam ? level.sustain.seamStart : level.release.seamStart);
+    }
+
+    return position * levelScale;
+}
+
+float ProxySamplerVoice::takeBlockPeak()
+{
+    const float peak = blockPeak;
+    blockPeak = 0.0f;
+    return peak;
+}
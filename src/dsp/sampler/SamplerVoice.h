@@ -0,0 +1,305 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleLibrary.h"
+#include "ModulationEngine.h"
+#include "BlockDecodeCache.h"
+
+class PitchedNoteCache;
+
+// Custom sampler sound that shares the library's paged or compressed audio, its mipmap octaves
+// and loop seams rendered ahead of time for each of them, and optionally a cache of the sample
+// pre-rendered at the pitch of each note
+class ProxySamplerSound : public juce::SynthesiserSound
+{
+public:
+    // Extra frames after each seam so interpolation can read past its last crossfade frame
+    static constexpr int GUARD_FRAMES = 4;
+
+    // A loop in frames of one playback level. Playback reads the source up to seamStart,
+    // then the pre-rendered seam (the crossfade from the loop end into the loop start),
+    // then carries on from start + crossfade, so every read is a plain contiguous one.
+    struct LoopSeam
+    {
+        juce::int64 start = 0;
+        juce::int64 seamStart = 0;
+        int crossfade = 0;
+        juce::AudioBuffer<float> seam;
+        bool enabled = false;
+    };
+
+    // Audio for one mipmap octave plus its loop seams; exactly one of audio and compressed is set.
+    // Notes play from playStart up to playEnd (exclusive), in frames of this level.
+    struct PlaybackLevel
+    {
+        const PagedAudioBuffer *audio = nullptr;
+        const CompressedAudioBuffer *compressed = nullptr;
+        LoopSeam sustain, release;
+        juce::int64 playStart = 0;
+        juce::int64 playEnd = 0;
+    };
+
+    // What every level is made from, in source frames: the loops, their crossfade, and the part of
+    // the sample notes play, which takes in both loops
+    struct PlaybackRegion
+    {
+        SampleLoop sustainLoop, releaseLoop;
+        int crossfadeFrames = 0;
+        juce::int64 start = 0;
+        juce::int64 end = 0;
+    };
+
+    // Compressed samples are read through each voice's decode cache, unless needsFloatAudio is set
+    // (granular voices read anywhere in the sample), in which case they are decoded up front.
+    // A non-zero noteCacheBytes gives the sound a PitchedNoteCache with that budget. If the sample
+    // has been analysed, notes are tuned to its root, normalised and trimmed to its audible part.
+    ProxySamplerSound(const juce::String &soundName, const SampleData &sample, float loopCrossfadeMs, bool needsFloatAudio = false,
+                      size_t noteCacheBytes = 0);
+
+    // SynthesiserSound interface implementation
+    bool appliesToNote(int /*midiNoteNumber*/) override { return true; }
+    bool appliesToChannel(int /*midiChannel*/) override { return true; }
+
+    // Provide access to the audio data, when it is held as float (see hasFloatAudio())
+    const PagedAudioBuffer &getAudioData() const { return *audioData; }
+    bool hasFloatAudio() const { return audioData != nullptr; }
+
+    juce::int64 getNumFrames() const { return numFrames; }
+    int getNumChannels() const { return numChannels; }
+
+    // MIDI note that plays the sample at its own pitch, and the gain every note is played with
+    double getRootNote() const { return rootNote; }
+    float getNormalisationGain() const { return normalisationGain; }
+
+    // Playback levels: 0 is the source, n is the octave decimated by 2^n
+    int getNumLevels() const { return static_cast<int>(levels.size()); }
+    const PlaybackLevel &getLevel(int octave) const { return levels[static_cast<size_t>(octave)]; }
+
+    // Octave a voice should read for a pitch ratio (only octaves ready when the sound was made)
+    int chooseOctave(double pitchRatio) const;
+
+    // The note pre-rendered at its pitch, or null if there is no cache or it isn't rendered yet
+    // (which asks for it). Lock-free, for the audio thread.
+    const PlaybackLevel *findPitchedNote(int midiNote) const;
+
+    // Null unless the sound was made with a note cache budget
+    const std::shared_ptr<PitchedNoteCache> &getNoteCache() const { return noteCache; }
+
+    // A level for float audio derived from the source, each frame of which covers scale source frames,
+    // with its loop seams rendered and its play range set
+    static PlaybackLevel makeLevel(const PagedAudioBuffer &audio, const PlaybackRegion &playbackRegion, double scale);
+
+    const juce::String &getName() const { return name; }
+
+private:
+    std::shared_ptr<const PagedAudioBuffer> audioData;
+    std::shared_ptr<const CompressedAudioBuffer> compressedData;
+    std::vector<std::unique_ptr<PagedAudioBuffer>> decodedOctaves; // mipmap levels decoded for float readers
+    juce::int64 numFrames = 0;
+    int numChannels = 0;
+    juce::String name;
+    std::shared_ptr<const SampleMipmap> mipmap;
+    std::vector<PlaybackLevel> levels;
+    std::shared_ptr<PitchedNoteCache> noteCache;
+    PlaybackRegion region;
+    double rootNote = SampleAnalysis::DEFAULT_ROOT_NOTE;
+    float normalisationGain = 1.0f;
+
+    // Seams and play range of a level
+    template <typename Audio>
+    static void prepareLevel(PlaybackLevel &level, const Audio &audio, const PlaybackRegion &playbackRegion, double scale);
+
+    template <typename Audio>
+    static LoopSeam buildSeam(const Audio &audio, const SampleLoop &loop, int crossfadeFrames, double scale);
+};
+
+// What the sampler needs from every kind of voice it can play with
+class ProxyVoice : public juce::SynthesiserVoice
+{
+public:
+    virtual void setAttackRate(double newSampleRate, double attackTimeMs) = 0;
+    virtual void setReleaseRate(double newSampleRate, double releaseTimeMs) = 0;
+
+    // Current playback position in frames of the original sample
+    virtual double getCurrentSamplePosition() const = 0;
+
+    virtual int getCurrentMidiNote() const = 0;
+
+    // Output peak since the last call, for per-voice metering
+    virtual float takeBlockPeak() = 0;
+
+    // Render into this buffer instead of the synthesiser's output (null to render directly)
+    void setRenderTarget(juce::AudioBuffer<float> *target) { renderTarget = target; }
+
+    // Nearest-sample reads instead of interpolated ones, when the CPU governor asks for them
+    void setInterpolationEnabled(bool shouldInterpolate) { interpolationEnabled = shouldInterpolate; }
+
+    // Shared pitch bend, MPE, glide and LFO source (null for none)
+    void setModulationEngine(ModulationEngine *engine) { modulationEngine = engine; }
+
+    // Performance controls for this note; in MPE mode each note has its own channel
+    void pitchWheelMoved(int newValue) override { noteModulation.bend = (newValue - 8192) / 8192.0f; }
+    void channelPressureChanged(int newValue) override { noteModulation.pressure = newValue / 127.0f; }
+    void aftertouchChanged(int newValue) override { noteModulation.pressure = newValue / 127.0f; }
+
+    void controllerMoved(int controllerNumber, int newValue) override
+    {
+        if (controllerNumber == 74)
+            noteModulation.timbre = newValue / 127.0f;
+    }
+
+    const NoteModulation &getNoteModulation() const { return noteModulation; }
+
+    // Counts note starts, so per-voice processing can tell a new note from a continuing one
+    juce::uint32 getNoteId() const { return noteId; }
+    float getNoteVelocity() const { return noteVelocity; }
+
+protected:
+    juce::AudioBuffer<float> &getRenderBuffer(juce::AudioBuffer<float> &outputBuffer)
+    {
+        return renderTarget != nullptr ? *renderTarget : outputBuffer;
+    }
+
+    void beginNote(int midiNoteNumber, float velocity, int pitchWheelPosition)
+    {
+        ++noteId;
+        noteVelocity = velocity;
+
+        // The synthesiser has already assigned the channel
+        int channel = 1;
+
+        for (int c = 1; c <= 16; ++c)
+        {
+            if (isPlayingChannel(c))
+            {
+                channel = c;
+                break;
+            }
+        }
+
+        noteModulation = NoteModulation();
+
+        if (modulationEngine != nullptr)
+            modulationEngine->startNote(noteModulation, midiNoteNumber, channel, pitchWheelPosition);
+    }
+
+    bool isInterpolationEnabled() const { return interpolationEnabled; }
+    ModulationEngine *getModulationEngine() const { return modulationEngine; }
+    NoteModulation &getNoteModulationState() { return noteModulation; }
+
+private:
+    juce::AudioBuffer<float> *renderTarget = nullptr;
+    bool interpolationEnabled = true;
+    ModulationEngine *modulationEngine = nullptr;
+    NoteModulation noteModulation;
+    juce::uint32 noteId = 0;
+    float noteVelocity = 0.0f;
+};
+
+// A custom sampler voice that plays a buffer
+class ProxySamplerVoice : public ProxyVoice
+{
+public:
+    ProxySamplerVoice();
+
+    bool canPlaySound(juce::SynthesiserSound *sound) override;
+    void startNote(int midiNoteNumber, float velocity, juce::SynthesiserSound *s, int currentPitchWheelPosition) override;
+    void stopNote(float velocity, bool allowTailOff) override;
+
+    void setAttackRate(double newSampleRate, double attackTimeMs) override;
+    void setReleaseRate(double newSampleRate, double releaseTimeMs) override;
+
+    void renderNextBlock(juce::AudioBuffer<float> &outputBuffer, int startSample, int numSamples) override;
+
+    bool isVoiceActive() const override;
+
+    double getCurrentSamplePosition() const override;
+    int getCurrentMidiNote() const override { return currentMidiNote; }
+    float takeBlockPeak() override;
+
+    // Compressed blocks the render loop had to decode itself because they weren't prefetched (audio thread)
+    juce::uint64 getNumDecodeMisses() const { return decodeCache.getNumMisses(); }
+
+    // Inner loop: interpolated (or nearest) read with linear pitch, envelope and modulation ramps
+    // and gain for count frames. There is one per source channel count, output channel count and
+    // read mode, none of them with a branch on the configuration inside the loop.
+    using SegmentKernel = void (*)(const float *inL, const float *inR, float *outL, float *outR, int count,
+                                   double &position, double &step, double stepDelta,
+                                   double &envelope, double envelopeDelta,
+                                   float &modulation, float modulationDelta,
+                                   float gainL, float gainR, float &peak);
+
+    // Public so the kernels can be benchmarked on their own
+    static SegmentKernel chooseKernel(int sourceChannels, int outputChannels, bool interpolate);
+
+private:
+    // Where the voice is currently reading from
+    enum class ReadRegion
+    {
+        source,
+        sustainSeam,
+        releaseSeam
+    };
+
+    double pitchRatio;
+    float lgain, rgain;
+
+    // Read state: region, position within it, and the step through it
+    ReadRegion region = ReadRegion::source;
+    double readPosition = 0.0;
+
+    // Level being read (a mipmap octave or a pre-rendered note), source frames per frame of it,
+    // and the step through it
+    const ProxySamplerSound::PlaybackLevel *playbackLevel = nullptr;
+    double levelScale = 1.0;
+    double levelStep = 1.0;
+
+    // Control-rate modulation: per-frame ramps towards the next control point
+    double stepDelta = 0.0;
+    float modulationGain = 1.0f;
+    float modulationGainDelta = 0.0f;
+    int rampFramesLeft = 0;
+
+    // Envelope parameters
+    double attackSamples, releaseSamples;
+    double attackRate, releaseRate;
+    bool attackPhase, releasePhase;
+    double envelopeLevel;
+
+    // Metering
+    float blockPeak = 0.0f;
+
+    // MIDI and state
+    int currentMidiNote;
+    double sampleRate;
+    bool shouldKill;
+
+    // Decoded blocks of compressed audio
+    BlockDecodeCache decodeCache;
+
+    // Kernels for the playing sound, by [stereo output][interpolate]
+    SegmentKernel kernels[2][2] = {};
+
+    // One contiguous stretch of audio: the current source page or block, or a seam. Positions inside it are
+    // readPosition - base, and the read ends at limit (in readPosition terms).
+    struct ReadWindow
+    {
+        const float *inL = nullptr;
+        const float *inR = nullptr;
+        double base = 0.0;
+        double limit = 0.0;
+        bool endsRegion = true; // false when the limit is only the end of a page or block
+    };
+
+    // Pick the buffer to read and the position at which the current contiguous read ends
+    ReadWindow selectReadRegion(const ProxySamplerSound::PlaybackLevel &level);
+
+    // Decode the compressed blocks this voice is about to read in numSamples frames, ahead of the render loop
+    void prefetchBlocks(const ProxySamplerSound::PlaybackLevel &level, int numSamples);
+
+    // Move on once the read position reaches the limit; returns false if there is nothing left to read
+    bool advanceRegion(const ProxySamplerSound::PlaybackLevel &level, const ReadWindow &window);
+
+    // Work out the pitch and level ramps up to the next control point
+    void beginControlInterval(int offsetInBlock);
+};
@@ -0,0 +1,94 @@
+#include "BinaryPayload.h"
+
+// Shared by both storage types; readSample(channel, frame) is called in increasing frame order per channel
+template <typename ReadSample>
+static juce::MemoryBlock encodeWaveformPoints(int channelsToUse, juce::int64 numSamples, int &numPointsOut, ReadSample &&readSample)
+{
+    const juce::int64 skipFactor = juce::jmax<juce::int64>(1, numSamples / BinaryPayload::MAX_WAVEFORM_POINTS);
+    const int numPoints = numSamples > 0 ? static_cast<int>((numSamples + skipFactor - 1) / skipFactor) : 0;
+
+    juce::MemoryBlock block(sizeof(float) * static_cast<size_t>(channelsToUse * numPoints));
+    auto *dest = static_cast<float *>(block.getData());
+
+    for (int channel = 0; channel < channelsToUse; ++channel)
+    {
+        for (int i = 0; i < numPoints; ++i)
+            *dest++ = readSample(channel, i * skipFactor);
+    }
+
+    numPointsOut = numPoints;
+    return block;
+}
+
+juce::MemoryBlock BinaryPayload::encodeWaveform(const PagedAudioBuffer &buffer, int maxChannels, int &numPointsOut)
+{
+    return encodeWaveformPoints(juce::jmin(buffer.getNumChannels(), maxChannels), buffer.getNumFrames(), numPointsOut,
+                                [&](int channel, juce::int64 frame) { return buffer.getSample(channel, frame); });
+}
+
+juce::MemoryBlock BinaryPayload::encodeWaveform(const CompressedAudioBuffer &buffer, int maxChannels, int &numPointsOut)
+{
+    // Decode each block once, however many points fall inside it
+    juce::HeapBlock<float> decoded(CompressedAudioBuffer::DECODED_BLOCK_FRAMES);
+    int decodedChannel = -1, decodedBlock = -1;
+
+    return encodeWaveformPoints(juce::jmin(buffer.getNumChannels(), maxChannels), buffer.getNumFrames(), numPointsOut,
+                                [&](int channel, juce::int64 frame)
+                                {
+                                    const int block = CompressedAudioBuffer::blockOf(frame);
+
+                                    if (channel != decodedChannel || block != decodedBlock)
+                                    {
+                                        buffer.decodeBlock(channel, block, decoded.get());
+                                        decodedChannel = channel;
+                                        decodedBlock = block;
+                                    }
+
+                                    return decoded[static_cast<size_t>(frame - CompressedAudioBuffer::blockStart(block))];
+                                });
+}
+
+juce::MemoryBlock BinaryPayload::encodeSampleList(const SampleLibrary &library)
+{
+    juce::StringArray categories = library.getCategories();
+    juce::Array<juce::StringArray> samplesPerCategory;
+
+    for (const auto &category : categories)
+        samplesPerCategory.add(library.getSamplesInCategory(category));
+
+    juce::MemoryOutputStream stream;
+
+    // Header
+    stream.writeInt(categories.size());
+
+    for (const auto &samples : samplesPerCategory)
+        stream.writeInt(samples.size());
+
+    // Names, NUL-separated so the page can decode them all with a single TextDecoder call
+    for (int i = 0; i < categories.size(); ++i)
+    {
+        stream.writeString(categories[i]);
+
+        for (const auto &sample : samplesPerCategory.getReference(i))
+            stream.writeString(sample);
+    }
+
+    return stream.getMemoryBlock();
+}
+
+juce::String BinaryPayload::buildCall(const char *functionName, const juce::MemoryBlock &payload, const juce::String &extraArgs)
+{
+    const juce::String name(functionName);
+    juce::MemoryOutputStream script(static_cast<size_t>(payload.getSize()) * 4 / 3 + 128);
+
+    script << "if (window." << name << ") { window." << name << "('";
+    juce::Base64::convertToBase64(script, payload.getData(), payload.getSize());
+    script << "'";
+
+    if (extraArgs.isNotEmpty())
+        script << ", " << extraArgs;
+
+    script << "); }";
+
+    return script.toString();
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleLibrary.h"
+
+// Encodes bulk UI data as typed binary payloads.
+// The page receives them base64-encoded and views the decoded bytes directly through
+// typed arrays, so there is no number formatting on our side and no JSON parsing on its side.
+class BinaryPayload
+{
+public:
+    // Max number of points per channel sent for the waveform (to keep JavaScript performant)
+    static constexpr int MAX_WAVEFORM_POINTS = 1000;
+
+    // Decimated waveform as little-endian Float32, channel after channel.
+    // numPointsOut receives the number of points per channel.
+    static juce::MemoryBlock encodeWaveform(const PagedAudioBuffer &buffer, int maxChannels, int &numPointsOut);
+    static juce::MemoryBlock encodeWaveform(const CompressedAudioBuffer &buffer, int maxChannels, int &numPointsOut);
+
+    // Categorized sample list: a Uint32 header [numCategories, numSamples per category...]
+    // followed by NUL-separated UTF-8 text "category\0sample\0sample\0category\0..."
+    static juce::MemoryBlock encodeSampleList(const SampleLibrary &library);
+
+    // Build "if (window.fn) { window.fn('<base64>', extraArgs); }" without repeated concatenation
+    static juce::String buildCall(const char *functionName, const juce::MemoryBlock &payload, const juce::String &extraArgs = {});
+};
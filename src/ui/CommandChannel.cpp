@@ -0,0 +1,368 @@
+#include "CommandChannel.h"
+#include "Trace.h"
+
+// Names the page uses for filter modes and LFO shapes, in enum order
+static const juce::StringArray filterModeNames{"off", "lowpass", "bandpass", "highpass", "notch"};
+static const juce::StringArray lfoShapeNames{"sine", "triangle", "saw", "square"};
+
+CommandChannel::CommandChannel(SamplerProcessor &samplerProcessor, EditorSettings &settings)
+    : processor(samplerProcessor),
+      editorSettings(settings)
+{
+}
+
+int CommandChannel::applyBatch(const juce::var &batch)
+{
+    PROXY_TRACE_SCOPE("apply commands");
+
+    auto *object = batch.getDynamicObject();
+
+    if (object == nullptr)
+        return none;
+
+    auto pending = begin();
+    int refresh = none;
+
+    for (const auto &property : object->getProperties())
+        refresh |= apply(pending, property.name.toString(), property.value);
+
+    commit(pending);
+    return refresh;
+}
+
+int CommandChannel::apply(const juce::String &name, const juce::var &value)
+{
+    auto pending = begin();
+    const int refresh = apply(pending, name, value);
+    commit(pending);
+    return refresh;
+}
+
+CommandChannel::Pending CommandChannel::begin() const
+{
+    Pending pending;
+    pending.granular = processor.getGranularParameters();
+    pending.filter = processor.getFilterParameters();
+    pending.modulation = processor.getModulationParameters();
+    return pending;
+}
+
+void CommandChannel::commit(const Pending &pending)
+{
+    if (pending.granularChanged)
+        processor.setGranularParameters(pending.granular);
+
+    if (pending.filterChanged)
+        processor.setFilterParameters(pending.filter);
+
+    if (pending.modulationChanged)
+        processor.setModulationParameters(pending.modulation);
+}
+
+int CommandChannel::apply(Pending &pending, const juce::String &name, const juce::var &value)
+{
+    if (name == "attack")
+    {
+        processor.setAttack(static_cast<float>(value));
+    }
+    else if (name == "release")
+    {
+        processor.setRelease(static_cast<float>(value));
+    }
+    else if (name == "gain")
+    {
+        processor.setGain(static_cast<float>(value));
+    }
+    else if (name == "monophonic")
+    {
+        processor.setMonophonic(static_cast<bool>(value));
+    }
+    else if (name == "compressedStorage")
+    {
+        processor.setCompressedStorage(static_cast<bool>(value));
+    }
+    else if (name == "noteCache")
+    {
+        // Pitched note cache budget in megabytes; 0 turns it off
+        processor.setNoteCacheBudget(static_cast<int>(value));
+    }
+    else if (name == "autoAnalysis")
+    {
+        // Tune, normalise and trim notes from the sample's analysis
+        processor.setAnalysisApplied(static_cast<bool>(value));
+    }
+    else if (name == "record")
+    {
+        // "output" or "sidechain" starts recording from that source, anything else stops it
+        const juce::String source = value.toString();
+
+        if (source == "output" || source == "sidechain")
+            processor.startRecording(source == "sidechain" ? SampleRecorder::Source::sidechain : SampleRecorder::Source::output);
+        else
+            processor.stopRecording();
+
+        return recording;
+    }
+    else if (name == "sustainLoop" || name == "releaseLoop")
+    {
+        // Loop range in sample frames as "start,end"; an empty range clears the loop
+        const juce::String range = value.toString();
+        SampleLoop loop(range.upToFirstOccurrenceOf(",", false, true).getLargeIntValue(),
+                        range.fromFirstOccurrenceOf(",", false, true).getLargeIntValue());
+
+        if (name == "sustainLoop")
+            processor.setSustainLoop(loop);
+        else
+            processor.setReleaseLoop(loop);
+
+        return loops;
+    }
+    else if (name == "loopCrossfade")
+    {
+        processor.setLoopCrossfade(static_cast<float>(value));
+    }
+    else if (name == "playbackMode")
+    {
+        processor.setPlaybackMode(value.toString() == "granular" ? PlaybackMode::granular : PlaybackMode::sample);
+    }
+    else if (name.startsWith("grain"))
+    {
+        // Granular controls: grainPosition, grainSpeed, grainSpray, grainDensity, grainSize, grainPitch
+        auto &granular = pending.granular;
+        const auto number = static_cast<float>(value);
+
+        if (name == "grainPosition")
+            granular.position = number;
+        else if (name == "grainSpeed")
+            granular.speed = number;
+        else if (name == "grainSpray")
+            granular.spray = number;
+        else if (name == "grainDensity")
+            granular.density = number;
+        else if (name == "grainSize")
+            granular.grainSizeMs = number;
+        else if (name == "grainPitch")
+            granular.pitchSemitones = number;
+
+        pending.granularChanged = true;
+    }
+    else if (name.startsWith("filter"))
+    {
+        // Filter controls: filterMode, filterCutoff, filterResonance, filterEnvAmount,
+        // filterVelAmount, filterAttack, filterDecay, filterSustain, filterRelease
+        auto &filter = pending.filter;
+        const auto number = static_cast<float>(value);
+
+        if (name == "filterMode")
+            filter.mode = static_cast<FilterParameters::Mode>(juce::jmax(0, filterModeNames.indexOf(value.toString())));
+        else if (name == "filterCutoff")
+            filter.cutoffHz = number;
+        else if (name == "filterResonance")
+            filter.resonance = number;
+        else if (name == "filterEnvAmount")
+            filter.envelopeAmount = number;
+        else if (name == "filterVelAmount")
+            filter.velocityAmount = number;
+        else if (name == "filterAttack")
+            filter.attackMs = number;
+        else if (name == "filterDecay")
+            filter.decayMs = number;
+        else if (name == "filterSustain")
+            filter.sustain = number;
+        else if (name == "filterRelease")
+            filter.releaseMs = number;
+
+        pending.filterChanged = true;
+    }
+    else if (name.startsWith("mod"))
+    {
+        // Modulation controls: modMpe, modBendRange, modMpeRange, modGlide, modPressure, modTimbre,
+        // and modLfo1/modLfo2 followed by Rate, Depth, Shape or Target
+        auto &modulation = pending.modulation;
+        const auto number = static_cast<float>(value);
+
+        if (name == "modMpe")
+            modulation.mpeEnabled = static_cast<bool>(value);
+        else if (name == "modBendRange")
+            modulation.pitchBendRange = number;
+        else if (name == "modMpeRange")
+            modulation.mpeBendRange = number;
+        else if (name == "modGlide")
+            modulation.glideMs = number;
+        else if (name == "modPressure")
+            modulation.pressureToVolume = number;
+        else if (name == "modTimbre")
+            modulation.timbreToCutoff = number;
+        else if (name.startsWith("modLfo"))
+        {
+            const int index = juce::jlimit(1, ModulationParameters::NUM_LFOS, name.substring(6, 7).getIntValue()) - 1;
+            auto &lfo = modulation.lfos[static_cast<size_t>(index)];
+            const juce::String control = name.substring(7);
+
+            if (control == "Rate")
+                lfo.rateHz = number;
+            else if (control == "Depth")
+                lfo.depth = number;
+            else if (control == "Shape")
+                lfo.shape = static_cast<ModulationParameters::LfoShape>(juce::jmax(0, lfoShapeNames.indexOf(value.toString())));
+            else if (control == "Target")
+                lfo.target = value.toString() == "volume" ? ModulationParameters::LfoTarget::volume : ModulationParameters::LfoTarget::pitch;
+        }
+
+        pending.modulationChanged = true;
+    }
+    else if (name == "reverbImpulse")
+    {
+        // Sample to use as the reverb's impulse response; empty turns the reverb off
+        processor.setReverbImpulse(value.toString());
+    }
+    else if (name == "reverbMix")
+    {
+        processor.setReverbMix(static_cast<float>(value));
+    }
+#if PROXY_TRACING
+    else if (name == "exportTrace")
+    {
+        // Save the recorded trace events next to the user's samples, for chrome://tracing or Perfetto
+        auto file = processor.getSampleLibrary().getSamplesFolder().getParentDirectory()
+                        .getNonexistentChildFile("Proxy trace " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S"), ".json");
+
+        if (Trace::writeChromeJson(file))
+            juce::Logger::writeToLog("Trace written to " + file.getFullPathName());
+    }
+#endif
+    else if (name == "sample")
+    {
+        if (processor.setSample(value.toString()))
+            return waveform;
+    }
+    else if (name == "refreshSamples")
+    {
+        processor.refreshSamples();
+        return samplesList | waveform;
+    }
+    else if (name == "browseSample")
+    {
+        return browse;
+    }
+    else if (name == "editorMode")
+    {
+        // This instance's editor: "default", "web" or "native"
+        editorSettings.setMode(EditorSettings::fromString(value.toString()));
+        return editor;
+    }
+    else if (name == "defaultEditor")
+    {
+        // The editor for every instance that follows the default: "web" or "native"
+        EditorSettings::setDefault(EditorSettings::fromString(value.toString()));
+        return editor;
+    }
+
+    return none;
+}
+
+juce::var CommandChannel::get(const juce::String &name) const
+{
+    if (name == "attack")
+        return processor.getAttack();
+    if (name == "release")
+        return processor.getRelease();
+    if (name == "gain")
+        return processor.getGain();
+    if (name == "monophonic")
+        return processor.isMonophonic();
+    if (name == "compressedStorage")
+        return processor.isCompressedStorage();
+    if (name == "noteCache")
+        return processor.getNoteCacheBudget();
+    if (name == "autoAnalysis")
+        return processor.isAnalysisApplied();
+    if (name == "loopCrossfade")
+        return processor.getLoopCrossfade();
+    if (name == "playbackMode")
+        return processor.getPlaybackMode() == PlaybackMode::granular ? "granular" : "sample";
+    if (name == "reverbImpulse")
+        return processor.getReverbImpulse();
+    if (name == "reverbMix")
+        return processor.getReverbMix();
+    if (name == "editorMode")
+        return EditorSettings::toString(editorSettings.getMode());
+    if (name == "defaultEditor")
+        return EditorSettings::toString(EditorSettings::getDefault());
+
+    if (name.startsWith("grain"))
+    {
+        const auto &granular = processor.getGranularParameters();
+
+        if (name == "grainPosition")
+            return granular.position;
+        if (name == "grainSpeed")
+            return granular.speed;
+        if (name == "grainSpray")
+            return granular.spray;
+        if (name == "grainDensity")
+            return granular.density;
+        if (name == "grainSize")
+            return granular.grainSizeMs;
+        if (name == "grainPitch")
+            return granular.pitchSemitones;
+    }
+    else if (name.startsWith("filter"))
+    {
+        const auto &filter = processor.getFilterParameters();
+
+        if (name == "filterMode")
+            return filterModeNames[static_cast<int>(filter.mode)];
+        if (name == "filterCutoff")
+            return filter.cutoffHz;
+        if (name == "filterResonance")
+            return filter.resonance;
+        if (name == "filterEnvAmount")
+            return filter.envelopeAmount;
+        if (name == "filterVelAmount")
+            return filter.velocityAmount;
+        if (name == "filterAttack")
+            return filter.attackMs;
+        if (name == "filterDecay")
+            return filter.decayMs;
+        if (name == "filterSustain")
+            return filter.sustain;
+        if (name == "filterRelease")
+            return filter.releaseMs;
+    }
+    else if (name.startsWith("mod"))
+    {
+        const auto &modulation = processor.getModulationParameters();
+
+        if (name == "modMpe")
+            return modulation.mpeEnabled;
+        if (name == "modBendRange")
+            return modulation.pitchBendRange;
+        if (name == "modMpeRange")
+            return modulation.mpeBendRange;
+        if (name == "modGlide")
+            return modulation.glideMs;
+        if (name == "modPressure")
+            return modulation.pressureToVolume;
+        if (name == "modTimbre")
+            return modulation.timbreToCutoff;
+
+        if (name.startsWith("modLfo"))
+        {
+            const int index = juce::jlimit(1, ModulationParameters::NUM_LFOS, name.substring(6, 7).getIntValue()) - 1;
+            const auto &lfo = modulation.lfos[static_cast<size_t>(index)];
+            const juce::String control = name.substring(7);
+
+            if (control == "Rate")
+                return lfo.rateHz;
+            if (control == "Depth")
+                return lfo.depth;
+            if (control == "Shape")
+                return lfoShapeNames[static_cast<int>(lfo.shape)];
+            if (control == "Target")
+                return lfo.target == ModulationParameters::LfoTarget::volume ? "volume" : "pitch";
+        }
+    }
+
+    return {};
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SamplerProcessor.h"
+#include "EditorSettings.h"
+
+// Control changes from the page to the processor. The page merges repeated changes to the same
+// control within an animation frame and sends each frame's changes as one object of typed values
+// ({"attack": 12.5, "monophonic": true, ...}), so a fast drag costs one dispatch per frame rather
+// than one navigation per mouse event. The native editor sends the same commands one at a time.
+// Message thread.
+class CommandChannel
+{
+public:
+    // What a batch changed that the view shows, so it can refresh each at most once per batch
+    enum Refresh
+    {
+        none = 0,
+        loops = 1 << 0,
+        waveform = 1 << 1,
+        samplesList = 1 << 2,
+        recording = 1 << 3,
+        browse = 1 << 4, // the page asked for the file browser
+        editor = 1 << 5  // the instance's editor choice changed
+    };
+
+    CommandChannel(SamplerProcessor &processor, EditorSettings &editorSettings);
+
+    // Apply a batch object; returns the Refresh flags of everything in it
+    int applyBatch(const juce::var &batch);
+
+    // Apply one command; strings are accepted wherever a number or flag is expected
+    int apply(const juce::String &name, const juce::var &value);
+
+    // Current value of a command's control in the type the page sends it; void for commands
+    // that aren't controls (sample, refreshSamples, browseSample, record)
+    juce::var get(const juce::String &name) const;
+
+private:
+    SamplerProcessor &processor;
+    EditorSettings &editorSettings;
+
+    // Grouped parameters are gathered over a batch and set once at the end of it
+    struct Pending
+    {
+        GranularParameters granular;
+        FilterParameters filter;
+        ModulationParameters modulation;
+        bool granularChanged = false;
+        bool filterChanged = false;
+        bool modulationChanged = false;
+    };
+
+    int apply(Pending &pending, const juce::String &name, const juce::var &value);
+    Pending begin() const;
+    void commit(const Pending &pending);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CommandChannel)
+};
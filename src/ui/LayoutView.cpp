@@ -1,8 +1,28 @@
 #include "LayoutView.h"
 #include "BinaryData.h"
+#include "BinaryPayload.h"
+#include "ProcessMemory.h"
+#include "Trace.h"
+
+// Options for the editor's WebView: pages and styles come from the shared PageResources, and
+// control changes arrive as "proxyCommands" events
+static juce::WebBrowserComponent::Options createWebViewOptions(LayoutView &owner, const PageResources &pageResources)
+{
+    return juce::WebBrowserComponent::Options{}
+        .withBackend(juce::WebBrowserComponent::Options::Backend::webview2)
+        .withWinWebView2Options(juce::WebBrowserComponent::Options::WinWebView2{}
+                                    .withUserDataFolder(juce::File::getSpecialLocation(juce::File::tempDirectory)))
+        .withKeepPageLoadedWhenBrowserIsHidden()
+        .withNativeIntegrationEnabled()
+        .withEventListener("proxyCommands", [&owner](const juce::var &batch)
+                           { owner.handleCommands(batch); })
+        .withResourceProvider([&pageResources](const juce::String &url)
+                              { return pageResources.getResource(url); });
+}
 
 LayoutView::LayoutMessageHandler::LayoutMessageHandler(LayoutView &owner)
-    : ownerView(owner)
+    : juce::WebBrowserComponent(createWebViewOptions(owner, *owner.pageResources)),
+      ownerView(owner)
 {
 }
 
@@ -13,83 +33,18 @@ bool LayoutView::LayoutMessageHandler::pageAboutToLoad(const juce::String &url)
     {
         juce::String params = url.fromFirstOccurrenceOf("proxy:", false, true);
 
-        // Handle sampler parameters
-        if (params.startsWith("sampler:"))
+        // The page has finished loading and its script is ready for state
+        if (params == "ready")
         {
-            params = params.fromFirstOccurrenceOf("sampler:", false, true);
-
-            if (params.startsWith("attack="))
-            {
-                float value = params.fromFirstOccurrenceOf("attack=", false, true).getFloatValue();
-                ownerView.samplerProcessor.setAttack(value);
-                return false;
-            }
-            else if (params.startsWith("release="))
-            {
-                float value = params.fromFirstOccurrenceOf("release=", false, true).getFloatValue();
-                ownerView.samplerProcessor.setRelease(value);
-                return false;
-            }
-            else if (params.startsWith("gain="))
-            {
-                float value = params.fromFirstOccurrenceOf("gain=", false, true).getFloatValue();
-                ownerView.samplerProcessor.setGain(value);
-                return false;
-            }
-            else if (params.startsWith("monophonic="))
-            {
-                bool value = params.fromFirstOccurrenceOf("monophonic=", false, true).getIntValue() != 0;
-                ownerView.samplerProcessor.setMonophonic(value);
-                return false;
-            }
-            else if (params.startsWith("sample="))
-            {
-                juce::String sampleName = params.fromFirstOccurrenceOf("sample=", false, true);
-                sampleName = juce::URL::removeEscapeChars(sampleName);
-
-                bool success = ownerView.samplerProcessor.setSample(sampleName);
-
-                if (success)
-                {
-                    ownerView.updateWaveformDisplay(); // Update the waveform display directly
-                }
-                return false;
-            }
-            else if (params.startsWith("refreshSamples"))
-            {
-                ownerView.samplerProcessor.refreshSamples();
-
-                // Update the UI with the new samples list
-                ownerView.updateSamplesList();
-
-                // Also update the waveform for the current sample
-                ownerView.updateWaveformDisplay();
+            ownerView.handlePageReady();
+            return false;
+        }
 
-                return false;
-            }
-            else if (params.startsWith("browseSample"))
-            {
-                // Open a file browser to load a new sample
-                juce::FileChooser chooser("Select a Sample File...",
-                                          juce::File::getSpecialLocation(juce::File::userMusicDirectory),
-                                          "*.wav;*.aif;*.aiff;*.mp3");
-
-                // Use launchAsync with a lambda callback instead of browseForFileToOpen
-                chooser.launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
-                                    [this](const juce::FileChooser &fc)
-                                    {
-                                        auto result = fc.getResult();
-                                        if (result.exists())
-                                        {
-                                            ownerView.samplerProcessor.loadSample(result);
-
-                                            // Update waveform display after loading new sample
-                                            ownerView.updateWaveformDisplay();
-                                        }
-                                    });
-
-                return false;
-            }
+        // A batch of control changes, from pages without the native event channel
+        if (params.startsWith("batch:"))
+        {
+            ownerView.handleCommands(juce::JSON::parse(juce::URL::removeEscapeChars(params.fromFirstOccurrenceOf("batch:", false, true))));
+            return false;
         }
 
         // We handled this URL
@@ -127,13 +82,13 @@ bool LayoutView::LayoutMessageHandler::pageAboutToLoad(const juce::String &url)
 }
 
 // Main LayoutView implementation
-LayoutView::LayoutView(SamplerProcessor &proc)
+LayoutView::LayoutView(SamplerProcessor &proc, TelemetryChannel &telemetryChannel, EditorSettings &editorSettings)
     : samplerProcessor(proc),
+      telemetry(telemetryChannel),
+      commands(proc, editorSettings),
       pageLoaded(false),
-      lastLeftLevel(0.0f),
-      lastRightLevel(0.0f),
-      lastPlaybackPosition(0),
-      voicesActive(false),
+      openStartTimeMs(juce::Time::getMillisecondCounterHiRes()),
+      openStartMemory(ProcessMemory::getResidentBytes()),
       lastAttackMs(proc.getAttack()),
       lastReleaseMs(proc.getRelease()),
       lastGain(proc.getGain()),
@@ -145,23 +100,8 @@ LayoutView::LayoutView(SamplerProcessor &proc)
     webView->setFocusContainerType(juce::Component::FocusContainerType::none);
     addAndMakeVisible(webView.get());
 
-    juce::String htmlContent = juce::String(BinaryData::layout_html, BinaryData::layout_htmlSize);
-    juce::String cssContent = juce::String(BinaryData::layout_css, BinaryData::layout_cssSize);
-
-    // Replace the CSS link with the actual CSS content inline
-    htmlContent = htmlContent.replace(
-        "<link rel=\"stylesheet\" href=\"./layout.css\" />",
-        "<style>\n" + cssContent + "\n</style>");
-
-    // Load the HTML content with the CSS embedded
-    webView->goToURL(juce::String("data:text/html;charset=utf-8,") + htmlContent);
-
-    // Initialize voice positions array
-    for (auto &voicePos : lastVoicePositions)
-    {
-        voicePos.position = 0;
-        voicePos.isActive = false;
-    }
+    // Load the cached page; it reports back with proxy:ready once its script has run
+    webView->goToURL(PageResources::getPageURL());
 
     // Start the timer for UI updates
     startTimerHz(30);
@@ -184,240 +124,317 @@ void LayoutView::resized()
     webView->setBounds(getLocalBounds());
 }
 
-void LayoutView::updateLevels(float leftLevel, float rightLevel)
+void LayoutView::pushTelemetry(const TelemetryFrame &frame)
 {
-    if (!pageLoaded)
-        return;
+    PROXY_TRACE_SCOPE("push telemetry");
 
-    // Store the last known levels
-    lastLeftLevel = leftLevel;
-    lastRightLevel = rightLevel;
+    // Scale meter values for display (convert to dB, then map -60dB..0dB to 0%..100%)
+    auto toPercent = [](float level)
+    {
+        const float db = juce::Decibels::gainToDecibels(level, -60.0f);
+        return juce::String(juce::jlimit(0.0f, 100.0f, juce::jmap(db, -60.0f, 0.0f, 0.0f, 100.0f)), 1);
+    };
+
+    const auto &meters = frame.meters;
+    const float truePeakDb = juce::Decibels::gainToDecibels(juce::jmax(meters.truePeak[0], meters.truePeak[1]), -100.0f);
+
+    // Compact frame, see window.updateTelemetry for the layout
+    juce::String script;
+    script.preallocateBytes(256);
+    script << "if (window.updateTelemetry) { window.updateTelemetry(["
+           << toPercent(meters.rms[0]) << "," << toPercent(meters.rms[1]) << ","
+           << toPercent(meters.peakHold[0]) << "," << toPercent(meters.peakHold[1]) << ","
+           << juce::String(truePeakDb, 1) << ","
+           << juce::String(meters.shortTermLufs, 1) << ","
+           << juce::String(meters.integratedLufs, 1) << ","
+           << frame.sampleLength;
+
+    for (juce::int64 position : frame.voicePositions)
+        script << "," << position;
+
+    for (float level : frame.voiceLevels)
+        script << "," << toPercent(level);
+
+    script << "]); }";
+
+    // Nothing visible changed since the last frame, so don't wake the WebView
+    if (script == lastTelemetryScript)
+        return;
 
-    // If signal is very close to zero, explicitly set it to zero
-    if (leftLevel < 0.01f)
-        leftLevel = 0.0f;
-    if (rightLevel < 0.01f)
-        rightLevel = 0.0f;
+    lastTelemetryScript = script;
 
     try
     {
-        // Update meters in the WebView - fix string concatenation
-        juce::String script = juce::String("if (window.updateMeters) { window.updateMeters(") +
-                              juce::String(leftLevel, 1) + juce::String(", ") +
-                              juce::String(rightLevel, 1) + juce::String("); }");
-
         webView->evaluateJavascript(script);
     }
     catch (const std::exception &e)
     {
         // Log any errors for debugging
-        juce::Logger::writeToLog("JavaScript error in meters: " + juce::String(e.what()));
+        juce::Logger::writeToLog("JavaScript error in telemetry: " + juce::String(e.what()));
     }
 }
 
-void LayoutView::updatePlaybackPosition(int position)
+void LayoutView::updateSamplesList()
 {
+    PROXY_TRACE_SCOPE("push sample list");
+
     if (!pageLoaded)
         return;
 
-    lastPlaybackPosition = position;
-
-    try
-    {
-        // Update waveform display in the WebView
-        juce::String script = juce::String("if (window.updatePlaybackPosition) { window.updatePlaybackPosition(") +
-                              juce::String(position) + juce::String("); }");
-
-        // Add visibility check to the script
-        script += juce::String("\nif (document.getElementById('playbackPosition')) { document.getElementById('playbackPosition').style.display = '") +
-                  juce::String(samplerProcessor.isAnyVoiceActive() ? "block" : "none") + juce::String("'; }");
+    lastLibraryRevision = samplerProcessor.getSampleLibrary().getRevision();
 
-        webView->evaluateJavascript(script);
-    }
-    catch (const std::exception &e)
-    {
-        // Log any errors for debugging
-        juce::Logger::writeToLog("JavaScript error in waveform: " + juce::String(e.what()));
-    }
+    // Send the categorized samples as one binary blob
+    auto payload = BinaryPayload::encodeSampleList(samplerProcessor.getSampleLibrary());
+    webView->evaluateJavascript(BinaryPayload::buildCall("setSampleListData", payload));
 }
 
-void LayoutView::updateAllPlaybackPositions()
+void LayoutView::updateWaveformDisplay()
 {
+    PROXY_TRACE_SCOPE("push waveform");
+
     if (!pageLoaded)
         return;
 
-    // Get all voice positions from the sampler
-    const auto &voicePositions = samplerProcessor.getAllVoicePositions();
-
-    // Convert voice positions to JSON for JavaScript
-    juce::String positionsJson = "[";
-
-    for (int i = 0; i < SamplerProcessor::MAX_VOICES; ++i)
-    {
-        positionsJson += "{\"position\":" + juce::String(voicePositions[i].position) +
-                         ",\"isActive\":" + (voicePositions[i].isActive ? "true" : "false") + "}";
-
-        if (i < SamplerProcessor::MAX_VOICES - 1)
-            positionsJson += ",";
-    }
-
-    positionsJson += "]";
-
-    // Get sample data for the total length
+    // Get current sample data
     auto sampleName = samplerProcessor.getCurrentSampleName();
     auto sampleData = samplerProcessor.getSampleLibrary().getSampleAudioBuffer(sampleName);
-    int totalSampleLength = sampleData.buffer ? sampleData.buffer->getNumSamples() : 0;
 
-    // Call the JavaScript function to update all playheads
-    juce::String script = "if (window.updateMultiplePlayheads) { window.updateMultiplePlayheads(" +
-                          positionsJson + ", " + juce::String(totalSampleLength) + "); }";
-
-    try
+    if (sampleData.getNumFrames() > 0)
     {
-        webView->evaluateJavascript(script);
-    }
-    catch (const std::exception &e)
-    {
-        // Log any errors for debugging
-        juce::Logger::writeToLog("JavaScript error in multiple playheads: " + juce::String(e.what()));
+        // We'll send a downsampled version of the waveform data to JavaScript as Float32 data
+        const int channelsToUse = juce::jmin(sampleData.getNumChannels(), 2);
+        int numPoints = 0;
+        auto payload = sampleData.buffer != nullptr ? BinaryPayload::encodeWaveform(*sampleData.buffer, channelsToUse, numPoints)
+                                                    : BinaryPayload::encodeWaveform(*sampleData.compressed, channelsToUse, numPoints);
+
+        juce::String extraArgs;
+        extraArgs << channelsToUse << ", " << numPoints << ", " << sampleData.getNumFrames();
+
+        webView->evaluateJavascript(BinaryPayload::buildCall("setWaveformBinary", payload, extraArgs));
     }
+
+    // Loop points belong to the sample, so they change along with the waveform
+    updateLoopDisplay();
 }
 
-void LayoutView::updateSamplesList()
+void LayoutView::updateLoopDisplay()
 {
+    PROXY_TRACE_SCOPE("push loop regions");
+
     if (!pageLoaded)
         return;
 
-    // Get categorized samples data
-    const SampleLibrary &library = samplerProcessor.getSampleLibrary();
-    juce::StringArray categories = library.getCategories();
-
-    // Create JSON structure for categories and their samples
-    juce::String categoryDataJson = "[";
+    const auto &sustainLoop = samplerProcessor.getSustainLoop();
+    const auto &releaseLoop = samplerProcessor.getReleaseLoop();
 
-    for (int i = 0; i < categories.size(); ++i)
-    {
-        const juce::String &category = categories[i];
-        juce::StringArray samplesInCategory = library.getSamplesInCategory(category);
+    juce::String script;
+    script << "if (window.setLoopRegions) { window.setLoopRegions("
+           << sustainLoop.start << ", " << sustainLoop.end << ", "
+           << releaseLoop.start << ", " << releaseLoop.end << ", "
+           << samplerProcessor.getLoopCrossfade() << "); }";
 
-        // Only include categories with samples
-        if (samplesInCategory.size() > 0)
-        {
-            juce::String categoryJson = "{\"name\":\"" + juce::String(category).replace("\\", "\\\\").replace("\"", "\\\"") + "\",\"samples\":[";
+    webView->evaluateJavascript(script);
+}
 
-            for (int j = 0; j < samplesInCategory.size(); ++j)
-            {
-                // Properly escape sample names for JSON
-                juce::String sampleName = samplesInCategory[j].replace("\\", "\\\\").replace("\"", "\\\"");
-                categoryJson += "\"" + sampleName + "\"";
-                if (j < samplesInCategory.size() - 1)
-                    categoryJson += ",";
-            }
+void LayoutView::handlePageReady()
+{
+    PROXY_TRACE_SCOPE("push page state");
 
-            categoryJson += "]}";
+    // A reload sends another ready message, so always push the full state
+    pageLoaded = true;
+    lastTelemetryScript.clear();
 
-            categoryDataJson += categoryJson;
-            if (i < categories.size() - 1)
-                categoryDataJson += ",";
-        }
+    if (!openTimeReported)
+    {
+        openTimeReported = true;
+        const double openTimeMs = juce::Time::getMillisecondCounterHiRes() - openStartTimeMs;
+        lastOpenTimeMs = openTimeMs;
+        juce::Logger::writeToLog("Proxy web editor ready in " + juce::String(openTimeMs, 1) + " ms, process memory "
+                                 + ProcessMemory::describeGrowth(openStartMemory, ProcessMemory::getResidentBytes())
+                                 + " (not counting the browser's own processes)");
     }
 
-    categoryDataJson += "]";
-
-    // Send the categorized samples data to JavaScript
-    juce::String script = "if (window.updateCategorizedSamplesList) { window.updateCategorizedSamplesList(" +
-                          categoryDataJson + "); }";
+    // Use the current values, which may have changed while the page was loading
+    lastAttackMs = samplerProcessor.getAttack();
+    lastReleaseMs = samplerProcessor.getRelease();
+    lastGain = samplerProcessor.getGain();
+    lastMonophonic = samplerProcessor.isMonophonic();
+    lastSampleName = samplerProcessor.getCurrentSampleName();
+
+    // Initialize with current values
+    juce::String script = juce::String("if (window.initializeSampler) { window.initializeSampler({") +
+                          juce::String("attack: ") + juce::String(lastAttackMs) + juce::String(", ") +
+                          juce::String("release: ") + juce::String(lastReleaseMs) + juce::String(", ") +
+                          juce::String("gain: ") + juce::String(lastGain) + juce::String(", ") +
+                          juce::String("sampleName: '") + lastSampleName.replace("'", "\\'") + juce::String("'") +
+                          "}); }";
 
     webView->evaluateJavascript(script);
-}
-
-void LayoutView::updateWaveformDisplay()
-{
-    if (!pageLoaded)
-        return;
-
-    // Get current sample data
-    auto sampleName = samplerProcessor.getCurrentSampleName();
-    auto sampleData = samplerProcessor.getSampleLibrary().getSampleAudioBuffer(sampleName);
 
-    if (sampleData.buffer && sampleData.buffer->getNumSamples() > 0)
+    // Initialize monophonic toggle
+    juce::String monoScript = juce::String("if (window.updateMonophonicState) { window.updateMonophonicState(") +
+                              (lastMonophonic ? "true" : "false") + juce::String("); }");
+    webView->evaluateJavascript(monoScript);
+
+    // Initialize the sample storage toggle
+    juce::String storageScript = juce::String("if (window.updateStorageState) { window.updateStorageState(") +
+                                 (samplerProcessor.isCompressedStorage() ? "true" : "false") + juce::String("); }");
+    webView->evaluateJavascript(storageScript);
+
+    // Initialize the note cache budget
+    juce::String noteCacheScript = juce::String("if (window.updateNoteCacheState) { window.updateNoteCacheState(") +
+                                   juce::String(samplerProcessor.getNoteCacheBudget()) + juce::String("); }");
+    webView->evaluateJavascript(noteCacheScript);
+
+    // Initialize the sample analysis toggle
+    juce::String analysisScript = juce::String("if (window.updateAnalysisState) { window.updateAnalysisState(") +
+                                  (samplerProcessor.isAnalysisApplied() ? "true" : "false") + juce::String("); }");
+    webView->evaluateJavascript(analysisScript);
+
+    // Initialize the recording controls
+    updateRecordState();
+
+    // Initialize playback mode and granular controls
+    const auto &granular = samplerProcessor.getGranularParameters();
+    juce::String granularScript;
+    granularScript << "if (window.updateGranularState) { window.updateGranularState({"
+                   << "granular: " << (samplerProcessor.getPlaybackMode() == PlaybackMode::granular ? "true" : "false")
+                   << ", position: " << granular.position
+                   << ", speed: " << granular.speed
+                   << ", spray: " << granular.spray
+                   << ", density: " << granular.density
+                   << ", size: " << granular.grainSizeMs
+                   << ", pitch: " << granular.pitchSemitones
+                   << "}); }";
+    webView->evaluateJavascript(granularScript);
+
+    // Initialize filter controls
+    const auto &filter = samplerProcessor.getFilterParameters();
+    juce::String filterScript;
+    filterScript << "if (window.updateFilterState) { window.updateFilterState({"
+                 << "mode: " << static_cast<int>(filter.mode)
+                 << ", cutoff: " << filter.cutoffHz
+                 << ", resonance: " << filter.resonance
+                 << ", envAmount: " << filter.envelopeAmount
+                 << ", velAmount: " << filter.velocityAmount
+                 << ", attack: " << filter.attackMs
+                 << ", decay: " << filter.decayMs
+                 << ", sustain: " << filter.sustain
+                 << ", release: " << filter.releaseMs
+                 << "}); }";
+    webView->evaluateJavascript(filterScript);
+
+    // Initialize modulation controls
+    const auto &modulation = samplerProcessor.getModulationParameters();
+    juce::String modulationScript;
+    modulationScript << "if (window.updateModulationState) { window.updateModulationState({"
+                     << "mpe: " << (modulation.mpeEnabled ? 1 : 0)
+                     << ", bendRange: " << modulation.pitchBendRange
+                     << ", mpeRange: " << modulation.mpeBendRange
+                     << ", glide: " << modulation.glideMs
+                     << ", pressure: " << modulation.pressureToVolume
+                     << ", timbre: " << modulation.timbreToCutoff;
+
+    for (int l = 0; l < ModulationParameters::NUM_LFOS; ++l)
     {
-        // We'll send a downsampled version of the waveform data to JavaScript
-        const int channelsToUse = juce::jmin(sampleData.buffer->getNumChannels(), 2);
-        const int numSamples = sampleData.buffer->getNumSamples();
+        const auto &lfo = modulation.lfos[static_cast<size_t>(l)];
+        const juce::String key = "lfo" + juce::String(l + 1);
 
-        // Max number of points to send (to keep JavaScript performant)
-        const int maxPoints = 1000;
-        const int skipFactor = juce::jmax(1, numSamples / maxPoints);
+        modulationScript << ", " << key << "Rate: " << lfo.rateHz
+                         << ", " << key << "Depth: " << lfo.depth
+                         << ", " << key << "Shape: " << static_cast<int>(lfo.shape)
+                         << ", " << key << "Target: " << static_cast<int>(lfo.target);
+    }
 
-        juce::String waveformData = "[";
+    modulationScript << "}); }";
+    webView->evaluateJavascript(modulationScript);
+
+    // Initialize reverb controls
+    juce::String reverbScript;
+    reverbScript << "if (window.updateReverbState) { window.updateReverbState({"
+                 << "impulse: '" << samplerProcessor.getReverbImpulse().replace("'", "\\'") << "'"
+                 << ", mix: " << samplerProcessor.getReverbMix()
+                 << "}); }";
+    webView->evaluateJavascript(reverbScript);
+
+    // Initialize the editor choice
+    juce::String editorScript;
+    editorScript << "if (window.updateEditorState) { window.updateEditorState({"
+                 << "mode: '" << commands.get("editorMode").toString() << "'"
+                 << ", defaultMode: '" << commands.get("defaultEditor").toString() << "'"
+                 << "}); }";
+    webView->evaluateJavascript(editorScript);
+
+    // Update the samples list
+    updateSamplesList();
+
+    // Initialize waveform display with current sample data
+    updateWaveformDisplay();
+}
 
-        for (int channel = 0; channel < channelsToUse; ++channel)
-        {
-            waveformData += "[";
-            const float *channelData = sampleData.buffer->getReadPointer(channel);
+void LayoutView::handleCommands(const juce::var &batch)
+{
+    const int refresh = commands.applyBatch(batch);
 
-            for (int i = 0; i < numSamples; i += skipFactor)
-            {
-                waveformData += juce::String(channelData[i]);
+    if (refresh & CommandChannel::loops)
+        updateLoopDisplay();
 
-                if (i + skipFactor < numSamples)
-                    waveformData += ",";
-            }
+    if (refresh & CommandChannel::samplesList)
+        updateSamplesList();
 
-            waveformData += "]";
+    if (refresh & CommandChannel::waveform)
+        updateWaveformDisplay();
 
-            if (channel < channelsToUse - 1)
-                waveformData += ",";
-        }
-
-        waveformData += "]";
+    if (refresh & CommandChannel::recording)
+        updateRecordState();
 
-        // Send waveform data to JavaScript
-        juce::String script = "if (window.setWaveformData) { window.setWaveformData(" +
-                              waveformData + ", " +
-                              juce::String(numSamples) + "); }";
+    if ((refresh & CommandChannel::editor) && onEditorModeChanged)
+        onEditorModeChanged();
 
-        webView->evaluateJavascript(script);
+    if (refresh & CommandChannel::browse)
+    {
+        // Open a file browser to load a new sample
+        fileChooser = std::make_unique<juce::FileChooser>("Select a Sample File...",
+                                                          juce::File::getSpecialLocation(juce::File::userMusicDirectory),
+                                                          "*.wav;*.aif;*.aiff;*.mp3");
+
+        fileChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                 [this](const juce::FileChooser &fc)
+                                 {
+                                     auto result = fc.getResult();
+                                     if (result.exists())
+                                     {
+                                         samplerProcessor.loadSample(result);
+
+                                         // Update waveform display after loading new sample
+                                         updateWaveformDisplay();
+                                     }
+                                 });
     }
 }
 
-void LayoutView::timerCallback()
+void LayoutView::updateRecordState()
 {
-    // Check if the page is loaded
-    if (!pageLoaded)
-    {
-        static int pageLoadCounter = 0;
-        pageLoadCounter++;
-
-        if (pageLoadCounter >= 10) // Wait about 333ms with 30Hz timer
-        {
-            pageLoaded = true;
-
-            // Initialize with current values - fix string concatenation issue
-            juce::String script = juce::String("if (window.initializeSampler) { window.initializeSampler({") +
-                                  juce::String("attack: ") + juce::String(lastAttackMs) + juce::String(", ") +
-                                  juce::String("release: ") + juce::String(lastReleaseMs) + juce::String(", ") +
-                                  juce::String("gain: ") + juce::String(lastGain) + juce::String(", ") +
-                                  juce::String("sampleName: '") + lastSampleName.replace("'", "\\'") + juce::String("'") +
-                                  "}); }";
-
-            webView->evaluateJavascript(script);
-
-            // Initialize monophonic toggle
-            juce::String monoScript = juce::String("if (window.updateMonophonicState) { window.updateMonophonicState(") +
-                                      (lastMonophonic ? "true" : "false") + juce::String("); }");
-            webView->evaluateJavascript(monoScript);
-
-            // Update the samples list
-            updateSamplesList();
+    const auto &recorder = samplerProcessor.getRecorder();
+    lastRecording = recorder.isRecording();
+
+    juce::String script;
+    script << "if (window.updateRecordState) { window.updateRecordState({"
+           << "recording: " << (lastRecording ? "true" : "false")
+           << ", source: '" << (recorder.getSource() == SampleRecorder::Source::sidechain ? "sidechain" : "output") << "'"
+           << ", seconds: " << recorder.getRecordedSeconds()
+           << ", dropped: " << recorder.getDroppedFrames()
+           << "}); }";
+    webView->evaluateJavascript(script);
+}
 
-            // Initialize waveform display with current sample data
-            updateWaveformDisplay();
-        }
+void LayoutView::timerCallback()
+{
+    PROXY_TRACE_SCOPE("UI timer");
 
+    // Nothing to update until the page has reported that it is ready
+    if (!pageLoaded)
         return;
-    }
 
     // Check for parameter changes in sampler processor
     float attackMs = samplerProcessor.getAttack();
@@ -468,34 +485,19 @@ void LayoutView::timerCallback()
         lastSampleName = sampleName;
     }
 
-    // Check for voice position changes
-    const auto &currentVoicePositions = samplerProcessor.getAllVoicePositions();
-    bool positionsChanged = false;
+    // Recording length while it runs, and the toggle once a recording stops
+    if (samplerProcessor.isRecording() || lastRecording)
+        updateRecordState();
 
-    for (int i = 0; i < SamplerProcessor::MAX_VOICES; ++i)
+    // Samples added in the background (the folder scan, a restored project's sample)
+    if (samplerProcessor.getSampleLibrary().getRevision() != lastLibraryRevision)
     {
-        if (currentVoicePositions[i].isActive != lastVoicePositions[i].isActive ||
-            (currentVoicePositions[i].isActive &&
-             currentVoicePositions[i].position != lastVoicePositions[i].position))
-        {
-            positionsChanged = true;
-            break;
-        }
+        updateSamplesList();
+        updateWaveformDisplay();
     }
 
-    // Update voice activity state
-    bool currentlyActive = samplerProcessor.isAnyVoiceActive();
-    if (voicesActive != currentlyActive || positionsChanged)
-    {
-        voicesActive = currentlyActive;
-
-        // Update all playback positions
-        updateAllPlaybackPositions();
-
-        // Update last positions
-        for (int i = 0; i < SamplerProcessor::MAX_VOICES; ++i)
-        {
-            lastVoicePositions[i] = currentVoicePositions[i];
-        }
-    }
+    // Forward everything the audio thread published since the last tick as one update
+    TelemetryFrame frame;
+    if (telemetry.drain(frame))
+        pushTelemetry(frame);
 }
\ No newline at end of file
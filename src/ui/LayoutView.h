@@ -2,31 +2,38 @@
 
 #include <JuceHeader.h>
 #include "SamplerProcessor.h"
+#include "TelemetryChannel.h"
+#include "PageResources.h"
+#include "CommandChannel.h"
+#include "EditorSettings.h"
 
 class LayoutView : public juce::Component, private juce::Timer
 {
 public:
-    LayoutView(SamplerProcessor &samplerProcessor);
+    LayoutView(SamplerProcessor &samplerProcessor, TelemetryChannel &telemetry, EditorSettings &editorSettings);
     ~LayoutView() override;
 
     void paint(juce::Graphics &g) override;
     void resized() override;
 
-    // Update UI with current levels
-    void updateLevels(float leftLevel, float rightLevel);
-
-    // Update UI with current playback position
-    void updatePlaybackPosition(int position);
-
-    // Update UI with all active voice positions
-    void updateAllPlaybackPositions();
-
     // Update waveform display with actual sample data
     void updateWaveformDisplay();
 
     // Update samples list
     void updateSamplesList();
 
+    // Send the current sample's loop regions and crossfade to the page
+    void updateLoopDisplay();
+
+    // Apply a batch of control changes from the page and refresh what they affect
+    void handleCommands(const juce::var &batch);
+
+    // Time from construction until the page reported ready, in milliseconds (0 until then)
+    double getLastOpenTimeMs() const { return lastOpenTimeMs; }
+
+    // Called when this instance's editor choice (or the default) changed
+    std::function<void()> onEditorModeChanged;
+
     // Custom web view that handles our custom URL scheme
     class LayoutMessageHandler : public juce::WebBrowserComponent
     {
@@ -40,17 +47,26 @@ public:
 
 private:
     SamplerProcessor &samplerProcessor;
+    TelemetryChannel &telemetry;
+    CommandChannel commands;
+    std::unique_ptr<juce::FileChooser> fileChooser;
+
+    // Page and stylesheet, built once and shared by every editor in the process
+    juce::SharedResourcePointer<PageResources> pageResources;
 
     std::unique_ptr<juce::WebBrowserComponent> webView;
 
     // UI state
     bool pageLoaded;
-    float lastLeftLevel, lastRightLevel;
-    int lastPlaybackPosition;
-    bool voicesActive;
 
-    // Store the last voice positions to check for changes
-    std::array<VoicePosition, SamplerProcessor::MAX_VOICES> lastVoicePositions;
+    // Editor open time measurement
+    double openStartTimeMs;
+    size_t openStartMemory;
+    double lastOpenTimeMs = 0.0;
+    bool openTimeReported = false;
+
+    // Last telemetry update sent to the page, so unchanged frames are skipped
+    juce::String lastTelemetryScript;
 
     // Sampler parameters
     float lastAttackMs;
@@ -58,6 +74,17 @@ private:
     float lastGain;
     bool lastMonophonic;
     juce::String lastSampleName;
+    int lastLibraryRevision = -1; // samples list last sent, so background loads show up
+    bool lastRecording = false;
+
+    // Push the full UI state as soon as the page reports it is ready
+    void handlePageReady();
+
+    // Send the recording toggle, source and length to the page
+    void updateRecordState();
+
+    // Send one batched meter and playhead update to the page
+    void pushTelemetry(const TelemetryFrame &frame);
 
     // Timer for UI updates
     void timerCallback() override;
@@ -0,0 +1,613 @@
+#include "NativeView.h"
+#include "ProcessMemory.h"
+#include "Trace.h"
+
+// The page's palette (theme.scss)
+static const juce::Colour backgroundColour(0xff17212b);
+static const juce::Colour backgroundDarkerColour(0xff0d161e);
+static const juce::Colour surfaceColour(0xff1e2a35);
+static const juce::Colour surfaceHighlightColour(0xff2c3e50);
+static const juce::Colour primaryColour(0xff00bcd4);
+static const juce::Colour textPrimaryColour(0xffffffff);
+static const juce::Colour textSecondaryColour(0xffb0bec5);
+
+static constexpr int SIDEBAR_WIDTH = 200;
+static constexpr int ROW_HEIGHT = 22;
+static constexpr int PANEL_WIDTH = 170;
+static constexpr int CONTROLS_HEIGHT = 96;
+static constexpr int METERS_WIDTH = 150;
+
+NativeView::NativeView(SamplerProcessor &proc, TelemetryChannel &telemetryChannel, EditorSettings &editorSettings)
+    : openStartTimeMs(juce::Time::getMillisecondCounterHiRes()),
+      openStartMemory(ProcessMemory::getResidentBytes()),
+      lookAndFeel(juce::LookAndFeel_V4::ColourScheme(backgroundColour, surfaceColour, backgroundDarkerColour,
+                                                     surfaceHighlightColour, textSecondaryColour, primaryColour,
+                                                     textPrimaryColour, primaryColour, textSecondaryColour)),
+      samplerProcessor(proc),
+      telemetry(telemetryChannel),
+      commands(proc, editorSettings),
+      sampleList("Samples", this)
+{
+    PROXY_TRACE_SCOPE("native editor open");
+
+    setLookAndFeel(&lookAndFeel);
+    setOpaque(true);
+
+    // Envelope knobs
+    attackKnob = &addControl(nullptr, "attack", "Attack", 0.0, 500.0, 0.1);
+    releaseKnob = &addControl(nullptr, "release", "Release", 0.0, 1000.0, 0.1);
+
+    for (auto *knob : {attackKnob, releaseKnob})
+    {
+        knob->slider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
+        knob->slider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 70, 18);
+        knob->slider.setTextValueSuffix(" ms");
+        knob->label.setJustificationType(juce::Justification::centred);
+        addAndMakeVisible(knob->slider);
+        addAndMakeVisible(knob->label);
+    }
+
+    // Toggles
+    monophonicToggle.onClick = [this]
+    { apply("monophonic", monophonicToggle.getToggleState()); };
+    storageToggle.onClick = [this]
+    { apply("compressedStorage", storageToggle.getToggleState()); };
+    granularToggle.onClick = [this]
+    { apply("playbackMode", granularToggle.getToggleState() ? "granular" : "sample"); };
+    analysisToggle.onClick = [this]
+    { apply("autoAnalysis", analysisToggle.getToggleState()); };
+    analysisToggle.setTooltip("Tune to the sample's detected root, match loudness and skip silence at either end");
+
+    for (auto *toggle : {&monophonicToggle, &storageToggle, &granularToggle, &analysisToggle})
+        addAndMakeVisible(*toggle);
+
+    // Resampling
+    recordSource.addItem("Output", 1);
+    recordSource.addItem("Sidechain", 2);
+    recordSource.setSelectedId(1, juce::dontSendNotification);
+    recordToggle.onClick = [this]
+    { apply("record", recordToggle.getToggleState() ? (recordSource.getSelectedId() == 2 ? "sidechain" : "output") : "off"); };
+    recordTime.setColour(juce::Label::textColourId, textSecondaryColour);
+
+    for (auto *component : std::initializer_list<juce::Component *>{&recordSource, &recordToggle, &recordTime})
+        addAndMakeVisible(*component);
+
+    // Pitched note cache budget
+    noteCacheChoice = &addChoice(nullptr, "noteCache", "Cache", "0:No note cache,64:Cache 64 MB,256:Cache 256 MB,1024:Cache 1 GB");
+    noteCacheChoice->comboBox.setTooltip("Memory for notes pre-rendered at their pitch, which play at a fraction of the CPU");
+    addAndMakeVisible(noteCacheChoice->comboBox);
+
+    // Parameter panels, in the page's order
+    for (auto *title : {"Granular", "Filter", "Modulation", "Reverb", "Editor"})
+    {
+        auto *panel = panels.add(new Panel());
+        panel->title.setText(title, juce::dontSendNotification);
+        panel->title.setColour(juce::Label::textColourId, primaryColour);
+        panelContent.addAndMakeVisible(panel->title);
+    }
+
+    auto *granular = panels[0];
+    addControl(granular, "grainPosition", "Pos", 0.0, 1.0, 0.001);
+    addControl(granular, "grainSpeed", "Speed", 0.0, 2.0, 0.01);
+    addControl(granular, "grainSpray", "Spray", 0.0, 1.0, 0.001);
+    addControl(granular, "grainDensity", "Dens", 1.0, 2000.0, 1.0);
+    addControl(granular, "grainSize", "Size", 5.0, 1000.0, 1.0);
+    addControl(granular, "grainPitch", "Pitch", -24.0, 24.0, 0.1);
+
+    auto *filter = panels[1];
+    addChoice(filter, "filterMode", "Filter", "off:Off,lowpass:Low pass,bandpass:Band pass,highpass:High pass,notch:Notch");
+    addControl(filter, "filterCutoff", "Cut", 20.0, 20000.0, 1.0);
+    addControl(filter, "filterResonance", "Res", 0.5, 12.0, 0.01);
+    addControl(filter, "filterEnvAmount", "Env", -8.0, 8.0, 0.01);
+    addControl(filter, "filterVelAmount", "Vel", -8.0, 8.0, 0.01);
+    addControl(filter, "filterAttack", "A", 0.0, 2000.0, 1.0);
+    addControl(filter, "filterDecay", "D", 0.0, 2000.0, 1.0);
+    addControl(filter, "filterSustain", "S", 0.0, 1.0, 0.01);
+    addControl(filter, "filterRelease", "R", 0.0, 2000.0, 1.0);
+
+    auto *modulation = panels[2];
+    addChoice(modulation, "modMpe", "MPE", "0:Off,1:On");
+    addControl(modulation, "modBendRange", "Bend", 0.0, 24.0, 1.0);
+    addControl(modulation, "modMpeRange", "Note", 0.0, 96.0, 1.0);
+    addControl(modulation, "modGlide", "Glide", 0.0, 2000.0, 1.0);
+    addControl(modulation, "modPressure", "Press", 0.0, 1.0, 0.01);
+    addControl(modulation, "modTimbre", "Timbre", -4.0, 4.0, 0.01);
+
+    for (int l = 1; l <= ModulationParameters::NUM_LFOS; ++l)
+    {
+        const juce::String lfo = "modLfo" + juce::String(l);
+        addChoice(modulation, lfo + "Shape", "LFO" + juce::String(l), "sine:Sine,triangle:Triangle,saw:Saw,square:Square");
+        addChoice(modulation, lfo + "Target", "Target", "pitch:Pitch,volume:Volume");
+        addControl(modulation, lfo + "Rate", "Rate", 0.05, 20.0, 0.01);
+        addControl(modulation, lfo + "Depth", "Depth", -12.0, 12.0, 0.01);
+    }
+
+    auto *reverb = panels[3];
+    reverbImpulse = &addChoice(reverb, "reverbImpulse", "Verb", ":None"); // filled with the samples list
+    addControl(reverb, "reverbMix", "Mix", 0.0, 1.0, 0.01);
+
+    auto *editor = panels[4];
+    addChoice(editor, "editorMode", "This", "default:Default,web:Web,native:Native");
+    addChoice(editor, "defaultEditor", "Default", "web:Web,native:Native");
+
+    panelViewport.setViewedComponent(&panelContent, false);
+    panelViewport.setScrollBarsShown(false, true);
+    addAndMakeVisible(panelViewport);
+
+    // Sample browser
+    refreshButton.onClick = [this]
+    { apply("refreshSamples", true); };
+    browseButton.onClick = [this]
+    { apply("browseSample", true); };
+    sampleList.setRowHeight(ROW_HEIGHT);
+    sampleList.setColour(juce::ListBox::backgroundColourId, backgroundDarkerColour);
+
+    for (auto *component : std::initializer_list<juce::Component *>{&refreshButton, &browseButton, &sampleList})
+        addAndMakeVisible(*component);
+
+    // Waveform; dragging on it sets the sustain loop like the page does
+    waveform.onSustainLoopChanged = [this](const SampleLoop &loop)
+    { apply("sustainLoop", juce::String(loop.start) + "," + juce::String(loop.end)); };
+    addAndMakeVisible(waveform);
+
+    // Everything is built from the processor's current state straight away; there is no page to wait for
+    lastSampleName = samplerProcessor.getCurrentSampleName();
+    updateSamplesList();
+    updateWaveformDisplay();
+    updateControls();
+    updateRecordState();
+
+    // Keys the focused control doesn't use come up to keyPressed()
+    setWantsKeyboardFocus(true);
+
+    startTimerHz(30);
+}
+
+NativeView::~NativeView()
+{
+    stopTimer();
+    sampleList.setModel(nullptr);
+    setLookAndFeel(nullptr);
+}
+
+NativeView::Control &NativeView::addControl(Panel *panel, const juce::String &command, const juce::String &label, double minimum, double maximum, double interval)
+{
+    auto *control = controls.add(new Control());
+    control->command = command;
+    control->label.setText(label, juce::dontSendNotification);
+    control->label.setColour(juce::Label::textColourId, textSecondaryColour);
+    control->slider.setSliderStyle(juce::Slider::LinearHorizontal);
+    control->slider.setTextBoxStyle(juce::Slider::NoTextBox, true, 0, 0);
+    control->slider.setRange(minimum, maximum, interval);
+    control->slider.setPopupDisplayEnabled(true, true, this);
+    control->slider.onValueChange = [this, control]
+    { apply(control->command, control->slider.getValue()); };
+
+    if (panel != nullptr)
+    {
+        panel->controls.add(control);
+        panelContent.addAndMakeVisible(control->label);
+        panelContent.addAndMakeVisible(control->slider);
+    }
+
+    return *control;
+}
+
+NativeView::Control &NativeView::addChoice(Panel *panel, const juce::String &command, const juce::String &label, const juce::String &choices)
+{
+    auto *control = controls.add(new Control());
+    control->command = command;
+    control->isChoice = true;
+    control->label.setText(label, juce::dontSendNotification);
+    control->label.setColour(juce::Label::textColourId, textSecondaryColour);
+
+    // "value:Text,value:Text"
+    juce::StringArray values, texts;
+
+    for (const auto &choice : juce::StringArray::fromTokens(choices, ",", {}))
+    {
+        values.add(choice.upToFirstOccurrenceOf(":", false, false));
+        texts.add(choice.fromFirstOccurrenceOf(":", false, false));
+    }
+
+    setChoices(*control, values, texts);
+    control->comboBox.onChange = [this, control]
+    {
+        const int index = control->comboBox.getSelectedItemIndex();
+
+        if (juce::isPositiveAndBelow(index, control->values.size()))
+            apply(control->command, control->values[index]);
+    };
+
+    if (panel != nullptr)
+    {
+        panel->controls.add(control);
+        panelContent.addAndMakeVisible(control->label);
+        panelContent.addAndMakeVisible(control->comboBox);
+    }
+
+    return *control;
+}
+
+void NativeView::setChoices(Control &control, const juce::StringArray &values, const juce::StringArray &texts)
+{
+    control.values = values;
+    control.comboBox.clear(juce::dontSendNotification);
+
+    for (int i = 0; i < texts.size(); ++i)
+        control.comboBox.addItem(texts[i], i + 1);
+}
+
+void NativeView::apply(const juce::String &command, const juce::var &value)
+{
+    const int refresh = commands.apply(command, value);
+
+    if (refresh & CommandChannel::loops)
+        updateLoopDisplay();
+
+    if (refresh & CommandChannel::samplesList)
+        updateSamplesList();
+
+    if (refresh & CommandChannel::waveform)
+        updateWaveformDisplay();
+
+    if (refresh & CommandChannel::recording)
+        updateRecordState();
+
+    if (refresh & CommandChannel::browse)
+        openFileBrowser();
+
+    if ((refresh & CommandChannel::editor) && onEditorModeChanged)
+        onEditorModeChanged();
+}
+
+void NativeView::openFileBrowser()
+{
+    fileChooser = std::make_unique<juce::FileChooser>("Select a Sample File...",
+                                                      juce::File::getSpecialLocation(juce::File::userMusicDirectory),
+                                                      "*.wav;*.aif;*.aiff;*.mp3");
+
+    fileChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                             [this](const juce::FileChooser &fc)
+                             {
+                                 auto result = fc.getResult();
+                                 if (result.exists())
+                                 {
+                                     samplerProcessor.loadSample(result);
+                                     updateWaveformDisplay();
+                                 }
+                             });
+}
+
+void NativeView::updateControls()
+{
+    for (auto *control : controls)
+    {
+        const juce::var value = commands.get(control->command);
+
+        if (control->isChoice)
+        {
+            const int index = control->values.indexOf(value.toString());
+
+            if (index >= 0 && index != control->comboBox.getSelectedItemIndex())
+                control->comboBox.setSelectedItemIndex(index, juce::dontSendNotification);
+        }
+        else if (!control->slider.isMouseButtonDown())
+        {
+            control->slider.setValue(static_cast<double>(value), juce::dontSendNotification);
+        }
+    }
+
+    monophonicToggle.setToggleState(samplerProcessor.isMonophonic(), juce::dontSendNotification);
+    storageToggle.setToggleState(samplerProcessor.isCompressedStorage(), juce::dontSendNotification);
+    granularToggle.setToggleState(samplerProcessor.getPlaybackMode() == PlaybackMode::granular, juce::dontSendNotification);
+    analysisToggle.setToggleState(samplerProcessor.isAnalysisApplied(), juce::dontSendNotification);
+}
+
+void NativeView::updateSamplesList()
+{
+    PROXY_TRACE_SCOPE("native sample list");
+
+    const auto &library = samplerProcessor.getSampleLibrary();
+    lastLibraryRevision = library.getRevision();
+
+    browserRows.clear();
+    juce::StringArray allSamples;
+
+    for (const auto &category : library.getCategories())
+    {
+        const auto samples = library.getSamplesInCategory(category);
+
+        if (samples.isEmpty())
+            continue;
+
+        browserRows.push_back({category, true});
+
+        for (const auto &sample : samples)
+            browserRows.push_back({sample, false});
+
+        allSamples.addArray(samples);
+    }
+
+    sampleList.updateContent();
+    sampleList.repaint();
+
+    // Any sample can be the reverb's impulse response
+    juce::StringArray values{""}, texts{"None"};
+    values.addArray(allSamples);
+    texts.addArray(allSamples);
+    setChoices(*reverbImpulse, values, texts);
+    reverbImpulse->comboBox.setSelectedItemIndex(juce::jmax(0, values.indexOf(samplerProcessor.getReverbImpulse())), juce::dontSendNotification);
+}
+
+void NativeView::updateWaveformDisplay()
+{
+    lastSampleName = samplerProcessor.getCurrentSampleName();
+    waveform.setSample(samplerProcessor.getSampleLibrary().getSampleAudioBuffer(lastSampleName));
+
+    // Keep the current sample selected in the browser
+    for (size_t row = 0; row < browserRows.size(); ++row)
+    {
+        if (!browserRows[row].isCategory && browserRows[row].text == lastSampleName)
+        {
+            sampleList.selectRow(static_cast<int>(row));
+            break;
+        }
+    }
+
+    // Loop points belong to the sample, so they change along with the waveform
+    updateLoopDisplay();
+}
+
+void NativeView::updateLoopDisplay()
+{
+    waveform.setLoops(samplerProcessor.getSustainLoop(), samplerProcessor.getReleaseLoop());
+}
+
+void NativeView::updateRecordState()
+{
+    const auto &recorder = samplerProcessor.getRecorder();
+    lastRecording = recorder.isRecording();
+
+    recordToggle.setToggleState(lastRecording, juce::dontSendNotification);
+
+    if (lastRecording)
+        recordSource.setSelectedId(recorder.getSource() == SampleRecorder::Source::sidechain ? 2 : 1, juce::dontSendNotification);
+
+    const int dropped = recorder.getDroppedFrames();
+    recordTime.setText(juce::String(recorder.getRecordedSeconds(), 1) + " s" + (dropped > 0 ? " !" : ""), juce::dontSendNotification);
+    recordTime.setTooltip(dropped > 0 ? juce::String(dropped) + " frames dropped" : juce::String());
+}
+
+void NativeView::paint(juce::Graphics &g)
+{
+    g.fillAll(backgroundColour);
+
+    // Sidebar and waveform backgrounds
+    g.setColour(backgroundDarkerColour);
+    g.fillRect(getLocalBounds().removeFromLeft(SIDEBAR_WIDTH));
+    g.fillRect(waveform.getBounds());
+
+    // Output meters: RMS bars with a peak-hold line, scaled -60..0 dB like the page
+    if (meterArea.isEmpty())
+        return;
+
+    auto area = meterArea.reduced(4);
+    auto readout = area.removeFromBottom(16);
+    auto toProportion = [](float level)
+    {
+        return juce::jmap(juce::Decibels::gainToDecibels(level, -60.0f), -60.0f, 0.0f, 0.0f, 1.0f);
+    };
+
+    g.setColour(textSecondaryColour);
+    g.setFont(11.0f);
+    g.drawText("Out", area.removeFromLeft(28), juce::Justification::centredLeft);
+
+    const juce::ColourGradient gradient(juce::Colour(0xfff44336), 0.0f, static_cast<float>(area.getY()),
+                                        juce::Colour(0xff4caf50), 0.0f, static_cast<float>(area.getBottom()), false);
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        auto bar = area.removeFromLeft(10).toFloat();
+        area.removeFromLeft(4);
+
+        g.setColour(backgroundDarkerColour);
+        g.fillRect(bar);
+
+        g.setGradientFill(gradient);
+        g.fillRect(bar.withTop(bar.getBottom() - bar.getHeight() * toProportion(meters.rms[static_cast<size_t>(channel)])));
+
+        g.setColour(textPrimaryColour);
+        g.fillRect(bar.withY(bar.getBottom() - bar.getHeight() * toProportion(meters.peakHold[static_cast<size_t>(channel)])).withHeight(2.0f));
+    }
+
+    auto format = [](float value)
+    { return value <= -100.0f ? juce::String("-inf") : juce::String(value, 1); };
+
+    const float truePeakDb = juce::Decibels::gainToDecibels(juce::jmax(meters.truePeak[0], meters.truePeak[1]), -100.0f);
+
+    g.setColour(textSecondaryColour);
+    g.setFont(10.0f);
+    g.drawText("S " + format(meters.shortTermLufs) + "  I " + format(meters.integratedLufs) + "  TP " + format(truePeakDb),
+               readout, juce::Justification::centredLeft);
+}
+
+void NativeView::paintOverChildren(juce::Graphics &)
+{
+    // Children are painted by now, so this is the first complete frame
+    if (openTimeReported)
+        return;
+
+    openTimeReported = true;
+    lastOpenTimeMs = juce::Time::getMillisecondCounterHiRes() - openStartTimeMs;
+    juce::Logger::writeToLog("Proxy native editor ready in " + juce::String(lastOpenTimeMs, 1) + " ms, process memory "
+                             + ProcessMemory::describeGrowth(openStartMemory, ProcessMemory::getResidentBytes()));
+}
+
+bool NativeView::keyPressed(const juce::KeyPress &key)
+{
+    const auto modifiers = key.getModifiers();
+
+    if (modifiers.isCtrlDown() && modifiers.isShiftDown() && juce::CharacterFunctions::toUpperCase(static_cast<juce::juce_wchar>(key.getKeyCode())) == 'T')
+    {
+        apply("exportTrace", true);
+        return true;
+    }
+
+    return false;
+}
+
+void NativeView::resized()
+{
+    auto bounds = getLocalBounds();
+
+    // Sidebar: buttons over the sample list
+    auto sidebar = bounds.removeFromLeft(SIDEBAR_WIDTH).reduced(6);
+    auto buttons = sidebar.removeFromTop(26);
+    refreshButton.setBounds(buttons.removeFromLeft(buttons.getWidth() / 2).reduced(2, 0));
+    browseButton.setBounds(buttons.reduced(2, 0));
+    sidebar.removeFromTop(6);
+    sampleList.setBounds(sidebar);
+
+    auto main = bounds.reduced(8);
+    waveform.setBounds(main.removeFromTop(juce::jmax(100, main.getHeight() * 3 / 10)));
+    main.removeFromTop(8);
+
+    // Knobs, toggles, recording and meters in one strip
+    auto strip = main.removeFromTop(CONTROLS_HEIGHT);
+    meterArea = strip.removeFromRight(METERS_WIDTH);
+
+    for (auto *knob : {attackKnob, releaseKnob})
+    {
+        auto column = strip.removeFromLeft(80);
+        knob->label.setBounds(column.removeFromBottom(18));
+        knob->slider.setBounds(column);
+    }
+
+    auto toggles = strip.removeFromLeft(80);
+
+    for (auto *toggle : {&monophonicToggle, &storageToggle, &granularToggle, &analysisToggle})
+        toggle->setBounds(toggles.removeFromTop(ROW_HEIGHT + 2));
+
+    auto record = strip.removeFromLeft(120).reduced(4, 8);
+    recordSource.setBounds(record.removeFromTop(ROW_HEIGHT));
+    record.removeFromTop(4);
+    auto recordRow = record.removeFromTop(ROW_HEIGHT);
+    recordToggle.setBounds(recordRow.removeFromLeft(56));
+    recordTime.setBounds(recordRow);
+    record.removeFromTop(4);
+    noteCacheChoice->comboBox.setBounds(record.removeFromTop(ROW_HEIGHT));
+
+    main.removeFromTop(8);
+    panelViewport.setBounds(main);
+    layoutPanels();
+}
+
+void NativeView::layoutPanels()
+{
+    int maxRows = 0;
+
+    for (auto *panel : panels)
+        maxRows = juce::jmax(maxRows, panel->controls.size());
+
+    const int height = juce::jmax(panelViewport.getMaximumVisibleHeight(), (maxRows + 1) * ROW_HEIGHT);
+    panelContent.setSize(panels.size() * PANEL_WIDTH, height);
+
+    int x = 0;
+
+    for (auto *panel : panels)
+    {
+        auto column = juce::Rectangle<int>(x, 0, PANEL_WIDTH, height).reduced(4, 0);
+        panel->title.setBounds(column.removeFromTop(ROW_HEIGHT));
+
+        for (auto *control : panel->controls)
+        {
+            auto row = column.removeFromTop(ROW_HEIGHT);
+            control->label.setBounds(row.removeFromLeft(52));
+
+            if (control->isChoice)
+                control->comboBox.setBounds(row.reduced(0, 1));
+            else
+                control->slider.setBounds(row);
+        }
+
+        x += PANEL_WIDTH;
+    }
+}
+
+void NativeView::timerCallback()
+{
+    PROXY_TRACE_SCOPE("native UI timer");
+
+    // Values changed by the host, a restored state or another editor
+    updateControls();
+
+    if (samplerProcessor.getSampleLibrary().getRevision() != lastLibraryRevision)
+    {
+        updateSamplesList();
+        updateWaveformDisplay();
+    }
+    else if (samplerProcessor.getCurrentSampleName() != lastSampleName)
+    {
+        updateWaveformDisplay();
+    }
+
+    // Recording length while it runs, and the toggle once a recording stops
+    if (samplerProcessor.isRecording() || lastRecording)
+        updateRecordState();
+
+    TelemetryFrame frame;
+
+    if (telemetry.drain(frame))
+    {
+        waveform.setPlayheads(frame);
+
+        // Only the meter strip is repainted, and only when a value it shows changed
+        const auto &next = frame.meters;
+        const bool metersChanged = next.rms != meters.rms || next.peakHold != meters.peakHold || next.truePeak != meters.truePeak
+                                   || next.shortTermLufs != meters.shortTermLufs || next.integratedLufs != meters.integratedLufs;
+        meters = next;
+
+        if (metersChanged)
+            repaint(meterArea);
+    }
+}
+
+int NativeView::getNumRows()
+{
+    return static_cast<int>(browserRows.size());
+}
+
+void NativeView::paintListBoxItem(int rowNumber, juce::Graphics &g, int width, int height, bool rowIsSelected)
+{
+    if (!juce::isPositiveAndBelow(rowNumber, static_cast<int>(browserRows.size())))
+        return;
+
+    const auto &row = browserRows[static_cast<size_t>(rowNumber)];
+
+    if (row.isCategory)
+    {
+        g.setColour(primaryColour);
+        g.setFont(juce::Font(juce::FontOptions(12.0f, juce::Font::bold)));
+        g.drawText(row.text, 4, 0, width - 8, height, juce::Justification::centredLeft, true);
+        return;
+    }
+
+    if (rowIsSelected)
+    {
+        g.setColour(primaryColour.withAlpha(0.2f));
+        g.fillRect(0, 0, width, height);
+    }
+
+    g.setColour(rowIsSelected ? primaryColour : textSecondaryColour);
+    g.setFont(12.0f);
+    g.drawText(row.text, 16, 0, width - 20, height, juce::Justification::centredLeft, true);
+}
+
+void NativeView::listBoxItemClicked(int row, const juce::MouseEvent &)
+{
+    if (!juce::isPositiveAndBelow(row, static_cast<int>(browserRows.size())) || browserRows[static_cast<size_t>(row)].isCategory)
+        return;
+
+    apply("sample", browserRows[static_cast<size_t>(row)].text);
+}
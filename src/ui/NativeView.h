@@ -0,0 +1,131 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SamplerProcessor.h"
+#include "TelemetryChannel.h"
+#include "CommandChannel.h"
+#include "EditorSettings.h"
+#include "NativeWaveform.h"
+
+// The lightweight editor: the page's controls, sample browser, meters and waveform built from
+// JUCE components, with no embedded browser. Controls send the page's commands through a
+// CommandChannel, so both editors drive the processor the same way.
+class NativeView : public juce::Component, private juce::Timer, private juce::ListBoxModel
+{
+public:
+    NativeView(SamplerProcessor &samplerProcessor, TelemetryChannel &telemetry, EditorSettings &editorSettings);
+    ~NativeView() override;
+
+    void paint(juce::Graphics &g) override;
+    void paintOverChildren(juce::Graphics &g) override;
+    void resized() override;
+
+    // Ctrl+Shift+T saves the trace, as in the web editor (tracing builds only)
+    bool keyPressed(const juce::KeyPress &key) override;
+
+    // Time from construction until the first complete frame was painted, in milliseconds (0 until then)
+    double getLastOpenTimeMs() const { return lastOpenTimeMs; }
+
+    // Called when this instance's editor choice (or the default) changed
+    std::function<void()> onEditorModeChanged;
+
+private:
+    // Declared first so it is measured before anything else is built, and outlives every child
+    const double openStartTimeMs;
+    const size_t openStartMemory;
+    juce::LookAndFeel_V4 lookAndFeel;
+
+    SamplerProcessor &samplerProcessor;
+    TelemetryChannel &telemetry;
+    CommandChannel commands;
+    std::unique_ptr<juce::FileChooser> fileChooser;
+
+    double lastOpenTimeMs = 0.0;
+    bool openTimeReported = false;
+
+    // A labelled slider or drop-down bound to one command
+    struct Control
+    {
+        juce::String command;
+        juce::Label label;
+        juce::Slider slider;
+        juce::ComboBox comboBox;
+        juce::StringArray values; // command value of each drop-down item
+        bool isChoice = false;
+    };
+
+    struct Panel
+    {
+        juce::Label title;
+        juce::Array<Control *> controls;
+    };
+
+    juce::OwnedArray<Control> controls;
+    juce::OwnedArray<Panel> panels;
+    Control *attackKnob = nullptr;
+    Control *releaseKnob = nullptr;
+    Control *reverbImpulse = nullptr;
+    Control *noteCacheChoice = nullptr;
+
+    juce::ToggleButton monophonicToggle{"Mono"};
+    juce::ToggleButton storageToggle{"Pack"};
+    juce::ToggleButton granularToggle{"Grain"};
+    juce::ToggleButton analysisToggle{"Auto"};
+
+    juce::ComboBox recordSource;
+    juce::ToggleButton recordToggle{"Rec"};
+    juce::Label recordTime;
+    juce::TooltipWindow tooltipWindow{this};
+
+    // Panels scroll sideways when the editor is narrower than all of them
+    juce::Component panelContent;
+    juce::Viewport panelViewport;
+
+    // Sample browser: category headings with their samples underneath
+    struct BrowserRow
+    {
+        juce::String text;
+        bool isCategory = false;
+    };
+
+    juce::TextButton refreshButton{"Refresh"};
+    juce::TextButton browseButton{"Browse..."};
+    juce::ListBox sampleList;
+    std::vector<BrowserRow> browserRows;
+
+    NativeWaveform waveform;
+
+    // Latest meter values and where they are drawn
+    MeterSnapshot meters;
+    juce::Rectangle<int> meterArea;
+
+    juce::String lastSampleName;
+    int lastLibraryRevision = -1;
+    bool lastRecording = false;
+
+    Control &addControl(Panel *panel, const juce::String &command, const juce::String &label, double minimum, double maximum, double interval);
+    Control &addChoice(Panel *panel, const juce::String &command, const juce::String &label, const juce::String &choices);
+    void setChoices(Control &control, const juce::StringArray &values, const juce::StringArray &texts);
+
+    // Apply one command and refresh whatever it changed
+    void apply(const juce::String &command, const juce::var &value);
+
+    // Show the processor's current values; controls being dragged are left alone
+    void updateControls();
+    void updateSamplesList();
+    void updateWaveformDisplay();
+    void updateLoopDisplay();
+    void updateRecordState();
+    void openFileBrowser();
+
+    void layoutPanels();
+
+    // ListBoxModel
+    int getNumRows() override;
+    void paintListBoxItem(int rowNumber, juce::Graphics &g, int width, int height, bool rowIsSelected) override;
+    void listBoxItemClicked(int row, const juce::MouseEvent &event) override;
+
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NativeView)
+};
@@ -0,0 +1,222 @@
+#include "NativeWaveform.h"
+#include "BinaryPayload.h"
+#include "Trace.h"
+
+// The page's colours (theme.scss)
+static const juce::Colour primaryColour(0xff00bcd4);
+static const juce::Colour primaryHoverColour(0xff4dd0e1);
+static const juce::Colour releaseLoopColour(0xffff9800);
+
+NativeWaveform::NativeWaveform()
+{
+    voicePositions.fill(-1);
+    voiceLevels.fill(0.0f);
+    setOpaque(false);
+}
+
+void NativeWaveform::setSample(const SampleData &sample)
+{
+    PROXY_TRACE_SCOPE("native waveform");
+
+    numFrames = sample.getNumFrames();
+    numChannels = 0;
+    numPoints = 0;
+    points.reset();
+
+    if (numFrames > 0)
+    {
+        numChannels = juce::jmin(sample.getNumChannels(), 2);
+        points = sample.buffer != nullptr ? BinaryPayload::encodeWaveform(*sample.buffer, numChannels, numPoints)
+                                          : BinaryPayload::encodeWaveform(*sample.compressed, numChannels, numPoints);
+    }
+
+    renderCache();
+    repaint();
+}
+
+void NativeWaveform::setLoops(const SampleLoop &newSustainLoop, const SampleLoop &newReleaseLoop)
+{
+    // Keep the loop being dragged until the drag ends
+    if (dragStart < 0)
+        sustainLoop = newSustainLoop;
+
+    releaseLoop = newReleaseLoop;
+    repaint();
+}
+
+void NativeWaveform::setPlayheads(const TelemetryFrame &frame)
+{
+    if (frame.voicePositions == voicePositions && frame.voiceLevels == voiceLevels)
+        return;
+
+    voicePositions = frame.voicePositions;
+    voiceLevels = frame.voiceLevels;
+    repaint();
+}
+
+void NativeWaveform::resized()
+{
+    renderCache();
+}
+
+void NativeWaveform::renderCache()
+{
+    const int width = getWidth();
+    const int height = getHeight();
+
+    if (width <= 0 || height <= 0)
+    {
+        cache = {};
+        return;
+    }
+
+    // Drawn at the display's scale so the cached lines stay sharp
+    const float scale = juce::Component::getApproximateScaleFactorForComponent(this);
+    cache = juce::Image(juce::Image::ARGB, juce::roundToInt(width * scale), juce::roundToInt(height * scale), true);
+
+    juce::Graphics g(cache);
+    g.addTransform(juce::AffineTransform::scale(scale));
+
+    const float centreY = height * 0.5f;
+    const float amplitudeScale = height / 3.0f;
+
+    if (numPoints == 0)
+    {
+        // Placeholder until there is a sample
+        juce::Path wave;
+
+        for (int x = 0; x < width; ++x)
+        {
+            const float y = centreY + std::sin(x / 20.0f) * height * 0.25f;
+
+            if (x == 0)
+                wave.startNewSubPath(0.0f, y);
+            else
+                wave.lineTo(static_cast<float>(x), y);
+        }
+
+        g.setColour(primaryColour.withAlpha(0.4f));
+        g.strokePath(wave, juce::PathStrokeType(2.0f));
+        return;
+    }
+
+    const auto *data = static_cast<const float *>(points.getData());
+    const float xStep = static_cast<float>(width) / numPoints;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const float *channelPoints = data + channel * numPoints;
+        juce::Path wave;
+        wave.preallocateSpace(numPoints * 3);
+        wave.startNewSubPath(0.0f, centreY - channelPoints[0] * amplitudeScale);
+
+        for (int i = 1; i < numPoints; ++i)
+            wave.lineTo(i * xStep, centreY - channelPoints[i] * amplitudeScale);
+
+        g.setColour(channel == 0 ? primaryColour : primaryHoverColour);
+        g.strokePath(wave, juce::PathStrokeType(2.0f));
+    }
+}
+
+float NativeWaveform::frameToX(juce::int64 frame) const
+{
+    return numFrames > 0 ? static_cast<float>(static_cast<double>(frame) / static_cast<double>(numFrames) * getWidth()) : 0.0f;
+}
+
+juce::int64 NativeWaveform::xToFrame(float x) const
+{
+    const double ratio = juce::jlimit(0.0, 1.0, static_cast<double>(x) / juce::jmax(1, getWidth()));
+    return static_cast<juce::int64>(std::llround(ratio * static_cast<double>(numFrames)));
+}
+
+void NativeWaveform::paint(juce::Graphics &g)
+{
+    const auto bounds = getLocalBounds().toFloat();
+
+    // Loop regions sit underneath the waveform
+    auto fillLoop = [&](const SampleLoop &loop, juce::Colour colour)
+    {
+        if (numFrames <= 0 || loop.end <= loop.start)
+            return;
+
+        const float startX = frameToX(loop.start);
+        g.setColour(colour);
+        g.fillRect(juce::Rectangle<float>(startX, 0.0f, frameToX(loop.end) - startX, bounds.getHeight()));
+    };
+
+    fillLoop(releaseLoop, releaseLoopColour.withAlpha(0.15f));
+    fillLoop(sustainLoop, primaryColour.withAlpha(0.18f));
+
+    if (cache.isValid())
+        g.drawImage(cache, bounds);
+
+    // One playhead per sounding voice; later voices are lighter, quieter ones fade
+    for (int i = 0; i < SamplerProcessor::MAX_VOICES; ++i)
+    {
+        const juce::int64 position = voicePositions[static_cast<size_t>(i)];
+
+        if (position < 0 || numFrames <= 0)
+            continue;
+
+        // Same -60..0 dB scale as the page's level readout
+        const float db = juce::Decibels::gainToDecibels(voiceLevels[static_cast<size_t>(i)], -60.0f);
+        const float level = juce::jmap(db, -60.0f, 0.0f, 0.0f, 1.0f);
+        const float opacity = (1.0f - i * 0.1f) * (0.3f + 0.7f * level);
+        const int lighter = i * 12;
+
+        g.setColour(juce::Colour::fromRGB(static_cast<juce::uint8>(juce::jmin(255, lighter)),
+                                          static_cast<juce::uint8>(juce::jmin(255, 188 + lighter)),
+                                          212)
+                        .withAlpha(juce::jlimit(0.0f, 1.0f, opacity)));
+        g.fillRect(juce::Rectangle<float>(frameToX(juce::jmin(position, numFrames)) - 1.0f, 0.0f, 2.0f, bounds.getHeight()));
+    }
+}
+
+void NativeWaveform::mouseDown(const juce::MouseEvent &event)
+{
+    if (numFrames <= 0)
+        return;
+
+    dragStart = xToFrame(event.position.x);
+    loopBeforeDrag = sustainLoop;
+    sustainLoop = SampleLoop(dragStart, dragStart);
+    repaint();
+}
+
+void NativeWaveform::mouseDrag(const juce::MouseEvent &event)
+{
+    if (dragStart < 0)
+        return;
+
+    const juce::int64 frame = xToFrame(event.position.x);
+    sustainLoop = SampleLoop(juce::jmin(frame, dragStart), juce::jmax(frame, dragStart));
+    repaint();
+}
+
+void NativeWaveform::mouseUp(const juce::MouseEvent &)
+{
+    if (dragStart < 0)
+        return;
+
+    dragStart = -1;
+
+    // A click without a drag leaves the loop as it was
+    if (sustainLoop.end <= sustainLoop.start)
+    {
+        sustainLoop = loopBeforeDrag;
+        repaint();
+        return;
+    }
+
+    if (onSustainLoopChanged)
+        onSustainLoopChanged(sustainLoop);
+}
+
+void NativeWaveform::mouseDoubleClick(const juce::MouseEvent &)
+{
+    sustainLoop = {};
+    repaint();
+
+    if (onSustainLoopChanged)
+        onSustainLoopChanged(sustainLoop);
+}
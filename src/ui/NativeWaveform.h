@@ -0,0 +1,56 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleLibrary.h"
+#include "TelemetryChannel.h"
+
+// Waveform for the native editor. The waveform is drawn into a cached image only when the sample
+// or the size changes; loop regions and voice playheads are painted over that image, so a frame
+// of playback costs one image blit and a few rectangles.
+class NativeWaveform : public juce::Component
+{
+public:
+    NativeWaveform();
+
+    // Take the decimated points of a new sample (no sample clears the display)
+    void setSample(const SampleData &sample);
+
+    void setLoops(const SampleLoop &sustainLoop, const SampleLoop &releaseLoop);
+
+    // Voice positions from the latest telemetry; repaints only if a playhead moved
+    void setPlayheads(const TelemetryFrame &frame);
+
+    // Drag across the waveform to set the sustain loop, double-click to clear it
+    std::function<void(const SampleLoop &)> onSustainLoopChanged;
+
+    void paint(juce::Graphics &g) override;
+    void resized() override;
+
+    void mouseDown(const juce::MouseEvent &event) override;
+    void mouseDrag(const juce::MouseEvent &event) override;
+    void mouseUp(const juce::MouseEvent &event) override;
+    void mouseDoubleClick(const juce::MouseEvent &event) override;
+
+private:
+    // Decimated points, channel after channel, as the page receives them
+    juce::MemoryBlock points;
+    int numChannels = 0;
+    int numPoints = 0;
+    juce::int64 numFrames = 0;
+
+    juce::Image cache;
+
+    SampleLoop sustainLoop, releaseLoop;
+    juce::int64 dragStart = -1;
+    SampleLoop loopBeforeDrag; // put back if the press ends without a drag
+
+    std::array<juce::int64, SamplerProcessor::MAX_VOICES> voicePositions;
+    std::array<float, SamplerProcessor::MAX_VOICES> voiceLevels;
+
+    void renderCache();
+
+    float frameToX(juce::int64 frame) const;
+    juce::int64 xToFrame(float x) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NativeWaveform)
+};
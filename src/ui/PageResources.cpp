@@ -0,0 +1,39 @@
+#include "PageResources.h"
+#include "BinaryData.h"
+
+PageResources::PageResources()
+{
+    addResource("layout.html", BinaryData::layout_html, BinaryData::layout_htmlSize, "text/html");
+    addResource("layout.css", BinaryData::layout_css, BinaryData::layout_cssSize, "text/css");
+}
+
+void PageResources::addResource(const juce::String &path, const char *data, int size, const juce::String &mimeType)
+{
+    juce::WebBrowserComponent::Resource resource;
+    const auto *bytes = reinterpret_cast<const std::byte *>(data);
+    resource.data.assign(bytes, bytes + size);
+    resource.mimeType = mimeType;
+
+    resources[path] = std::move(resource);
+}
+
+std::optional<juce::WebBrowserComponent::Resource> PageResources::getResource(const juce::String &url) const
+{
+    // Strip the leading slash and any query string
+    juce::String path = url.upToFirstOccurrenceOf("?", false, false).trimCharactersAtStart("/");
+
+    if (path.isEmpty())
+        path = "layout.html";
+
+    auto it = resources.find(path);
+
+    if (it != resources.end())
+        return it->second;
+
+    return std::nullopt;
+}
+
+juce::String PageResources::getPageURL()
+{
+    return juce::WebBrowserComponent::getResourceProviderRoot();
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// The editor page and its stylesheet, converted from BinaryData once per process and
+// served to every WebView through a resource provider instead of a data: URL.
+// Use it through a juce::SharedResourcePointer so all editors share one copy.
+class PageResources
+{
+public:
+    PageResources();
+
+    // Resource provider callback: "/" maps to the page, anything else to a named file
+    std::optional<juce::WebBrowserComponent::Resource> getResource(const juce::String &url) const;
+
+    // URL of the page itself
+    static juce::String getPageURL();
+
+private:
+    std::map<juce::String, juce::WebBrowserComponent::Resource> resources;
+
+    void addResource(const juce::String &path, const char *data, int size, const juce::String &mimeType);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PageResources)
+};